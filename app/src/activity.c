@@ -0,0 +1,232 @@
+/**
+ * @file activity.c
+ */
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/drivers/display.h>
+#include <zephyr/logging/log.h>
+
+#include "activity.h"
+#include "BTN.h"
+#include "pipeline_status.h"
+
+LOG_MODULE_REGISTER(activity, CONFIG_APP_LOG_LEVEL);
+
+/**
+ * Typedefs
+ */
+
+// Super loop wakeups over one awake or asleep period, the loop is what keeps the CPU out of its low power state
+typedef struct {
+    uint32_t start_ms;
+    uint32_t wakeups;
+} activity_period_t;
+
+/**
+ * Prototypes
+ */
+
+static bool activity_buttons_pressed(bool clear);
+static void activity_sleep(uint32_t now);
+static void activity_wake();
+static void activity_log_period(const char* name);
+static void activity_conn_param_work_handler(struct k_work* work);
+
+/**
+ * Local variables
+ */
+
+static const struct device* activity_display;
+static activity_touch_poll_t activity_touch_poll;
+
+static atomic_t last_activity_ms; // Uptime of the last input (32-bit, only ever compared by difference)
+static atomic_t asleep;
+static uint32_t last_touch_poll_ms; // Only touched from the super loop
+
+// Given by activity_report while asleep, so the super loop wakes on input without waiting out its poll period
+static K_SEM_DEFINE(activity_wake_sem, 0, 1);
+
+// Only touched from the super loop
+static activity_period_t activity_period;
+
+// The connection to request parameters on, only touched with the lock held
+static struct bt_conn* activity_conn;
+static struct k_spinlock activity_conn_lock;
+
+static K_WORK_DEFINE(activity_conn_param_work, activity_conn_param_work_handler);
+
+static const struct bt_le_conn_param activity_active_param = BT_LE_CONN_PARAM_INIT(
+    ACTIVITY_ACTIVE_INTERVAL_MIN, ACTIVITY_ACTIVE_INTERVAL_MAX, ACTIVITY_ACTIVE_LATENCY, ACTIVITY_ACTIVE_TIMEOUT);
+
+static const struct bt_le_conn_param activity_idle_param = BT_LE_CONN_PARAM_INIT(
+    ACTIVITY_IDLE_INTERVAL_MIN, ACTIVITY_IDLE_INTERVAL_MAX, ACTIVITY_IDLE_LATENCY, ACTIVITY_IDLE_TIMEOUT);
+
+/**
+ * BLE connection tracking
+ */
+
+static void activity_connected(struct bt_conn* conn, uint8_t err) {
+    if (err) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&activity_conn_lock);
+    if (activity_conn == NULL) {
+        activity_conn = bt_conn_ref(conn);
+    }
+    k_spin_unlock(&activity_conn_lock, key);
+
+    // A client connecting while the display sleeps goes straight to the idle profile
+    if (atomic_get(&asleep)) {
+        k_work_submit(&activity_conn_param_work);
+    }
+}
+
+static void activity_disconnected(struct bt_conn* conn, uint8_t reason) {
+    k_spinlock_key_t key = k_spin_lock(&activity_conn_lock);
+    if (activity_conn == conn) {
+        bt_conn_unref(activity_conn);
+        activity_conn = NULL;
+    }
+    k_spin_unlock(&activity_conn_lock, key);
+}
+
+static void activity_param_updated(struct bt_conn* conn, uint16_t interval, uint16_t latency, uint16_t timeout) {
+    LOG_INF("Connection interval %u us, latency %u, timeout %u ms", interval * 1250, latency, timeout * 10);
+}
+
+BT_CONN_CB_DEFINE(activity_conn_callbacks) = {
+    .connected = activity_connected,
+    .disconnected = activity_disconnected,
+    .le_param_updated = activity_param_updated,
+};
+
+/**
+ * Function definitions
+ */
+
+void activity_init(const struct device* display, activity_touch_poll_t touch_poll) {
+    activity_display = display;
+    activity_touch_poll = touch_poll;
+
+    atomic_set(&last_activity_ms, k_uptime_get_32());
+    activity_period.start_ms = k_uptime_get_32();
+}
+
+void activity_report() {
+    atomic_set(&last_activity_ms, k_uptime_get_32());
+
+    if (atomic_get(&asleep)) {
+        k_sem_give(&activity_wake_sem);
+    }
+}
+
+void activity_run() {
+    activity_period.wakeups++;
+
+    if (!atomic_get(&asleep)) {
+        uint32_t now = k_uptime_get_32();
+
+        // Presses are left for the state machine to act on, here they only restart the timeout
+        if (activity_buttons_pressed(false)) {
+            activity_report();
+        }
+
+        // LVGL doesn't read the touchscreen, so a finger on the screen is only seen here. Polled at the same rate as while
+        // asleep, an I2C read every super loop iteration would cost more than the display it keeps awake
+        if (activity_touch_poll != NULL && now - last_touch_poll_ms >= ACTIVITY_WAKE_POLL_MS) {
+            last_touch_poll_ms = now;
+            if (activity_touch_poll()) {
+                activity_report();
+            }
+        }
+
+        if (now - (uint32_t) atomic_get(&last_activity_ms) < ACTIVITY_IDLE_TIMEOUT_MS) {
+            return;
+        }
+        activity_sleep(now);
+
+        // Input reported just before asleep was set didn't give the semaphore, but it did move the timeout
+        if (k_uptime_get_32() - (uint32_t) atomic_get(&last_activity_ms) < ACTIVITY_IDLE_TIMEOUT_MS) {
+            activity_wake();
+            return;
+        }
+    }
+
+    while (k_sem_take(&activity_wake_sem, K_MSEC(ACTIVITY_WAKE_POLL_MS)) != 0) {
+        activity_period.wakeups++;
+
+        // The press that wakes the display is swallowed, it shouldn't also act on a screen nobody could see
+        if (activity_buttons_pressed(true) || (activity_touch_poll != NULL && activity_touch_poll())) {
+            break;
+        }
+    }
+    activity_wake();
+}
+
+static bool activity_buttons_pressed(bool clear) {
+    bool pressed = false;
+
+    for (int btn = 0; btn < NUM_BTNS; btn++) {
+        if (BTN_check_pressed(btn)) {
+            pressed = true;
+            if (clear) {
+                BTN_clear_pressed(btn);
+            }
+        }
+    }
+    return pressed;
+}
+
+static void activity_sleep(uint32_t now) {
+    activity_log_period("Awake");
+
+    k_sem_reset(&activity_wake_sem);
+    atomic_set(&asleep, 1);
+
+    // LVGL keeps its frame in the panel's memory, so blanking is enough and nothing needs redrawing on wake
+    display_blanking_on(activity_display);
+    k_work_submit(&activity_conn_param_work);
+
+    activity_period.start_ms = now;
+    activity_period.wakeups = 0;
+}
+
+static void activity_wake() {
+    atomic_set(&asleep, 0);
+    atomic_set(&last_activity_ms, k_uptime_get_32());
+
+    // Writes that arrived while asleep weren't late to the screen, it was off
+    atomic_clear(&pipeline_counters.ingest_start_cycles);
+
+    display_blanking_off(activity_display);
+    k_work_submit(&activity_conn_param_work);
+
+    activity_log_period("Asleep");
+    activity_period.start_ms = k_uptime_get_32();
+    activity_period.wakeups = 0;
+}
+
+static void activity_log_period(const char* name) {
+    uint32_t duration_ms = k_uptime_get_32() - activity_period.start_ms;
+
+    LOG_INF("%s for %u ms, %u loop wakeups (%u/s)", name, duration_ms, activity_period.wakeups,
+        duration_ms ? (uint32_t) ((uint64_t) activity_period.wakeups * 1000 / duration_ms) : 0);
+}
+
+static void activity_conn_param_work_handler(struct k_work* work) {
+    k_spinlock_key_t key = k_spin_lock(&activity_conn_lock);
+    struct bt_conn* conn = activity_conn ? bt_conn_ref(activity_conn) : NULL;
+    k_spin_unlock(&activity_conn_lock, key);
+
+    if (conn == NULL) {
+        return;
+    }
+
+    // The central decides in the end, the result shows up in activity_param_updated
+    int err = bt_conn_le_param_update(conn, atomic_get(&asleep) ? &activity_idle_param : &activity_active_param);
+    if (err) {
+        LOG_WRN("Connection parameter update failed (err %d)", err);
+    }
+    bt_conn_unref(conn);
+}
@@ -0,0 +1,59 @@
+/**
+ * @file activity.h
+ */
+
+#ifndef ACTIVITY_H
+#define ACTIVITY_H
+
+/**
+ * Includes
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+
+/**
+ * Defines
+ */
+
+#define ACTIVITY_IDLE_TIMEOUT_MS (CONFIG_APP_ACTIVITY_IDLE_TIMEOUT_S * 1000) // No input for this long puts the display to sleep
+#define ACTIVITY_WAKE_POLL_MS 50 // Touch poll period, and button poll period while asleep: the most a wake can lag behind input
+
+// Connection parameters while awake: metrics arrive within one 15-30 ms interval
+#define ACTIVITY_ACTIVE_INTERVAL_MIN 12 // 1.25 ms units
+#define ACTIVITY_ACTIVE_INTERVAL_MAX 24
+#define ACTIVITY_ACTIVE_LATENCY 0
+#define ACTIVITY_ACTIVE_TIMEOUT 400 // 10 ms units
+
+// Connection parameters while asleep: nothing is drawn, so the radio only needs to keep the link alive. With slave latency the
+// device may skip up to that many events when it has nothing to send, the supervision timeout must stay above
+// (1 + latency) * interval * 2
+#define ACTIVITY_IDLE_INTERVAL_MIN 320 // 400 ms
+#define ACTIVITY_IDLE_INTERVAL_MAX 400 // 500 ms
+#define ACTIVITY_IDLE_LATENCY 4
+#define ACTIVITY_IDLE_TIMEOUT 600 // 6 s
+
+/**
+ * Typedefs
+ */
+
+// Polled to find out whether the touchscreen is being held down, while awake it keeps the display from sleeping under a finger
+typedef bool (*activity_touch_poll_t)();
+
+/**
+ * Function prototypes
+ */
+
+// display is blanked while asleep, touch_poll may be NULL if only the buttons should wake the device
+void activity_init(const struct device* display, activity_touch_poll_t touch_poll);
+
+// Restarts the idle timeout, safe to call from any thread. Wakes the device if it's asleep
+void activity_report();
+
+// Called at the top of every super loop iteration. Puts the display to sleep once the idle timeout passes, and while asleep
+// only returns once input wakes it again, so LVGL and the state machine don't run at all in between
+void activity_run();
+
+#endif
@@ -0,0 +1,33 @@
+/**
+ * @file app_log.h
+ */
+
+#ifndef APP_LOG_H
+#define APP_LOG_H
+
+/**
+ * Includes
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+
+/**
+ * Defines
+ */
+
+#define APP_LOG_RATELIMIT_MS 1000 // Shortest time between two messages from one rate-limited call site
+
+// LOG_WRN that fires at most once per APP_LOG_RATELIMIT_MS from each call site, for messages a misbehaving client could
+// trigger on every packet. Needs the file's LOG_MODULE_REGISTER in scope like any other LOG_ macro
+#define APP_LOG_WRN_RATELIMIT(...)                                          \
+    do {                                                                    \
+        static int64_t app_log_next_ms;                                     \
+        int64_t app_log_now_ms = k_uptime_get();                            \
+        if (app_log_now_ms >= app_log_next_ms) {                            \
+            app_log_next_ms = app_log_now_ms + APP_LOG_RATELIMIT_MS;        \
+            LOG_WRN(__VA_ARGS__);                                           \
+        }                                                                   \
+    } while (0)
+
+#endif
@@ -0,0 +1,29 @@
+/**
+ * @file app_trace.h
+ */
+
+#ifndef APP_TRACE_H
+#define APP_TRACE_H
+
+/**
+ * Includes
+ */
+
+// The event format and phases are shared with the driver trace points, see drivers/TRACE/TRACE.h
+#include "TRACE.h"
+
+/**
+ * Defines
+ */
+
+// Hot path trace points, emitted as CTF named events (names are cut to 20 characters). arg is any 32-bit value worth seeing
+// next to the span, e.g. a length or a state. Without CONFIG_APP_TRACE these expand to nothing and arg isn't evaluated
+#if defined(CONFIG_APP_TRACE)
+#define APP_TRACE_BEGIN(name, arg) TRACE_NAMED_EVENT(name, TRACE_PHASE_BEGIN, arg)
+#define APP_TRACE_END(name, arg) TRACE_NAMED_EVENT(name, TRACE_PHASE_END, arg)
+#else
+#define APP_TRACE_BEGIN(name, arg) do { } while (0)
+#define APP_TRACE_END(name, arg) do { } while (0)
+#endif
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ * @file ble_observer.c
+ */
+
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "ble_observer.h"
+#include "ble_peripheral.h"
+#include "metric_bus.h"
+#include "pipeline_status.h"
+
+LOG_MODULE_REGISTER(ble_observer, CONFIG_APP_LOG_LEVEL);
+
+/**
+ * Local variables
+ */
+
+ble_observer_counters_t ble_observer_counters;
+
+// The host being followed and the last frame applied from it. Set by the scan callback and cleared by ble_observer_lost_work
+// on the system workqueue, hence the lock
+static struct k_spinlock follow_lock;
+static bool following;
+static uint16_t followed_host_id;
+static uint8_t last_sequence;
+
+// Pushed back by every frame from the followed host, runs once it has been silent for PIPELINE_STALE_MS
+static struct k_work_delayable ble_observer_lost_work;
+
+// Scan continuously (window == interval), a host advertises each frame only a few times before changing it
+static const struct bt_le_scan_param ble_observer_scan_param = {
+    .type = BT_LE_SCAN_TYPE_PASSIVE,
+    .options = BT_LE_SCAN_OPT_NONE,
+    .interval = BT_GAP_SCAN_FAST_INTERVAL,
+    .window = BT_GAP_SCAN_FAST_INTERVAL,
+};
+
+/**
+ * Prototypes
+ */
+
+static void ble_observer_scan_cb(const bt_addr_le_t* addr, int8_t rssi, uint8_t adv_type, struct net_buf_simple* buf);
+static bool ble_observer_parse_cb(struct bt_data* data, void* user_data);
+static void ble_observer_apply_frame(const ble_broadcast_frame_t* frame);
+static void ble_observer_lost(struct k_work* work);
+
+/**
+ * Function definitions
+ */
+
+int ble_observer_start() {
+    k_work_init_delayable(&ble_observer_lost_work, ble_observer_lost);
+
+    int err = bt_le_scan_start(&ble_observer_scan_param, ble_observer_scan_cb);
+    if (err) {
+        LOG_ERR("Scanning failed to start (err %d)", err);
+        return err;
+    }
+
+    LOG_INF("Listening for metric broadcasts");
+    return 0;
+}
+
+static void ble_observer_scan_cb(const bt_addr_le_t* addr, int8_t rssi, uint8_t adv_type, struct net_buf_simple* buf) {
+    /**
+     * addr: address of the advertiser, not used as hosts may rotate their address
+     * rssi: signal strength, not used
+     * adv_type: any advertisement type may carry a frame, hosts publish them non-connectable or scannable
+     * buf: the advertising data, a sequence of AD structures
+     */
+
+    bt_data_parse(buf, ble_observer_parse_cb, NULL);
+}
+
+static bool ble_observer_parse_cb(struct bt_data* data, void* user_data) {
+    // Return true to keep parsing the remaining AD structures, false once a frame has been found
+    if (data->type != BT_DATA_MANUFACTURER_DATA || data->data_len != sizeof(ble_broadcast_frame_t)) {
+        return true;
+    }
+
+    const ble_broadcast_frame_t* frame = (const ble_broadcast_frame_t*) data->data;
+    if (sys_le16_to_cpu(frame->company_id) != BLE_BROADCAST_COMPANY_ID || frame->version != BLE_BROADCAST_FRAME_VERSION) {
+        return true;
+    }
+
+    ble_observer_apply_frame(frame);
+    return false;
+}
+
+static void ble_observer_apply_frame(const ble_broadcast_frame_t* frame) {
+    uint16_t host_id = sys_le16_to_cpu(frame->host_id);
+    bool new_host = false;
+
+    k_spinlock_key_t key = k_spin_lock(&follow_lock);
+
+    if (!following) {
+        // Follow the first host heard, other hosts broadcasting nearby are ignored until it goes silent
+        following = true;
+        followed_host_id = host_id;
+        last_sequence = frame->sequence - 1;
+        new_host = true;
+        atomic_set(&pipeline_counters.link_up, 1);
+
+        // Give every metric group a full staleness period to arrive, like a new connection does
+        for (int group = 0; group < NUM_METRIC_GROUPS; group++) {
+            pipeline_status_metric_received(group);
+        }
+    }
+
+    if (host_id != followed_host_id) {
+        k_spin_unlock(&follow_lock, key);
+        return;
+    }
+
+    // Any copy of a frame shows the host is still broadcasting
+    k_work_reschedule(&ble_observer_lost_work, K_MSEC(PIPELINE_STALE_MS));
+
+    // Every frame is advertised several times, only the first copy heard is applied
+    if (frame->sequence == last_sequence) {
+        k_spin_unlock(&follow_lock, key);
+        return;
+    }
+
+    // uint8_t arithmetic wraps along with the sequence number
+    uint8_t missed = frame->sequence - last_sequence - 1;
+    last_sequence = frame->sequence;
+
+    k_spin_unlock(&follow_lock, key);
+
+    if (new_host) {
+        LOG_INF("Following metric broadcasts from host %04x", host_id);
+    }
+    atomic_add(&ble_observer_counters.missed, missed);
+    atomic_inc(&ble_observer_counters.frames);
+
+    // Broadcast frames are decoded into the same structs the GATT writes carry and published the same way, so none of the
+    // bus's observers know the difference
+    const cpu_gpu_scalar_metrics_t scalar = {
+        .cpu_clock_mhz = sys_le16_to_cpu(frame->cpu_clock_mhz),
+        .cpu_power_watts = sys_le16_to_cpu(frame->cpu_power_watts),
+        .cpu_temp_celsius = frame->cpu_temp_celsius,
+        .gpu_temp_celsius = frame->gpu_temp_celsius,
+    };
+    const network_scalar_metrics_t network = {
+        .network_down_bits = sys_le32_to_cpu(frame->network_down_bits),
+        .network_up_bits = sys_le32_to_cpu(frame->network_up_bits),
+    };
+    const cpu_gpu_ram_percentage_metrics_t percent = {
+        .cpu_usage_percent = frame->cpu_usage_percent,
+        .gpu_usage_percent = frame->gpu_usage_percent,
+        .ram_usage_percent = frame->ram_usage_percent,
+    };
+
+    metric_bus_publish(METRIC_GROUP_SCALAR, &scalar);
+    metric_bus_publish(METRIC_GROUP_NETWORK, &network);
+    metric_bus_publish(METRIC_GROUP_PERCENT, &percent);
+}
+
+// The followed host stopped broadcasting (or moved out of range), drop it so the display takes whichever host it hears next
+static void ble_observer_lost(struct k_work* work) {
+    k_spinlock_key_t key = k_spin_lock(&follow_lock);
+    bool was_following = following;
+    uint16_t host_id = followed_host_id;
+    following = false;
+    if (was_following) {
+        atomic_set(&pipeline_counters.link_up, 0);
+    }
+    k_spin_unlock(&follow_lock, key);
+
+    if (was_following) {
+        LOG_WRN("No metric broadcasts from host %04x for %d ms, following the next host heard", host_id, PIPELINE_STALE_MS);
+    }
+}
@@ -0,0 +1,61 @@
+/**
+ * @file ble_observer.h
+ */
+
+#ifndef BLE_OBSERVER_H
+#define BLE_OBSERVER_H
+
+/**
+ * Includes
+ */
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * Defines
+ */
+
+// Broadcast frames are manufacturer specific data under the Bluetooth SIG's company ID reserved for testing
+#define BLE_BROADCAST_COMPANY_ID 0xFFFF
+#define BLE_BROADCAST_FRAME_VERSION 1
+
+/**
+ * Typedefs
+ */
+
+// One broadcast frame, all multi-byte fields little-endian. It has to fit in a legacy advertisement (31 bytes, including the
+// flags and the AD header) so that any host Bluetooth stack can publish it, which is why the scalar fields are narrower than
+// their GATT characteristic counterparts
+typedef struct __packed {
+    uint16_t company_id;
+    uint8_t version;
+    uint16_t host_id; // Identifies the broadcasting host, a display follows the first host it hears until it goes silent
+    uint8_t sequence; // Increments whenever the host changes the frame, repeats of one frame carry the same number
+    uint16_t cpu_clock_mhz;
+    uint16_t cpu_power_watts;
+    uint8_t cpu_temp_celsius;
+    uint8_t gpu_temp_celsius;
+    uint32_t network_down_bits;
+    uint32_t network_up_bits;
+    uint8_t cpu_usage_percent;
+    uint8_t gpu_usage_percent;
+    uint8_t ram_usage_percent;
+} ble_broadcast_frame_t;
+
+// Reception counters, only written from the scan callback
+typedef struct {
+    atomic_t frames; // New frames applied
+    atomic_t missed; // Frames skipped over, from gaps in the sequence numbers
+} ble_observer_counters_t;
+
+extern ble_observer_counters_t ble_observer_counters;
+
+/**
+ * Function prototypes
+ */
+
+// Starts a passive scan, called instead of starting to advertise when CONFIG_APP_BLE_OBSERVER is set
+int ble_observer_start();
+
+#endif
@@ -2,14 +2,29 @@
  * @file ble_peripheral.c
  */
 
+#include <zephyr/sys/barrier.h>
+#include <zephyr/sys/byteorder.h>
+
+#include "app_log.h"
+#include "app_trace.h"
 #include "ble_peripheral.h"
+#include "diagnostics.h"
+#include "metric_bus.h"
+#include "pipeline_status.h"
+#include "process_list.h"
+
+LOG_MODULE_REGISTER(ble_peripheral, CONFIG_APP_LOG_LEVEL);
 
 /**
  * Local variables
  */
 
 // Flag indicating whether or not there is new data for LVGL to re-draw onto the LCD
-bool new_data = false;
+atomic_t new_data;
+
+// Sequence lock over the detail strings: odd while a write is in progress, and changed by every write,
+// so a reader that saw the same even value before and after its copy knows the copy is whole
+static atomic_t metrics_sequence;
 
 // + 1 for the null terminators
 char ble_system_details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
@@ -36,6 +51,15 @@ static const struct bt_uuid_128 ble_cpu_details_characteristic_uuid =
 static const struct bt_uuid_128 ble_gpu_details_characteristic_uuid =
     BT_UUID_INIT_128(BLE_GPU_DETAILS_CHARACTERISTIC);
 
+static const struct bt_uuid_128 ble_per_core_metrics_characteristic_uuid =
+    BT_UUID_INIT_128(BLE_PER_CORE_METRICS_CHARACTERISTIC);
+
+static const struct bt_uuid_128 ble_process_list_characteristic_uuid =
+    BT_UUID_INIT_128(BLE_PROCESS_LIST_CHARACTERISTIC);
+
+static const struct bt_uuid_128 ble_telemetry_characteristic_uuid =
+    BT_UUID_INIT_128(BLE_TELEMETRY_CHARACTERISTIC);
+
 // Data actively advertised for GATT clients to see
 const struct bt_data ble_advertising_data[] = {
     BT_DATA_BYTES(BT_DATA_FLAGS, (BT_LE_AD_GENERAL | BT_LE_AD_NO_BREDR)),
@@ -50,15 +74,26 @@ const struct bt_data ble_scan_response_data[] = {
 const size_t advertising_data_array_size = ARRAY_SIZE(ble_advertising_data);
 const size_t scan_response_data_array_size = ARRAY_SIZE(ble_scan_response_data);
 
-// Define structs that store the data written to our characteristics (we dont want them static as we need access to them in state machine)
-cpu_gpu_scalar_metrics_t ble_cpu_gpu_scalar_metrics_characteristic_data;
-network_scalar_metrics_t ble_network_scalar_metrics_characteristic_data;
-cpu_gpu_ram_percentage_metrics_t ble_cpu_gpu_ram_percentage_metrics_characteristic_data;
+// Per-core frames are assembled chunk by chunk in the staging buffer (only touched by the BT RX thread), then copied to the
+// published buffer in one go under the lock so readers never see half of one frame and half of another
+static per_core_metrics_t per_core_staging;
+static uint8_t per_core_staging_frame_id;
+static uint16_t per_core_staging_received; // Distinct cores received so far for the staging frame
+// Bit per core of the staging frame, so a duplicated or retried chunk can't count the same cores twice
+static ATOMIC_DEFINE(per_core_staging_cores, BLE_PER_CORE_MAX_CORES);
+static per_core_metrics_t per_core_published;
+static struct k_spinlock per_core_lock;
+
+atomic_t ble_per_core_frames;
 
 /**
  * Prototypes
  */
 
+static void ble_advertising_restart_work_handler(struct k_work* work);
+static void ble_recycled_cb(void);
+static void ble_disconnected_cb(struct bt_conn* conn, uint8_t reason);
+
 // We only need a callback for when we're written to, as we don't ever return anything back to a connected GATT client
 static ssize_t ble_cpu_gpu_scalar_metrics_write_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
                                         const void* buf, uint16_t len, uint16_t offset,
@@ -84,6 +119,20 @@ static ssize_t ble_gpu_details_write_cb(struct bt_conn* conn, const struct bt_ga
                                         const void* buf, uint16_t len, uint16_t offset,
                                         uint8_t flags);
 
+static ssize_t ble_per_core_metrics_write_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        const void* buf, uint16_t len, uint16_t offset,
+                                        uint8_t flags);
+
+static ssize_t ble_process_list_write_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        const void* buf, uint16_t len, uint16_t offset,
+                                        uint8_t flags);
+
+#if defined(CONFIG_APP_DIAGNOSTICS)
+// The one characteristic a client reads, see diagnostics.h for its layout
+static ssize_t ble_telemetry_read_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        void* buf, uint16_t len, uint16_t offset);
+#endif
+
 /**
  * BLE service setup
  */
@@ -101,7 +150,7 @@ BT_GATT_SERVICE_DEFINE(
         BT_GATT_PERM_WRITE, // Permissions that connecting devices have
         NULL, // We don't need a callback for reading as a client doesn't read our characteristics
         ble_cpu_gpu_scalar_metrics_write_cb, // Callback for when this characteristic is written to
-        &ble_cpu_gpu_scalar_metrics_characteristic_data // Address where we want data stored for this characteristic
+        NULL // Writes are published on the metric bus, see metric_bus.h
         ),
 
     // FOR NETWORK SCALAR METRICS
@@ -111,7 +160,7 @@ BT_GATT_SERVICE_DEFINE(
         BT_GATT_PERM_WRITE, // Permissions that connecting devices have
         NULL, // We don't need a callback for reading as a client doesn't read our characteristics
         ble_network_scalar_metrics_write_cb, // Callback for when this characteristic is written to
-        &ble_network_scalar_metrics_characteristic_data // Address where we want data stored for this characteristic
+        NULL // Writes are published on the metric bus, see metric_bus.h
         ),
 
     // FOR CPU, GPU AND RAM PERCENTAGE METRICS
@@ -121,7 +170,7 @@ BT_GATT_SERVICE_DEFINE(
         BT_GATT_PERM_WRITE, // Permissions that connecting devices have
         NULL, // We don't need a callback for reading as a client doesn't read our characteristics
         ble_cpu_gpu_ram_percentage_metrics_write_cb, // Callback for when this characteristic is written to
-        &ble_cpu_gpu_ram_percentage_metrics_characteristic_data // Address where we want data stored for this characteristic
+        NULL // Writes are published on the metric bus, see metric_bus.h
         ),
 
     // FOR SYSTEM DETAILS
@@ -153,9 +202,76 @@ BT_GATT_SERVICE_DEFINE(
         ble_gpu_details_write_cb, // Callback for when this characteristic is written to
         &ble_gpu_details // Address where we want data stored for this characteristic
         ),
+
+    // FOR PER-CORE METRICS
+    BT_GATT_CHARACTERISTIC(
+        &ble_per_core_metrics_characteristic_uuid.uuid, // Setting the characteristic UUID
+        BT_GATT_CHRC_WRITE_WITHOUT_RESP, // A connected GATT client can write to this characteristic, and we don't need to reply with an ack
+        BT_GATT_PERM_WRITE, // Permissions that connecting devices have
+        NULL, // We don't need a callback for reading as a client doesn't read our characteristics
+        ble_per_core_metrics_write_cb, // Callback for when this characteristic is written to
+        &per_core_staging // Chunks are reassembled here, see ble_per_core_metrics_write_cb
+        ),
+
+    // FOR THE TOP PROCESS LIST
+    BT_GATT_CHARACTERISTIC(
+        &ble_process_list_characteristic_uuid.uuid, // Setting the characteristic UUID
+        BT_GATT_CHRC_WRITE_WITHOUT_RESP, // A connected GATT client can write to this characteristic, and we don't need to reply with an ack
+        BT_GATT_PERM_WRITE, // Permissions that connecting devices have
+        NULL, // We don't need a callback for reading as a client doesn't read our characteristics
+        ble_process_list_write_cb, // Callback for when this characteristic is written to
+        NULL // Messages are decoded into the process list module, see process_list.c
+        ),
+
+    // FOR DIAGNOSTICS TELEMETRY
+    IF_ENABLED(CONFIG_APP_DIAGNOSTICS, (
+    BT_GATT_CHARACTERISTIC(
+        &ble_telemetry_characteristic_uuid.uuid, // Setting the characteristic UUID
+        BT_GATT_CHRC_READ | BT_GATT_CHRC_NOTIFY, // A client reads the full sample, or subscribes for the header every period
+        BT_GATT_PERM_READ, // Permissions that connecting devices have
+        ble_telemetry_read_cb, // Callback for when this characteristic is read
+        NULL, // We don't need a callback for writing as this characteristic is read only
+        NULL // Samples are copied out of the diagnostics module, see diagnostics.c
+        ),
+    BT_GATT_CCC(NULL, BT_GATT_PERM_READ | BT_GATT_PERM_WRITE), // Lets a client turn notifications on and off
+    ))
     // End of service definition
 );
 
+/**
+ * Advertising restart
+ *
+ * Connectable advertising stops for good once a client connects, so it has to be restarted for the client to find us again
+ * after a dropped link. The connection object is only free to reuse once it is recycled, which is also when advertising
+ * can be restarted. bt_le_adv_start isn't called from the callback directly, it runs on the system workqueue instead.
+ */
+
+static K_WORK_DEFINE(ble_advertising_restart_work, ble_advertising_restart_work_handler);
+
+BT_CONN_CB_DEFINE(ble_peripheral_conn_callbacks) = {
+    .disconnected = ble_disconnected_cb,
+    .recycled = ble_recycled_cb,
+};
+
+static void ble_disconnected_cb(struct bt_conn* conn, uint8_t reason) {
+    // Process names are only cached for the connection that sent them, the client starts a fresh dictionary on reconnect
+    process_list_reset();
+}
+
+static void ble_recycled_cb(void) {
+    k_work_submit(&ble_advertising_restart_work);
+}
+
+static void ble_advertising_restart_work_handler(struct k_work* work) {
+    // Fast advertising intervals, so a reconnecting client finds us within a few hundred milliseconds
+    int err = bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ble_advertising_data, advertising_data_array_size,
+                              ble_scan_response_data, scan_response_data_array_size);
+
+    if (err && err != -EALREADY) {
+        LOG_ERR("Advertising failed to restart (err %d)", err);
+    }
+}
+
 /**
  * Write callback definitions
  */
@@ -172,20 +288,22 @@ static ssize_t ble_cpu_gpu_scalar_metrics_write_cb(struct bt_conn* conn, const s
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */
 
+    APP_TRACE_BEGIN("gatt_scalar", len);
+
     // If data received is over the maximum we expect
     if (len != sizeof(cpu_gpu_scalar_metrics_t) || offset != 0) {
-        printk("[BLE] ble_cpu_gpu_scalar_metrics_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected CPU and GPU scalar metrics write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_scalar", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
-    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, we can simply write all incoming bytes
-    // directly into attr->user_data with one line of code which will store each metric into each struct attribute in Little-Endian order (LSB first)
-    memcpy(attr->user_data, buf, len);
-    printk("Received CPU and GPU scalar metrics from GATT client.\n");
-
-    // Indicate to LVGL that new data is available to process
-    new_data = true;
+    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, the incoming bytes already are the
+    // group's struct in Little-Endian order (LSB first), and are published as they are. The bus's observers take it from there
+    LOG_DBG("Received CPU and GPU scalar metrics");
+    metric_bus_publish(METRIC_GROUP_SCALAR, buf);
 
+    APP_TRACE_END("gatt_scalar", len);
     return len;
 };
                                         
@@ -201,20 +319,22 @@ static ssize_t ble_network_scalar_metrics_write_cb(struct bt_conn* conn, const s
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */
 
+    APP_TRACE_BEGIN("gatt_network", len);
+
     // If data received is over the maximum we expect
     if (len != sizeof(network_scalar_metrics_t) || offset != 0) {
-        printk("[BLE] ble_network_scalar_metrics_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected network scalar metrics write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_network", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
-    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, we can simply write all incoming bytes
-    // directly into attr->user_data with one line of code which will store each metric into each struct attribute in Little-Endian order (LSB first)
-    memcpy(attr->user_data, buf, len);
-    printk("Received network scalar metrics from GATT client.\n");
-
-    // Indicate to LVGL that new data is available to process
-    new_data = true;
+    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, the incoming bytes already are the
+    // group's struct in Little-Endian order (LSB first), and are published as they are. The bus's observers take it from there
+    LOG_DBG("Received network scalar metrics");
+    metric_bus_publish(METRIC_GROUP_NETWORK, buf);
 
+    APP_TRACE_END("gatt_network", len);
     return len;
 };
 
@@ -230,20 +350,22 @@ static ssize_t ble_cpu_gpu_ram_percentage_metrics_write_cb(struct bt_conn* conn,
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */ 
 
+    APP_TRACE_BEGIN("gatt_percent", len);
+
     // If data received is over the maximum we expect
     if (len != sizeof(cpu_gpu_ram_percentage_metrics_t) || offset != 0) {
-        printk("[BLE] ble_cpu_gpu_ram_percentage_metrics_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected CPU, GPU and RAM percentage metrics write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_percent", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
-    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, we can simply write all incoming bytes
-    // directly into attr->user_data with one line of code which will store each metric into each struct attribute in Little-Endian order (LSB first)
-    memcpy(attr->user_data, buf, len);
-    printk("Received CPU, GPU and RAM percentage metrics from GATT client.\n");
-
-    // Indicate to LVGL that new data is available to process
-    new_data = true;
+    // Since each incoming metric is packed in its own uint32_t with no need to consider padding, the incoming bytes already are the
+    // group's struct in Little-Endian order (LSB first), and are published as they are. The bus's observers take it from there
+    LOG_DBG("Received CPU, GPU and RAM percentage metrics");
+    metric_bus_publish(METRIC_GROUP_PERCENT, buf);
      
+    APP_TRACE_END("gatt_percent", len);
     return len;
 };
 
@@ -259,22 +381,30 @@ static ssize_t ble_system_details_write_cb(struct bt_conn* conn, const struct bt
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */ 
 
+    APP_TRACE_BEGIN("gatt_system_details", len);
+
     // If data received is over the maximum we can receive
     if(offset != 0 || len > BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH) {
-        printk("[BLE] ble_system_details_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected system details write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_system_details", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
     char* data = attr->user_data;
 
     // Copy and save received strings
+    ble_metrics_write_begin();
     memcpy(data, buf, len);
     data[len] = 0; // null termination
-    printk("Received system details from GATT client.\n");
+    ble_metrics_write_end();
+    LOG_DBG("Received system details");
 
     // Indicate to LVGL that new data is available to process
-    new_data = true;
+    ble_metrics_signal_new_data();
+    pipeline_status_count_rx();
 
+    APP_TRACE_END("gatt_system_details", len);
     return len;
 }
 
@@ -290,22 +420,30 @@ static ssize_t ble_cpu_details_write_cb(struct bt_conn* conn, const struct bt_ga
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */ 
 
+    APP_TRACE_BEGIN("gatt_cpu_details", len);
+
     // If data received is over the maximum we can receive
     if(offset != 0 || len > BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH) {
-        printk("[BLE] ble_cpu_details_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected CPU details write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_cpu_details", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
     char* data = attr->user_data;
 
     // Copy and save received strings
+    ble_metrics_write_begin();
     memcpy(data, buf, len);
     data[len] = 0; // null termination
-    printk("Received CPU details from GATT client.\n");
+    ble_metrics_write_end();
+    LOG_DBG("Received CPU details");
 
     // Indicate to LVGL that new data is available to process
-    new_data = true;
+    ble_metrics_signal_new_data();
+    pipeline_status_count_rx();
 
+    APP_TRACE_END("gatt_cpu_details", len);
     return len;
 }
                                     
@@ -321,22 +459,188 @@ static ssize_t ble_gpu_details_write_cb(struct bt_conn* conn, const struct bt_ga
      * flags: indicates type of BLE write (in this case, Write Without Response), not important
      */ 
 
+    APP_TRACE_BEGIN("gatt_gpu_details", len);
+
     // If data received is over the maximum we can receive
     if(offset != 0 || len > BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH) {
-        printk("[BLE] ble_gpu_details_write_cb: Received oversized data.\n");
+        APP_LOG_WRN_RATELIMIT("Rejected GPU details write (%u bytes at offset %u)", len, offset);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_gpu_details", 0);
         return BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE);
     }
 
     char* data = attr->user_data;
 
     // Copy and save received strings
+    ble_metrics_write_begin();
     memcpy(data, buf, len);
     data[len] = 0; // null termination
-    printk("Received GPU details from GATT client.\n");
+    ble_metrics_write_end();
+    LOG_DBG("Received GPU details");
 
     // Indicate to LVGL that new data is available to process
-    new_data = true;
+    ble_metrics_signal_new_data();
+    pipeline_status_count_rx();
 
+    APP_TRACE_END("gatt_gpu_details", len);
     return len;
 }
 
+static ssize_t ble_per_core_metrics_write_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        const void* buf, uint16_t len, uint16_t offset,
+                                        uint8_t flags) {
+    /**
+     * conn: pointer representing the BLE connection to the GATT client
+     * attr: points to the characteristic being written to defined in BT_GATT_SERVICE_DEFINE, attr->user_data POINTS to the staging frame
+     * buf: one chunk, a per_core_chunk_header_t followed by the loads and then the clocks of the cores it carries
+     * len: length of the chunk, the client sizes chunks to fit the negotiated MTU
+     * offset: we don't accept long writes, each chunk is self-contained
+     * flags: indicates type of BLE write (in this case, Write Without Response), not important
+     */
+
+    APP_TRACE_BEGIN("gatt_per_core", len);
+
+    const per_core_chunk_header_t* header = buf;
+    const uint8_t* payload = (const uint8_t*) buf + sizeof(per_core_chunk_header_t);
+    uint16_t payload_len = len - sizeof(per_core_chunk_header_t);
+    uint16_t cores = payload_len / BLE_PER_CORE_BYTES_PER_CORE;
+
+    // Reject anything that doesn't hold a whole number of cores, or that would land outside the frame
+    if (offset != 0 || len <= sizeof(per_core_chunk_header_t) || payload_len % BLE_PER_CORE_BYTES_PER_CORE != 0 ||
+        header->core_count == 0 || header->core_count > BLE_PER_CORE_MAX_CORES ||
+        header->first_core + cores > header->core_count) {
+        APP_LOG_WRN_RATELIMIT("Rejected malformed per-core chunk (%u bytes)", len);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_per_core", 0);
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    per_core_metrics_t* staging = attr->user_data;
+
+    // A chunk of a new frame means the previous frame lost a chunk, start over rather than show a mix of two frames
+    if (header->frame_id != per_core_staging_frame_id || header->core_count != staging->core_count) {
+        per_core_staging_frame_id = header->frame_id;
+        staging->core_count = header->core_count;
+        per_core_staging_received = 0;
+        memset(per_core_staging_cores, 0, sizeof(per_core_staging_cores));
+    }
+
+    memcpy(&staging->usage_percent[header->first_core], payload, cores);
+    for (uint16_t i = 0; i < cores; i++) {
+        staging->clock_mhz[header->first_core + i] = sys_get_le16(&payload[cores + i * sizeof(uint16_t)]);
+        if (!atomic_test_and_set_bit(per_core_staging_cores, header->first_core + i)) {
+            per_core_staging_received++;
+        }
+    }
+
+    if (per_core_staging_received == staging->core_count) {
+        ble_per_core_metrics_publish(staging);
+
+        // Make sure a duplicate of the last chunk can't complete the same frame twice
+        per_core_staging_received = 0;
+        memset(per_core_staging_cores, 0, sizeof(per_core_staging_cores));
+        per_core_staging_frame_id++;
+
+        pipeline_status_count_rx();
+    }
+
+    APP_TRACE_END("gatt_per_core", len);
+    return len;
+}
+
+static ssize_t ble_process_list_write_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        const void* buf, uint16_t len, uint16_t offset,
+                                        uint8_t flags) {
+    /**
+     * conn: pointer representing the BLE connection to the GATT client
+     * attr: points to the characteristic being written to defined in BT_GATT_SERVICE_DEFINE, no user data for this one
+     * buf: one process list message, either a name definition or a top list (see process_list.h)
+     * len: length of the message
+     * offset: we don't accept long writes, each message is self-contained
+     * flags: indicates type of BLE write (in this case, Write Without Response), not important
+     */
+
+    APP_TRACE_BEGIN("gatt_process_list", len);
+
+    if (offset != 0 || 0 > process_list_handle_message(buf, len)) {
+        APP_LOG_WRN_RATELIMIT("Rejected malformed process list message (%u bytes)", len);
+        pipeline_status_count_rx_rejected();
+        APP_TRACE_END("gatt_process_list", 0);
+        return BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN);
+    }
+
+    pipeline_status_count_rx();
+
+    APP_TRACE_END("gatt_process_list", len);
+    return len;
+}
+
+void ble_metrics_write_begin() {
+    atomic_inc(&metrics_sequence);
+    barrier_dmem_fence_full(); // The odd sequence must be visible before any of the data changes
+}
+
+void ble_metrics_write_end() {
+    barrier_dmem_fence_full(); // All of the data must be visible before the sequence turns even again
+    atomic_inc(&metrics_sequence);
+}
+
+void ble_metrics_signal_new_data() {
+    // Still set means the UI hasn't drawn the previous write yet, both will show up in the same redraw
+    if (atomic_set(&new_data, 1)) {
+        pipeline_status_count_coalesced();
+    }
+}
+
+// Copies in a loop until no write overlapped the copy. Writers run on the cooperative BT RX thread and can't be preempted by
+// a reader, so a retry only happens when the reader itself was preempted mid-copy
+void ble_details_get(ble_details_snapshot_t* out) {
+    atomic_val_t sequence;
+
+    do {
+        sequence = atomic_get(&metrics_sequence);
+        barrier_dmem_fence_full();
+        memcpy(out->system, ble_system_details, sizeof(out->system));
+        memcpy(out->cpu, ble_cpu_details, sizeof(out->cpu));
+        memcpy(out->gpu, ble_gpu_details, sizeof(out->gpu));
+        barrier_dmem_fence_full();
+    } while ((sequence & 1) || sequence != atomic_get(&metrics_sequence));
+}
+
+void ble_per_core_metrics_publish(const per_core_metrics_t* frame) {
+    k_spinlock_key_t key = k_spin_lock(&per_core_lock);
+    per_core_published = *frame;
+    k_spin_unlock(&per_core_lock, key);
+
+    atomic_inc(&ble_per_core_frames);
+}
+
+void ble_per_core_metrics_get(per_core_metrics_t* out) {
+    k_spinlock_key_t key = k_spin_lock(&per_core_lock);
+    *out = per_core_published;
+    k_spin_unlock(&per_core_lock, key);
+}
+
+#if defined(CONFIG_APP_DIAGNOSTICS)
+static ssize_t ble_telemetry_read_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                        void* buf, uint16_t len, uint16_t offset) {
+    // A long read arrives as several reads at increasing offsets, they must all see the same sample
+    static diagnostics_telemetry_t telemetry;
+    static size_t telemetry_length;
+
+    if (offset == 0) {
+        telemetry_length = diagnostics_telemetry_get(&telemetry);
+    }
+    return bt_gatt_attr_read(conn, attr, buf, len, offset, &telemetry, telemetry_length);
+}
+
+void ble_telemetry_notify(const void* data, uint16_t len) {
+    const struct bt_gatt_attr* attr = bt_gatt_find_by_uuid(ble_hardware_monitor_service.attrs,
+        ble_hardware_monitor_service.attr_count, &ble_telemetry_characteristic_uuid.uuid);
+
+    // Only sent to clients that enabled notifications, and an error (nobody connected, no buffers) just skips this sample
+    if (attr != NULL) {
+        bt_gatt_notify(NULL, attr, data, len);
+    }
+}
+#endif
@@ -14,9 +14,15 @@
 #include <zephyr/bluetooth/gatt.h>
 #include <zephyr/bluetooth/hci.h>
 #include <zephyr/bluetooth/uuid.h>
+#include <zephyr/sys/atomic.h>
 
 #define BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH 64
 
+// Per-core metrics are split across as many writes as it takes, each chunk starts with a per_core_chunk_header_t followed by
+// the load (uint8_t) of every core in the chunk, then the clock (uint16_t, little-endian) of every core in the chunk
+#define BLE_PER_CORE_MAX_CORES 128
+#define BLE_PER_CORE_BYTES_PER_CORE (sizeof(uint8_t) + sizeof(uint16_t))
+
 /**
  * Typedefs
  */
@@ -39,11 +45,69 @@ typedef struct {
     uint32_t ram_usage_percent; // MSB (end write)
 } cpu_gpu_ram_percentage_metrics_t;
 
+// The latest value of all three metric groups, see metric_bus_get
+typedef struct {
+    cpu_gpu_scalar_metrics_t scalar;
+    network_scalar_metrics_t network;
+    cpu_gpu_ram_percentage_metrics_t percent;
+} ble_metrics_snapshot_t;
+
+typedef struct {
+    char system[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
+    char cpu[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
+    char gpu[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
+} ble_details_snapshot_t;
+
+typedef struct __packed {
+    uint8_t frame_id; // Increments per frame, a chunk from a new frame abandons an incomplete one
+    uint8_t core_count; // Total cores in the frame
+    uint8_t first_core; // Index of the first core carried by this chunk
+    uint8_t reserved;
+} per_core_chunk_header_t;
+
+typedef struct {
+    uint8_t core_count;
+    uint8_t usage_percent[BLE_PER_CORE_MAX_CORES];
+    uint16_t clock_mhz[BLE_PER_CORE_MAX_CORES];
+} per_core_metrics_t;
+
 // + 1 for the null terminators
 extern char ble_system_details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
 extern char ble_cpu_details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
 extern char ble_gpu_details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
 
+// Set to 1 whenever a metric or detail characteristic is written, the UI takes it with atomic_clear before redrawing
+extern atomic_t new_data;
+
+// Number of complete per-core frames received, a change means ble_per_core_metrics_get has something new
+extern atomic_t ble_per_core_frames;
+
+/**
+ * Function prototypes
+ */
+
+// Bracket every write to the detail strings, so readers can tell when they copied during a write.
+// Writers must not run concurrently with each other, they all run on the BT RX thread
+void ble_metrics_write_begin();
+void ble_metrics_write_end();
+
+// Sets new_data after a write, counting the write as coalesced when the UI hadn't taken the previous one yet
+void ble_metrics_signal_new_data();
+
+// Copy out the detail strings without tearing, safe to call from any thread that isn't a writer
+void ble_details_get(ble_details_snapshot_t* out);
+
+// Makes a complete per-core frame the latest one, called once the last chunk of a frame has arrived
+void ble_per_core_metrics_publish(const per_core_metrics_t* frame);
+
+// Copies out the latest complete per-core frame, safe to call from any thread
+void ble_per_core_metrics_get(per_core_metrics_t* out);
+
+#if defined(CONFIG_APP_DIAGNOSTICS)
+// Notifies subscribed clients on the telemetry characteristic, called by the diagnostics sampler
+void ble_telemetry_notify(const void* data, uint16_t len);
+#endif
+
 /**
  * Service and Characteristic Setup
  */
@@ -69,4 +133,13 @@ extern char ble_gpu_details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
 #define BLE_GPU_DETAILS_CHARACTERISTIC \
     BT_UUID_128_ENCODE(0x01928374, 0x1234, 0x5678, 0x1234, 0x56789abcdef6)
 
+#define BLE_PER_CORE_METRICS_CHARACTERISTIC \
+    BT_UUID_128_ENCODE(0x01928374, 0x1234, 0x5678, 0x1234, 0x56789abcdef7)
+
+#define BLE_PROCESS_LIST_CHARACTERISTIC \
+    BT_UUID_128_ENCODE(0x01928374, 0x1234, 0x5678, 0x1234, 0x56789abcdef8)
+
+#define BLE_TELEMETRY_CHARACTERISTIC \
+    BT_UUID_128_ENCODE(0x01928374, 0x1234, 0x5678, 0x1234, 0x56789abcdef9)
+
 #endif
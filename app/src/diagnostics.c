@@ -0,0 +1,190 @@
+/**
+ * @file diagnostics.c
+ */
+
+#include <string.h>
+#include <zephyr/shell/shell.h>
+
+#include "diagnostics.h"
+#include "ble_peripheral.h"
+#include "pipeline_status.h"
+
+/**
+ * Typedefs
+ */
+
+// Execution cycles of one thread as of the previous sample
+typedef struct {
+    const struct k_thread* thread;
+    uint64_t cycles;
+} diagnostics_thread_cycles_t;
+
+// State carried through one k_thread_foreach pass
+typedef struct {
+    diagnostics_telemetry_t* telemetry;
+    diagnostics_thread_cycles_t* cycles;
+    uint64_t period_cycles;
+} diagnostics_pass_t;
+
+/**
+ * Local variables
+ */
+
+static struct k_work_delayable diagnostics_work;
+
+// Only touched from the system workqueue
+static diagnostics_thread_cycles_t last_thread_cycles[DIAGNOSTICS_MAX_THREADS];
+static k_thread_runtime_stats_t last_all_stats;
+
+// The latest sample, copied out under the lock so a reader never sees half of one
+static struct k_spinlock diagnostics_lock;
+static diagnostics_telemetry_t diagnostics_published;
+
+/**
+ * Prototypes
+ */
+
+static void diagnostics_sample(struct k_work* work);
+static void diagnostics_sample_thread(const struct k_thread* thread, void* user_data);
+static uint16_t diagnostics_permille(uint64_t part, uint64_t whole);
+
+/**
+ * Function definitions
+ */
+
+void diagnostics_init() {
+    k_thread_runtime_stats_all_get(&last_all_stats);
+
+    k_work_init_delayable(&diagnostics_work, diagnostics_sample);
+    k_work_schedule(&diagnostics_work, K_MSEC(DIAGNOSTICS_PERIOD_MS));
+}
+
+size_t diagnostics_telemetry_get(diagnostics_telemetry_t* out) {
+    k_spinlock_key_t key = k_spin_lock(&diagnostics_lock);
+    *out = diagnostics_published;
+    k_spin_unlock(&diagnostics_lock, key);
+
+    return sizeof(diagnostics_telemetry_header_t) + out->header.thread_count * sizeof(diagnostics_thread_t);
+}
+
+static void diagnostics_sample(struct k_work* work) {
+    // Static, the system workqueue stack is small and this is only ever built here
+    static diagnostics_telemetry_t telemetry;
+    static diagnostics_thread_cycles_t thread_cycles[DIAGNOSTICS_MAX_THREADS];
+
+    k_thread_runtime_stats_t all_stats;
+    k_thread_runtime_stats_all_get(&all_stats);
+    uint64_t period_cycles = all_stats.execution_cycles - last_all_stats.execution_cycles;
+    uint64_t idle_cycles = all_stats.idle_cycles - last_all_stats.idle_cycles;
+    last_all_stats = all_stats;
+
+    memset(&telemetry, 0, sizeof(telemetry));
+    memset(thread_cycles, 0, sizeof(thread_cycles));
+    telemetry.header.version = DIAGNOSTICS_TELEMETRY_VERSION;
+    telemetry.header.cpu_load_permille = 1000 - diagnostics_permille(idle_cycles, period_cycles);
+    telemetry.header.uptime_ms = k_uptime_get_32();
+    telemetry.header.rx_updates = atomic_get(&pipeline_counters.rx_updates);
+    telemetry.header.rx_rejected = atomic_get(&pipeline_counters.rx_rejected);
+    telemetry.header.rx_coalesced = atomic_get(&pipeline_counters.rx_coalesced);
+    telemetry.header.render_overruns = atomic_get(&pipeline_counters.render_overruns);
+
+    diagnostics_pass_t pass = {
+        .telemetry = &telemetry,
+        .cycles = thread_cycles,
+        .period_cycles = period_cycles,
+    };
+    k_thread_foreach_unlocked(diagnostics_sample_thread, &pass);
+    memcpy(last_thread_cycles, thread_cycles, sizeof(last_thread_cycles));
+
+    k_spinlock_key_t key = k_spin_lock(&diagnostics_lock);
+    diagnostics_published = telemetry;
+    k_spin_unlock(&diagnostics_lock, key);
+
+    ble_telemetry_notify(&telemetry.header, sizeof(telemetry.header));
+
+    k_work_schedule(&diagnostics_work, K_MSEC(DIAGNOSTICS_PERIOD_MS));
+}
+
+static void diagnostics_sample_thread(const struct k_thread* thread, void* user_data) {
+    diagnostics_pass_t* pass = user_data;
+    uint8_t index = pass->telemetry->header.thread_count;
+
+    if (index >= DIAGNOSTICS_MAX_THREADS) {
+        return;
+    }
+    pass->telemetry->header.thread_count++;
+
+    k_thread_runtime_stats_t stats;
+    k_thread_runtime_stats_get((k_tid_t) thread, &stats);
+    pass->cycles[index].thread = thread;
+    pass->cycles[index].cycles = stats.execution_cycles;
+
+    // Threads are usually listed in the same order every pass, so their previous slot is checked first
+    uint64_t last_cycles = stats.execution_cycles; // A thread seen for the first time is reported idle for its first period
+    for (int i = 0; i < DIAGNOSTICS_MAX_THREADS; i++) {
+        const diagnostics_thread_cycles_t* last = &last_thread_cycles[(index + i) % DIAGNOSTICS_MAX_THREADS];
+        if (last->thread == thread) {
+            last_cycles = last->cycles;
+            break;
+        }
+    }
+
+    diagnostics_thread_t* entry = &pass->telemetry->threads[index];
+    entry->cpu_permille = diagnostics_permille(stats.execution_cycles - last_cycles, pass->period_cycles);
+
+    const char* name = k_thread_name_get((k_tid_t) thread);
+    if (name != NULL && name[0] != '\0') {
+        strncpy(entry->name, name, DIAGNOSTICS_THREAD_NAME_LENGTH);
+    } else {
+        snprintk(entry->name, DIAGNOSTICS_THREAD_NAME_LENGTH, "%p", thread);
+    }
+
+    size_t unused = 0;
+    entry->stack_size = MIN(thread->stack_info.size, UINT16_MAX);
+    if (k_thread_stack_space_get(thread, &unused) == 0) {
+        entry->stack_peak = MIN(thread->stack_info.size - unused, UINT16_MAX);
+    }
+}
+
+static uint16_t diagnostics_permille(uint64_t part, uint64_t whole) {
+    return whole ? (uint16_t) MIN(part * 1000 / whole, 1000) : 0;
+}
+
+/**
+ * Shell commands
+ */
+
+#if defined(CONFIG_SHELL)
+static int diagnostics_cmd_threads(const struct shell* sh, size_t argc, char** argv) {
+    diagnostics_telemetry_t telemetry;
+    diagnostics_telemetry_get(&telemetry);
+
+    shell_print(sh, "%-12s %7s %13s", "thread", "cpu", "stack peak");
+    for (uint8_t i = 0; i < telemetry.header.thread_count; i++) {
+        const diagnostics_thread_t* thread = &telemetry.threads[i];
+        shell_print(sh, "%-12.12s %5u.%u%% %5u / %5u B", thread->name, thread->cpu_permille / 10, thread->cpu_permille % 10,
+            thread->stack_peak, thread->stack_size);
+    }
+    return 0;
+}
+
+static int diagnostics_cmd_link(const struct shell* sh, size_t argc, char** argv) {
+    diagnostics_telemetry_t telemetry;
+    diagnostics_telemetry_get(&telemetry);
+
+    shell_print(sh, "CPU load %u.%u%%, up %u s", telemetry.header.cpu_load_permille / 10,
+        telemetry.header.cpu_load_permille % 10, telemetry.header.uptime_ms / 1000);
+    shell_print(sh, "writes: %u accepted, %u rejected, %u coalesced", telemetry.header.rx_updates,
+        telemetry.header.rx_rejected, telemetry.header.rx_coalesced);
+    shell_print(sh, "render overruns: %u", telemetry.header.render_overruns);
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(diagnostics_cmds,
+    SHELL_CMD(threads, NULL, "CPU usage over the last second and stack high-watermark per thread", diagnostics_cmd_threads),
+    SHELL_CMD(link, NULL, "CPU load and BLE write counters", diagnostics_cmd_link),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(diag, &diagnostics_cmds, "Runtime diagnostics", NULL);
+#endif
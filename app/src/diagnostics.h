@@ -0,0 +1,64 @@
+/**
+ * @file diagnostics.h
+ */
+
+#ifndef DIAGNOSTICS_H
+#define DIAGNOSTICS_H
+
+/**
+ * Includes
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+
+/**
+ * Defines
+ */
+
+#define DIAGNOSTICS_PERIOD_MS 1000 // Sampling period, CPU usage is the share of each period a thread ran for
+#define DIAGNOSTICS_MAX_THREADS 12 // Threads past this many aren't reported
+#define DIAGNOSTICS_THREAD_NAME_LENGTH 12 // Bytes of each thread name kept, null padded (not terminated when it fills them)
+#define DIAGNOSTICS_TELEMETRY_VERSION 1
+
+/**
+ * Typedefs
+ */
+
+// Telemetry characteristic layout, all fields little-endian. Notifications carry only the header (it fits the default MTU),
+// a read returns the header followed by thread_count thread entries
+typedef struct __packed {
+    uint8_t version;
+    uint8_t thread_count;
+    uint16_t cpu_load_permille; // Share of the last period spent outside the idle thread
+    uint32_t uptime_ms;
+    uint32_t rx_updates; // Writes accepted since boot
+    uint32_t rx_rejected; // Writes refused for their length or contents since boot
+    uint32_t rx_coalesced; // Writes that arrived while a redraw was already pending, shown together with an earlier write
+    uint32_t render_overruns; // Super loop iterations over PIPELINE_RENDER_BUDGET_MS since boot
+} diagnostics_telemetry_header_t;
+
+typedef struct __packed {
+    char name[DIAGNOSTICS_THREAD_NAME_LENGTH];
+    uint16_t cpu_permille; // Share of the last period this thread ran for
+    uint16_t stack_size; // Bytes
+    uint16_t stack_peak; // Most bytes of stack ever used, from the unused tail left by CONFIG_INIT_STACKS
+} diagnostics_thread_t;
+
+typedef struct __packed {
+    diagnostics_telemetry_header_t header;
+    diagnostics_thread_t threads[DIAGNOSTICS_MAX_THREADS];
+} diagnostics_telemetry_t;
+
+/**
+ * Function prototypes
+ */
+
+// Starts sampling on the system workqueue every DIAGNOSTICS_PERIOD_MS
+void diagnostics_init();
+
+// Copies out the latest sample, safe from any thread. Returns the length in bytes of the header and the used thread entries
+size_t diagnostics_telemetry_get(diagnostics_telemetry_t* out);
+
+#endif
@@ -7,16 +7,24 @@
 #include <zephyr/device.h>
 #include <zephyr/drivers/i2c.h>
 #include <zephyr/drivers/display.h>
-#include <zephyr/sys/printk.h> 
+#include <zephyr/logging/log.h>
 #include <lvgl.h>
 
 #include "touchscreen_defines.h"
+#include "app_trace.h"
 #include "state_machine.h"
 #include "ble_peripheral.h"
+#include "ble_observer.h"
+#include "pipeline_status.h"
+#include "metric_bus.h"
+#include "diagnostics.h"
+#include "activity.h"
 #include "BTN.h"
 #include "LED.h"
 #include "lv_data_obj.h"
 
+LOG_MODULE_REGISTER(main, CONFIG_APP_LOG_LEVEL);
+
 /**
  * Local variables
  */
@@ -47,6 +55,16 @@ void touch_control_cmd_rsp(uint8_t cmd, uint8_t* rsp) {
   i2c_transfer(i2c_dev, cmd_rsp_msg, 2, TD_ADDR);
 }
 
+#if defined(CONFIG_APP_ACTIVITY)
+// Whether the screen is being held down right now. LVGL has no input device registered (see main), so this poll is how touches
+// keep the display awake and wake it up
+static bool touch_is_pressed() {
+  uint8_t touch_status = 0;
+  touch_control_cmd_rsp(TD_STATUS, &touch_status);
+  return touch_status == 1;
+}
+#endif
+
 /*
 
 LVGL setup
@@ -73,6 +91,8 @@ void touch_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
   3. Else if no touch is detected...
   */
 
+  APP_TRACE_BEGIN("touch_read", 0);
+
   uint8_t touch_status;
   touch_control_cmd_rsp(TD_STATUS, &touch_status); // Get touchscreen status (is it ready?)
 
@@ -96,6 +116,10 @@ void touch_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
     data->point.x = x_pos;
     data->point.y = y_pos;
     data->state = LV_INDEV_STATE_PRESSED;
+
+#if defined(CONFIG_APP_ACTIVITY)
+    activity_report();
+#endif
   }
   // If the screen isn't currently being touched (released)
   else if (touch_status == 0) {
@@ -108,75 +132,192 @@ void touch_read_cb(lv_indev_t* indev, lv_indev_data_t* data) {
     data->point.x = x_pos;
     data->point.y = y_pos;
 
-    printk("Press at %u, %u\n", x_pos, y_pos);
+    LOG_DBG("Press at %u, %u", x_pos, y_pos);
+  }
+
+  APP_TRACE_END("touch_read", touch_status);
+}
+
+/*
+
+Boot timing
+
+*/
+
+// Phases of boot in roughly the order they finish, the BLE ones finish on their own alongside the display and UI ones
+typedef enum {
+  BOOT_PHASE_BT_STARTED,
+  BOOT_PHASE_I2C,
+  BOOT_PHASE_DISPLAY,
+  BOOT_PHASE_BUTTONS,
+  BOOT_PHASE_LEDS,
+  BOOT_PHASE_UI,
+  BOOT_PHASE_BT_READY,
+  BOOT_PHASE_ADVERTISING,
+  BOOT_PHASE_FIRST_FRAME,
+  NUM_BOOT_PHASES,
+} boot_phase_t;
+
+static const char* const boot_phase_names[NUM_BOOT_PHASES] = {
+  [BOOT_PHASE_BT_STARTED] = "bt_started",
+  [BOOT_PHASE_I2C] = "i2c",
+  [BOOT_PHASE_DISPLAY] = "display",
+  [BOOT_PHASE_BUTTONS] = "buttons",
+  [BOOT_PHASE_LEDS] = "leds",
+  [BOOT_PHASE_UI] = "ui",
+  [BOOT_PHASE_BT_READY] = "bt_ready",
+  [BOOT_PHASE_ADVERTISING] = "advertising",
+  [BOOT_PHASE_FIRST_FRAME] = "first_frame",
+};
+
+// Microseconds since the kernel started at the end of each phase, 0 for phases that failed or haven't finished
+static atomic_t boot_phase_us[NUM_BOOT_PHASES];
+
+// The boot report is printed once both advertising and the first frame are done (or have failed), whichever comes last
+static atomic_t boot_milestones_left = ATOMIC_INIT(2);
+
+static void boot_report() {
+  for (int phase = 0; phase < NUM_BOOT_PHASES; phase++) {
+    uint32_t us = atomic_get(&boot_phase_us[phase]);
+    if (us) {
+      LOG_INF("Boot phase %-12s done at %7u us", boot_phase_names[phase], us);
+    } else {
+      LOG_WRN("Boot phase %-12s failed", boot_phase_names[phase]);
+    }
+  }
+  LOG_INF("Boot to first frame %u us, boot to advertising %u us",
+          (uint32_t) atomic_get(&boot_phase_us[BOOT_PHASE_FIRST_FRAME]),
+          (uint32_t) atomic_get(&boot_phase_us[BOOT_PHASE_ADVERTISING]));
+}
+
+// Called from main and from the Bluetooth ready callback, reached is false when the phase failed and is skipped
+static void boot_phase_done(boot_phase_t phase, bool reached) {
+  if (reached) {
+    atomic_set(&boot_phase_us[phase], k_ticks_to_us_floor32(k_uptime_ticks()));
+  }
+
+  if ((phase == BOOT_PHASE_ADVERTISING || phase == BOOT_PHASE_FIRST_FRAME) && atomic_dec(&boot_milestones_left) == 1) {
+    boot_report();
+  }
+}
+
+/*
+
+BLE setup
+
+*/
+
+// Runs once the controller is up, on the thread that brought it up, while main carries on preparing the display
+static void bt_ready_cb(int bt_err) {
+  if (bt_err) {
+    LOG_ERR("Bluetooth init failed (err %d), carrying on without BLE", bt_err);
+    boot_phase_done(BOOT_PHASE_BT_READY, false);
+    boot_phase_done(BOOT_PHASE_ADVERTISING, false);
+    return;
   }
+  LOG_INF("Bluetooth initialized");
+  boot_phase_done(BOOT_PHASE_BT_READY, true);
+
+#if defined(CONFIG_APP_BLE_OBSERVER)
+  // Listen for host broadcasts instead of waiting for a connection
+  int adv_err = ble_observer_start();
+#else
+  // Start BLE advertising
+  int adv_err =
+      bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ble_advertising_data, advertising_data_array_size,
+                      ble_scan_response_data, scan_response_data_array_size);
+  if (adv_err) {
+    LOG_ERR("Advertising failed to start (err %d)", adv_err);
+  }
+#endif
+  boot_phase_done(BOOT_PHASE_ADVERTISING, adv_err == 0);
 }
 
 int main(void) {
   /**
    * Initialization checks
+   *
+   * Only a missing display stops the UI, every other failure just loses the feature that needed it
    */
 
-  // If the I2C peripheral is not yet ready
-  if(!device_is_ready(i2c_dev)) {
-    printk("I2C device not yet ready.\n");
-    return 0;
+  // Bring the controller up in the background, it takes longer than anything else here and needs none of it
+  err = bt_enable(bt_ready_cb);
+  if (err) {
+    LOG_ERR("Bluetooth failed to start (err %d), carrying on without BLE", err);
+    boot_phase_done(BOOT_PHASE_ADVERTISING, false);
+  } else {
+    boot_phase_done(BOOT_PHASE_BT_STARTED, true);
   }
 
+  // The touchscreen is on I2C, without it only the buttons work
+  bool touch_available = device_is_ready(i2c_dev);
+  if (!touch_available) {
+    LOG_ERR("I2C device not yet ready, touch disabled");
+  }
   // Configure I2C device with 100KHz clock on Master mode
-  if(0 > i2c_configure(i2c_dev, I2C_SPEED_SET(I2C_SPEED_STANDARD) | I2C_MODE_CONTROLLER)) {
-    printk("Error while configuring I2C device.\n");
+  else if(0 > i2c_configure(i2c_dev, I2C_SPEED_SET(I2C_SPEED_STANDARD) | I2C_MODE_CONTROLLER)) {
+    LOG_ERR("Error while configuring I2C device");
   }
+  boot_phase_done(BOOT_PHASE_I2C, touch_available);
 
-  if(!device_is_ready(display_dev)) {
-    printk("LCD drivers not yet ready.\n");
-    return 0;
-  }
+  // Without a display the UI can't run, BLE and the status LEDs still can
+  bool display_available = device_is_ready(display_dev);
+  if (!display_available) {
+    LOG_ERR("LCD drivers not yet ready, UI disabled");
+  } else {
+    // If we get to this point, the LCD drivers are ready and we can initialize the LVGL screen object
+    screen = lv_screen_active();
 
-  // If we get to this point, the LCD drivers are ready and we can initialize the LVGL screen object
-  screen = lv_screen_active();
-  
-  if (screen == NULL) {
-    printk("Failed to initialize LVGL screen.\n");
-    return 0;
+    if (screen == NULL) {
+      LOG_ERR("Failed to initialize LVGL screen, UI disabled");
+      display_available = false;
+    }
   }
-
-  // "Turn on" the screen so we can actually see things on it
-  display_blanking_off(display_dev);
+  boot_phase_done(BOOT_PHASE_DISPLAY, display_available);
 
   // Initialize buttons
-  if (0 > BTN_init()) {
-    printk("Buttons not yet ready.\n");
-    return 0;
+  int btn_err = BTN_init();
+  if (0 > btn_err) {
+    LOG_ERR("Buttons not yet ready, buttons disabled");
   }
+  boot_phase_done(BOOT_PHASE_BUTTONS, btn_err >= 0);
 
-  // Initialize LEDs
-  if (0 > LED_init()) {
-    printk("LEDs not yet ready.\n");
-    return 0;
-  }
-  
-  // Enable BLE
-  err = bt_enable(NULL);
-  if (err) {
-    printk("Bluetooth init failed (err %d)\n", err);
-    return 0;
-  } else {
-    printk("Bluetooth initialized!\n");
+  // Initialize LEDs, the status LEDs are the only user
+  int led_err = LED_init();
+  if (0 > led_err) {
+    LOG_ERR("LEDs not yet ready, status LEDs disabled");
   }
+  boot_phase_done(BOOT_PHASE_LEDS, led_err >= 0);
 
-  // Start BLE advertising
-  err =
-      bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ble_advertising_data, advertising_data_array_size,
-                      ble_scan_response_data, scan_response_data_array_size);
-  if (err) {
-    printk("Advertising failed to start (err %d)\n", err);
-    return 0;
+  // Evaluate the pipeline counters for the status LEDs, the ingest report and diagnostics, with or without LEDs to show them on
+  pipeline_status_init(led_err >= 0);
+
+#if defined(CONFIG_APP_DIAGNOSTICS)
+  // Start sampling threads and link counters for the telemetry characteristic
+  diagnostics_init();
+#endif
+
+  if (!display_available) {
+    boot_phase_done(BOOT_PHASE_UI, false);
+    boot_phase_done(BOOT_PHASE_FIRST_FRAME, false);
+    return 0; // BLE, the status LEDs and diagnostics keep running on their own threads
   }
 
+#if defined(CONFIG_APP_UI_BENCHMARK)
+  // Measure the metric bus and every screen before the UI takes over the display
+  metric_bus_benchmark();
+  state_machine_benchmark();
+#endif
+
   // Initialize the state machine
   state_machine_init();
 
+#if defined(CONFIG_APP_ACTIVITY)
+  // Blank the display and relax the connection after a while without input
+  activity_init(display_dev, touch_available ? touch_is_pressed : NULL);
+#endif
+  boot_phase_done(BOOT_PHASE_UI, true);
+
   // Set up LVGL so that the button press callback is called every SLEEP_MS period
   // NOTE: "lv_indev" means "LVGL input device", and our input, a touchscreen is of type "pointer" (like a cursor)
   // lv_indev_t* indev = lv_indev_create();
@@ -184,12 +325,30 @@ int main(void) {
   // lv_indev_set_read_cb(indev, touch_read_cb);
 
   // Run the state machine
+  bool first_frame = true;
   while (1) {
+#if defined(CONFIG_APP_ACTIVITY)
+    // Blocks for as long as the display sleeps, LVGL and the state machine are paused until input wakes it
+    activity_run();
+#endif
+
+    int64_t frame_start = k_uptime_get();
+
     if (0 > state_machine_run()) {
-      printk("Error occured while running state machine.\n");
+      LOG_ERR("Error occured while running state machine");
       return 0;
     }
 
+    // Time spent in LVGL/the state machine this iteration, used to detect render overruns
+    pipeline_status_frame_done((uint32_t) (k_uptime_get() - frame_start));
+
+    if (first_frame) {
+      // "Turn on" the screen only once the first screen is in the panel's memory, so the power-on contents never show
+      display_blanking_off(display_dev);
+      boot_phase_done(BOOT_PHASE_FIRST_FRAME, true);
+      first_frame = false;
+    }
+
     k_msleep(SLEEP_MS);
   }
   return 0;
@@ -0,0 +1,83 @@
+/**
+ * @file metric_alerts.c
+ */
+
+#include <zephyr/logging/log.h>
+
+#include "metric_alerts.h"
+#include "metric_bus.h"
+
+LOG_MODULE_REGISTER(metric_alerts, CONFIG_APP_LOG_LEVEL);
+
+/**
+ * Typedefs
+ */
+
+typedef struct {
+    const char* name;
+    uint32_t threshold;
+    const char* unit;
+} metric_alert_config_t;
+
+/**
+ * Prototypes
+ */
+
+static void metric_alerts_thread(void* p1, void* p2, void* p3);
+static void metric_alerts_check(metric_alert_t alert, uint32_t value);
+
+/**
+ * Local variables
+ */
+
+atomic_t metric_alerts_active;
+
+static const metric_alert_config_t metric_alert_configs[NUM_METRIC_ALERTS] = {
+    [METRIC_ALERT_CPU_TEMP] = {"CPU temperature", METRIC_ALERT_CPU_TEMP_CELSIUS, "C"},
+    [METRIC_ALERT_GPU_TEMP] = {"GPU temperature", METRIC_ALERT_GPU_TEMP_CELSIUS, "C"},
+    [METRIC_ALERT_RAM_USAGE] = {"RAM usage", METRIC_ALERT_RAM_USAGE_PERCENT, "%"},
+};
+
+// A subscriber rather than a listener: checks and logging run on the alerts thread, never on the publisher's
+ZBUS_SUBSCRIBER_DEFINE(metric_alerts_subscriber, METRIC_ALERTS_QUEUE_SIZE);
+
+K_THREAD_DEFINE(metric_alerts_tid, METRIC_ALERTS_STACK_SIZE, metric_alerts_thread, NULL, NULL, NULL,
+    METRIC_ALERTS_PRIORITY, 0, 0);
+
+/**
+ * Function definitions
+ */
+
+static void metric_alerts_thread(void* p1, void* p2, void* p3) {
+    k_thread_name_set(k_current_get(), "metric_alerts");
+
+    const struct zbus_channel* chan;
+    while (zbus_sub_wait(&metric_alerts_subscriber, &chan, K_FOREVER) == 0) {
+        // The notification only says the channel changed, the value read is the latest, which is the one worth checking
+        if (chan == &metric_scalar_chan) {
+            cpu_gpu_scalar_metrics_t scalar;
+            if (zbus_chan_read(chan, &scalar, METRIC_BUS_TIMEOUT) == 0) {
+                metric_alerts_check(METRIC_ALERT_CPU_TEMP, scalar.cpu_temp_celsius);
+                metric_alerts_check(METRIC_ALERT_GPU_TEMP, scalar.gpu_temp_celsius);
+            }
+        } else if (chan == &metric_percent_chan) {
+            cpu_gpu_ram_percentage_metrics_t percent;
+            if (zbus_chan_read(chan, &percent, METRIC_BUS_TIMEOUT) == 0) {
+                metric_alerts_check(METRIC_ALERT_RAM_USAGE, percent.ram_usage_percent);
+            }
+        }
+    }
+}
+
+static void metric_alerts_check(metric_alert_t alert, uint32_t value) {
+    const metric_alert_config_t* config = &metric_alert_configs[alert];
+    bool active = atomic_test_bit(&metric_alerts_active, alert);
+
+    if (!active && value > config->threshold) {
+        atomic_set_bit(&metric_alerts_active, alert);
+        LOG_WRN("%s %u %s, over %u %s", config->name, value, config->unit, config->threshold, config->unit);
+    } else if (active && value + METRIC_ALERT_HYSTERESIS < config->threshold) {
+        atomic_clear_bit(&metric_alerts_active, alert);
+        LOG_INF("%s back to %u %s", config->name, value, config->unit);
+    }
+}
@@ -0,0 +1,52 @@
+/**
+ * @file metric_alerts.h
+ */
+
+#ifndef METRIC_ALERTS_H
+#define METRIC_ALERTS_H
+
+/**
+ * Includes
+ */
+
+#include <stdbool.h>
+#include <zephyr/sys/atomic.h>
+
+#include "pipeline_status.h"
+
+/**
+ * Defines
+ */
+
+// An alert raises once its metric goes over the threshold, and clears once it drops HYSTERESIS below it again, so a metric
+// sitting on the threshold doesn't raise it over and over
+#define METRIC_ALERT_CPU_TEMP_CELSIUS 90
+#define METRIC_ALERT_GPU_TEMP_CELSIUS 85
+#define METRIC_ALERT_RAM_USAGE_PERCENT 90
+#define METRIC_ALERT_HYSTERESIS 5
+
+#define METRIC_ALERTS_STACK_SIZE 1024
+#define METRIC_ALERTS_PRIORITY 10 // Below the UI, alerts are allowed to lag
+
+// Channel notifications waiting for the alerts thread. A full queue makes the publisher (the BT RX thread) wait up to
+// METRIC_BUS_TIMEOUT, so the queue holds every notification the client can send at its burst rate while the thread lags by
+// up to METRIC_ALERTS_MAX_LAG_MS behind long redraws
+#define METRIC_ALERTS_BURST_RATE_HZ 10 // Fastest rate the client sends each metric group at
+#define METRIC_ALERTS_MAX_LAG_MS 1000
+#define METRIC_ALERTS_QUEUE_SIZE (NUM_METRIC_GROUPS * METRIC_ALERTS_BURST_RATE_HZ * METRIC_ALERTS_MAX_LAG_MS / 1000)
+
+/**
+ * Typedefs
+ */
+
+typedef enum {
+    METRIC_ALERT_CPU_TEMP = 0,
+    METRIC_ALERT_GPU_TEMP,
+    METRIC_ALERT_RAM_USAGE,
+    NUM_METRIC_ALERTS,
+} metric_alert_t;
+
+// Bit per metric_alert_t, set while that alert is raised
+extern atomic_t metric_alerts_active;
+
+#endif
@@ -0,0 +1,156 @@
+/**
+ * @file metric_bus.c
+ */
+
+#include <zephyr/logging/log.h>
+#include <zephyr/timing/timing.h>
+
+#include "app_log.h"
+#include "metric_bus.h"
+
+LOG_MODULE_REGISTER(metric_bus, CONFIG_APP_LOG_LEVEL);
+
+/**
+ * Channel definitions
+ */
+
+ZBUS_OBS_DECLARE(pipeline_status_metric_listener, state_machine_metric_listener, metric_history_listener,
+    metric_alerts_subscriber);
+
+ZBUS_CHAN_DEFINE(metric_scalar_chan, cpu_gpu_scalar_metrics_t, NULL, NULL,
+    ZBUS_OBSERVERS(pipeline_status_metric_listener, state_machine_metric_listener, metric_alerts_subscriber),
+    ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(metric_network_chan, network_scalar_metrics_t, NULL, NULL,
+    ZBUS_OBSERVERS(pipeline_status_metric_listener, state_machine_metric_listener),
+    ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(metric_percent_chan, cpu_gpu_ram_percentage_metrics_t, NULL, NULL,
+    ZBUS_OBSERVERS(pipeline_status_metric_listener, state_machine_metric_listener, metric_history_listener,
+        metric_alerts_subscriber),
+    ZBUS_MSG_INIT(0));
+
+/**
+ * Local variables
+ */
+
+// Indexed by metric_group_t
+static const struct zbus_channel* const metric_bus_channels[NUM_METRIC_GROUPS] = {
+    [METRIC_GROUP_SCALAR] = &metric_scalar_chan,
+    [METRIC_GROUP_NETWORK] = &metric_network_chan,
+    [METRIC_GROUP_PERCENT] = &metric_percent_chan,
+};
+
+/**
+ * Function definitions
+ */
+
+int metric_bus_publish(metric_group_t group, const void* values) {
+    int err = zbus_chan_pub(metric_bus_channels[group], values, METRIC_BUS_TIMEOUT);
+
+    if (err) {
+        APP_LOG_WRN_RATELIMIT("Publishing metric group %d failed (err %d)", group, err);
+    }
+    return err;
+}
+
+const struct zbus_channel* metric_bus_channel(metric_group_t group) {
+    return metric_bus_channels[group];
+}
+
+metric_group_t metric_bus_group(const struct zbus_channel* chan) {
+    for (int group = 0; group < NUM_METRIC_GROUPS; group++) {
+        if (metric_bus_channels[group] == chan) {
+            return group;
+        }
+    }
+    return NUM_METRIC_GROUPS;
+}
+
+void metric_bus_get(ble_metrics_snapshot_t* out) {
+    zbus_chan_read(&metric_scalar_chan, &out->scalar, METRIC_BUS_TIMEOUT);
+    zbus_chan_read(&metric_network_chan, &out->network, METRIC_BUS_TIMEOUT);
+    zbus_chan_read(&metric_percent_chan, &out->percent, METRIC_BUS_TIMEOUT);
+}
+
+/**
+ * Publish benchmark
+ *
+ * Separate channels with the same message type as the percent group and observers that do next to nothing, so what's measured
+ * is the bus itself: the copy, the lock and the notification of each observer
+ */
+#if defined(CONFIG_APP_UI_BENCHMARK)
+
+#define METRIC_BUS_BENCHMARK_PUBLISHES 1000
+#define METRIC_BUS_BENCHMARK_LISTENERS 4
+
+static atomic_t metric_bus_benchmark_notified;
+
+static void metric_bus_benchmark_cb(const struct zbus_channel* chan) {
+    atomic_inc(&metric_bus_benchmark_notified);
+}
+
+ZBUS_LISTENER_DEFINE(metric_bus_benchmark_listener_0, metric_bus_benchmark_cb);
+ZBUS_LISTENER_DEFINE(metric_bus_benchmark_listener_1, metric_bus_benchmark_cb);
+ZBUS_LISTENER_DEFINE(metric_bus_benchmark_listener_2, metric_bus_benchmark_cb);
+ZBUS_LISTENER_DEFINE(metric_bus_benchmark_listener_3, metric_bus_benchmark_cb);
+ZBUS_SUBSCRIBER_DEFINE(metric_bus_benchmark_subscriber, 1);
+
+ZBUS_CHAN_DEFINE(metric_bus_benchmark_bare_chan, cpu_gpu_ram_percentage_metrics_t, NULL, NULL, ZBUS_OBSERVERS_EMPTY,
+    ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(metric_bus_benchmark_listeners_chan, cpu_gpu_ram_percentage_metrics_t, NULL, NULL,
+    ZBUS_OBSERVERS(metric_bus_benchmark_listener_0, metric_bus_benchmark_listener_1, metric_bus_benchmark_listener_2,
+        metric_bus_benchmark_listener_3),
+    ZBUS_MSG_INIT(0));
+
+ZBUS_CHAN_DEFINE(metric_bus_benchmark_subscriber_chan, cpu_gpu_ram_percentage_metrics_t, NULL, NULL,
+    ZBUS_OBSERVERS(metric_bus_benchmark_subscriber),
+    ZBUS_MSG_INIT(0));
+
+// Average ns per publish, the subscriber's queue is drained after every publish and that isn't counted. A publish takes a
+// few microseconds, so it is timed with the timing API (the DWT cycle counter on Cortex-M): k_cycle_get_32 is the 32 kHz
+// RTC on nRF and would read 0 or 1 tick for almost every publish
+static uint32_t metric_bus_benchmark_channel(const struct zbus_channel* chan, bool drain) {
+    cpu_gpu_ram_percentage_metrics_t values = {0};
+    uint64_t total_cycles = 0;
+
+    for (uint32_t run = 0; run < METRIC_BUS_BENCHMARK_PUBLISHES; run++) {
+        values.cpu_usage_percent = run % 101;
+
+        timing_t start = timing_counter_get();
+        zbus_chan_pub(chan, &values, K_NO_WAIT);
+        timing_t end = timing_counter_get();
+        total_cycles += timing_cycles_get(&start, &end);
+
+        if (drain) {
+            const struct zbus_channel* notified;
+            zbus_sub_wait(&metric_bus_benchmark_subscriber, &notified, K_NO_WAIT);
+        }
+    }
+    return (uint32_t) (timing_cycles_to_ns(total_cycles) / METRIC_BUS_BENCHMARK_PUBLISHES);
+}
+
+static void metric_bus_benchmark_print(const char* observers, uint32_t count, uint32_t ns, uint32_t bare_ns) {
+    uint32_t per_observer_ns = count ? (ns - MIN(ns, bare_ns)) / count : 0;
+
+    printk("BUSBENCH {\"observers\":\"%s\",\"count\":%u,\"publishes\":%u,\"time_ns_avg\":%u,\"per_observer_ns\":%u}\n",
+        observers, count, METRIC_BUS_BENCHMARK_PUBLISHES, ns, per_observer_ns);
+}
+
+void metric_bus_benchmark() {
+    timing_init();
+    timing_start();
+
+    uint32_t bare = metric_bus_benchmark_channel(&metric_bus_benchmark_bare_chan, false);
+    uint32_t listeners = metric_bus_benchmark_channel(&metric_bus_benchmark_listeners_chan, false);
+    uint32_t subscriber = metric_bus_benchmark_channel(&metric_bus_benchmark_subscriber_chan, true);
+
+    timing_stop();
+
+    metric_bus_benchmark_print("none", 0, bare, bare);
+    metric_bus_benchmark_print("listener", METRIC_BUS_BENCHMARK_LISTENERS, listeners, bare);
+    metric_bus_benchmark_print("subscriber", 1, subscriber, bare);
+}
+
+#endif
@@ -0,0 +1,63 @@
+/**
+ * @file metric_bus.h
+ */
+
+#ifndef METRIC_BUS_H
+#define METRIC_BUS_H
+
+/**
+ * Includes
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/zbus/zbus.h>
+
+#include "ble_peripheral.h"
+#include "pipeline_status.h"
+
+/**
+ * Defines
+ */
+
+// How long a publisher or reader waits for a channel another thread holds. Channels are only held for a copy and the listeners,
+// so this is never reached in practice, but a publisher on the BT RX thread must not wait forever
+#define METRIC_BUS_TIMEOUT K_MSEC(10)
+
+/**
+ * Channels
+ *
+ * One channel per metric group, carrying the group's struct as the client sends it. Every ingest path (GATT writes, host
+ * broadcasts, the UI benchmark) publishes each group it received exactly once, and the channel keeps the latest value.
+ *
+ * Observers, in the order they are notified:
+ * - pipeline_status_metric_listener: freshness and RX counters behind the status LEDs (listener, runs on the publisher)
+ * - state_machine_metric_listener: flags the UI for a redraw (listener)
+ * - metric_history_listener: appends usage to the history ring buffer (listener, percent group only)
+ * - metric_alerts_subscriber: threshold checks on their own thread (subscriber, scalar and percent groups only). Its queue
+ *   absorbs up to METRIC_ALERTS_MAX_LAG_MS of burst-rate writes, so it can lag that far without holding up ingest
+ *
+ * Listeners must stay short and must not block, they run with the channel held on whichever thread published.
+ */
+
+ZBUS_CHAN_DECLARE(metric_scalar_chan, metric_network_chan, metric_percent_chan);
+
+/**
+ * Function prototypes
+ */
+
+// Publishes one group's new values. Copies into the channel's own storage, nothing is allocated
+int metric_bus_publish(metric_group_t group, const void* values);
+
+// The channel carrying a group, and the group a channel carries
+const struct zbus_channel* metric_bus_channel(metric_group_t group);
+metric_group_t metric_bus_group(const struct zbus_channel* chan);
+
+// Copies out the latest value of every group, each group is consistent on its own
+void metric_bus_get(ble_metrics_snapshot_t* out);
+
+#if defined(CONFIG_APP_UI_BENCHMARK)
+// Times publishing with no observers, with listeners and with a subscriber, and prints the cost per observer as BUSBENCH lines
+void metric_bus_benchmark();
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+/**
+ * @file metric_history.c
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+
+#include "metric_bus.h"
+#include "metric_history.h"
+
+/**
+ * Prototypes
+ */
+
+static void metric_history_listener_cb(const struct zbus_channel* chan);
+
+/**
+ * Local variables
+ */
+
+// Ring buffer of the latest samples, next is where the next one goes
+static metric_history_sample_t history[METRIC_HISTORY_LENGTH];
+static size_t history_next;
+static size_t history_count;
+static struct k_spinlock history_lock;
+
+// A listener: appending is a few stores, cheaper than waking a thread to do it
+ZBUS_LISTENER_DEFINE(metric_history_listener, metric_history_listener_cb);
+
+/**
+ * Function definitions
+ */
+
+static void metric_history_listener_cb(const struct zbus_channel* chan) {
+    // Listeners run with the channel held, so the message can be read in place
+    const cpu_gpu_ram_percentage_metrics_t* percent = zbus_chan_const_msg(chan);
+
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    history[history_next] = (metric_history_sample_t) {
+        .uptime_ms = k_uptime_get_32(),
+        .cpu_usage_percent = MIN(percent->cpu_usage_percent, 100),
+        .gpu_usage_percent = MIN(percent->gpu_usage_percent, 100),
+        .ram_usage_percent = MIN(percent->ram_usage_percent, 100),
+    };
+    history_next = (history_next + 1) % METRIC_HISTORY_LENGTH;
+    history_count = MIN(history_count + 1, METRIC_HISTORY_LENGTH);
+    k_spin_unlock(&history_lock, key);
+}
+
+size_t metric_history_get(metric_history_sample_t* out, size_t max) {
+    k_spinlock_key_t key = k_spin_lock(&history_lock);
+    size_t count = MIN(max, history_count);
+    size_t first = (history_next + METRIC_HISTORY_LENGTH - count) % METRIC_HISTORY_LENGTH;
+
+    for (size_t i = 0; i < count; i++) {
+        out[i] = history[(first + i) % METRIC_HISTORY_LENGTH];
+    }
+    k_spin_unlock(&history_lock, key);
+
+    return count;
+}
+
+/**
+ * Shell commands
+ */
+
+#if defined(CONFIG_SHELL)
+static int metric_history_cmd_show(const struct shell* sh, size_t argc, char** argv) {
+    // Static, the full history is too large for the shell thread's stack
+    static metric_history_sample_t samples[METRIC_HISTORY_LENGTH];
+    size_t count = metric_history_get(samples, ARRAY_SIZE(samples));
+    uint32_t now = k_uptime_get_32();
+
+    shell_print(sh, "%8s %4s %4s %4s", "age s", "cpu", "gpu", "ram");
+    for (size_t i = 0; i < count; i++) {
+        shell_print(sh, "%8u %3u%% %3u%% %3u%%", (now - samples[i].uptime_ms) / 1000, samples[i].cpu_usage_percent,
+            samples[i].gpu_usage_percent, samples[i].ram_usage_percent);
+    }
+    return 0;
+}
+
+SHELL_CMD_REGISTER(history, NULL, "CPU, GPU and RAM usage received recently, oldest first", metric_history_cmd_show);
+#endif
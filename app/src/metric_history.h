@@ -0,0 +1,41 @@
+/**
+ * @file metric_history.h
+ */
+
+#ifndef METRIC_HISTORY_H
+#define METRIC_HISTORY_H
+
+/**
+ * Includes
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * Defines
+ */
+
+// Samples kept. The client sends the percent group between every 2 s (heartbeat) and 10 times a second (burst rate), so this
+// covers anywhere from the last 12 s to the last 4 minutes
+#define METRIC_HISTORY_LENGTH 120
+
+/**
+ * Typedefs
+ */
+
+typedef struct {
+    uint32_t uptime_ms; // When the sample was published
+    uint8_t cpu_usage_percent;
+    uint8_t gpu_usage_percent;
+    uint8_t ram_usage_percent;
+} metric_history_sample_t;
+
+/**
+ * Function prototypes
+ */
+
+// Copies out up to max of the most recent samples, oldest first, safe from any thread. Returns how many were copied
+size_t metric_history_get(metric_history_sample_t* out, size_t max);
+
+#endif
@@ -0,0 +1,254 @@
+/**
+ * @file pipeline_status.c
+ */
+
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/mem_stats.h>
+#include <lvgl_mem.h>
+
+#include "app_trace.h"
+#include "metric_bus.h"
+#include "pipeline_status.h"
+#include "LED.h"
+
+LOG_MODULE_REGISTER(pipeline_status, CONFIG_APP_LOG_LEVEL);
+
+/**
+ * Typedefs
+ */
+
+// What each status LED is currently showing, so that the LED engine is only sent changes
+typedef enum {
+    STATUS_LED_UNSET = 0,
+    STATUS_LED_OFF,
+    STATUS_LED_ON,
+    STATUS_LED_BLINK_SLOW,
+    STATUS_LED_BLINK_FAST,
+    STATUS_LED_DIM, // Brightness follows a value, see pipeline_status_evaluate
+} status_led_mode_t;
+
+/**
+ * Local variables
+ */
+
+pipeline_counters_t pipeline_counters;
+
+static struct k_work_delayable pipeline_status_work;
+
+// Counter values as of the previous evaluation, only touched from the system workqueue
+static atomic_val_t last_rx_updates;
+static atomic_val_t last_render_overruns;
+
+// Ingest report window, only touched from the system workqueue
+static uint32_t ingest_report_start_ms;
+static atomic_val_t ingest_report_rx_updates;
+static atomic_val_t ingest_report_rx_rejected;
+
+static bool status_leds_enabled; // False when the LEDs failed to initialize, the counters and reports still run
+static status_led_mode_t status_led_modes[NUM_LEDS];
+static uint8_t status_led_dim_levels[NUM_LEDS];
+
+/**
+ * LED mapping
+ *
+ * LED0: BLE link, blinking while advertising and solid once a client connects
+ * LED1: RX activity, lit for one evaluation period after any metric write
+ * LED2: Stale data, blinking when connected but any metric group went PIPELINE_STALE_MS without a write
+ * LED3: LVGL load, blinking fast on render overruns, otherwise dimmed to the LVGL heap usage
+ */
+
+#define STATUS_LED_LINK LED0
+#define STATUS_LED_RX LED1
+#define STATUS_LED_STALE LED2
+#define STATUS_LED_LVGL LED3
+
+/**
+ * Prototypes
+ */
+
+static void pipeline_status_evaluate(struct k_work* work);
+static void pipeline_status_apply(led_id led, status_led_mode_t mode, uint8_t dim_level);
+static uint8_t pipeline_status_heap_used_percent();
+static void pipeline_status_report_ingest();
+
+/**
+ * BLE connection tracking
+ */
+
+static void pipeline_status_connected(struct bt_conn* conn, uint8_t err) {
+    if (err == 0) {
+        // Give every metric group a full staleness period to arrive on a new connection
+        for (int group = 0; group < NUM_METRIC_GROUPS; group++) {
+            pipeline_status_metric_received(group);
+        }
+        atomic_set(&pipeline_counters.link_up, 1);
+    }
+}
+
+static void pipeline_status_disconnected(struct bt_conn* conn, uint8_t reason) {
+    atomic_set(&pipeline_counters.link_up, 0);
+}
+
+BT_CONN_CB_DEFINE(pipeline_status_conn_callbacks) = {
+    .connected = pipeline_status_connected,
+    .disconnected = pipeline_status_disconnected,
+};
+
+/**
+ * Metric bus
+ */
+
+// A listener, so the freshness timestamp and ingest start are taken the moment the write is published
+static void pipeline_status_metric_listener_cb(const struct zbus_channel* chan) {
+    pipeline_status_count_rx();
+    pipeline_status_metric_received(metric_bus_group(chan));
+}
+
+ZBUS_LISTENER_DEFINE(pipeline_status_metric_listener, pipeline_status_metric_listener_cb);
+
+/**
+ * Function definitions
+ */
+
+void pipeline_status_init(bool leds_available) {
+    status_leds_enabled = leds_available;
+    k_work_init_delayable(&pipeline_status_work, pipeline_status_evaluate);
+    k_work_schedule(&pipeline_status_work, K_NO_WAIT);
+}
+
+void pipeline_status_frame_done(uint32_t frame_time_ms) {
+    atomic_inc(&pipeline_counters.frames);
+
+    if (frame_time_ms > PIPELINE_RENDER_BUDGET_MS) {
+        atomic_inc(&pipeline_counters.render_overruns);
+    }
+}
+
+void pipeline_status_ingest_shown(uint32_t start_cycles) {
+    uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - start_cycles);
+
+    atomic_add(&pipeline_counters.ingest_latency_total_us, latency_us);
+    atomic_inc(&pipeline_counters.ingest_latency_samples);
+
+    // Only the UI thread raises the maximum and only the report clears it, so a lost race at worst drops one maximum
+    if (latency_us > (uint32_t) atomic_get(&pipeline_counters.ingest_latency_max_us)) {
+        atomic_set(&pipeline_counters.ingest_latency_max_us, latency_us);
+    }
+}
+
+// Only meaningful while connected, with no link there is nothing to be fresh relative to
+bool pipeline_status_metric_stale(metric_group_t group) {
+    if (!atomic_get(&pipeline_counters.link_up)) {
+        return false;
+    }
+
+    // Unsigned subtraction keeps this correct across the 32-bit uptime wrap
+    uint32_t age_ms = k_uptime_get_32() - (uint32_t) atomic_get(&pipeline_counters.last_rx_ms[group]);
+    return age_ms > PIPELINE_STALE_MS;
+}
+
+// Percentage of the LVGL memory pool in use, lvgl_heap_stats takes the pool's own lock so this is safe off the LVGL thread
+static uint8_t pipeline_status_heap_used_percent() {
+    struct sys_memory_stats heap;
+    lvgl_heap_stats(&heap);
+
+    size_t total = heap.allocated_bytes + heap.free_bytes;
+    return total ? (uint8_t) ((heap.allocated_bytes * 100) / total) : 0;
+}
+
+// Only forwards a request to the LED engine when the LED's mode (or brightness) actually changes
+static void pipeline_status_apply(led_id led, status_led_mode_t mode, uint8_t dim_level) {
+    if (!status_leds_enabled || led >= NUM_LEDS) {
+        return;
+    }
+    if (status_led_modes[led] == mode && (mode != STATUS_LED_DIM || status_led_dim_levels[led] == dim_level)) {
+        return;
+    }
+
+    status_led_modes[led] = mode;
+    status_led_dim_levels[led] = dim_level;
+
+    switch (mode) {
+        case STATUS_LED_ON:
+            LED_set(led, LED_ON);
+            break;
+        case STATUS_LED_BLINK_SLOW:
+            LED_blink(led, LED_1HZ);
+            break;
+        case STATUS_LED_BLINK_FAST:
+            LED_blink(led, LED_8HZ);
+            break;
+        case STATUS_LED_DIM:
+            LED_pwm(led, dim_level);
+            break;
+        default:
+            LED_set(led, LED_OFF);
+            break;
+    }
+}
+
+static void pipeline_status_evaluate(struct k_work* work) {
+    APP_TRACE_BEGIN("pipeline_status", 0);
+
+    bool link_up = atomic_get(&pipeline_counters.link_up);
+    atomic_val_t rx_updates = atomic_get(&pipeline_counters.rx_updates);
+    atomic_val_t render_overruns = atomic_get(&pipeline_counters.render_overruns);
+
+    bool rx_activity = rx_updates != last_rx_updates;
+    bool overrun = render_overruns != last_render_overruns;
+    last_rx_updates = rx_updates;
+    last_render_overruns = render_overruns;
+
+    bool stale = false;
+    for (int group = 0; group < NUM_METRIC_GROUPS; group++) {
+        stale |= pipeline_status_metric_stale(group);
+    }
+
+    pipeline_status_apply(STATUS_LED_LINK, link_up ? STATUS_LED_ON : STATUS_LED_BLINK_SLOW, 0);
+    pipeline_status_apply(STATUS_LED_RX, rx_activity ? STATUS_LED_ON : STATUS_LED_OFF, 0);
+    pipeline_status_apply(STATUS_LED_STALE, stale ? STATUS_LED_BLINK_SLOW : STATUS_LED_OFF, 0);
+
+    if (overrun) {
+        pipeline_status_apply(STATUS_LED_LVGL, STATUS_LED_BLINK_FAST, 0);
+    } else {
+        uint8_t heap_used_percent = pipeline_status_heap_used_percent();
+        atomic_set(&pipeline_counters.heap_used_percent, heap_used_percent);
+        pipeline_status_apply(STATUS_LED_LVGL, STATUS_LED_DIM, heap_used_percent);
+    }
+
+    if (k_uptime_get_32() - ingest_report_start_ms >= PIPELINE_INGEST_REPORT_MS) {
+        pipeline_status_report_ingest();
+    }
+
+    k_work_schedule(&pipeline_status_work, K_MSEC(PIPELINE_STATUS_PERIOD_MS));
+
+    APP_TRACE_END("pipeline_status", 0);
+}
+
+// Prints accepted and refused writes per second and how long accepted metrics took to reach the screen, for measuring
+// ingest throughput against the client's rate sweep (gatt_client.py --sweep)
+static void pipeline_status_report_ingest() {
+    uint32_t now_ms = k_uptime_get_32();
+    uint32_t window_ms = now_ms - ingest_report_start_ms;
+    atomic_val_t rx_updates = atomic_get(&pipeline_counters.rx_updates);
+    atomic_val_t rx_rejected = atomic_get(&pipeline_counters.rx_rejected);
+    uint32_t accepted = rx_updates - ingest_report_rx_updates;
+    uint32_t rejected = rx_rejected - ingest_report_rx_rejected;
+
+    uint32_t latency_total_us = atomic_clear(&pipeline_counters.ingest_latency_total_us);
+    uint32_t latency_max_us = atomic_clear(&pipeline_counters.ingest_latency_max_us);
+    uint32_t latency_samples = atomic_clear(&pipeline_counters.ingest_latency_samples);
+
+    ingest_report_start_ms = now_ms;
+    ingest_report_rx_updates = rx_updates;
+    ingest_report_rx_rejected = rx_rejected;
+
+    if (accepted == 0 && rejected == 0) {
+        return; // Nothing arrived, keep the console quiet
+    }
+
+    LOG_INF("Ingest: %u writes/s accepted, %u rejected, %u updates shown, latency avg %u us, max %u us",
+        accepted * 1000 / window_ms, rejected, latency_samples,
+        latency_samples ? latency_total_us / latency_samples : 0, latency_max_us);
+}
@@ -0,0 +1,97 @@
+/**
+ * @file pipeline_status.h
+ */
+
+#ifndef PIPELINE_STATUS_H
+#define PIPELINE_STATUS_H
+
+/**
+ * Includes
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * Defines
+ */
+
+#define PIPELINE_STATUS_PERIOD_MS 100 // How often the LEDs are re-evaluated from the counters
+#define PIPELINE_STALE_MS 5000 // A metric group not written for this long while connected is stale (the client heartbeats every 2 s)
+#define PIPELINE_RENDER_BUDGET_MS 33 // A super loop iteration longer than this is a render overrun (below 30 FPS)
+#define PIPELINE_INGEST_REPORT_MS 5000 // How often ingest throughput and latency are printed while metrics are arriving
+
+/**
+ * Typedefs
+ */
+
+// The client only sends a group when it changed past its deadband or its heartbeat is due, so freshness is tracked per group
+typedef enum {
+    METRIC_GROUP_SCALAR = 0,
+    METRIC_GROUP_NETWORK,
+    METRIC_GROUP_PERCENT,
+    NUM_METRIC_GROUPS,
+} metric_group_t;
+
+// Counters written from the hot paths, every field is only ever touched with a single atomic operation
+typedef struct {
+    atomic_t link_up; // 1 while a GATT client is connected
+    atomic_t rx_updates; // Metric writes accepted by the GATT write callbacks
+    atomic_t rx_rejected; // Writes the GATT write callbacks refused (wrong length, malformed)
+    atomic_t rx_coalesced; // Writes that arrived while the UI still had an earlier one to draw, both are shown in one redraw
+    atomic_t frames; // Super loop iterations
+    atomic_t render_overruns; // Super loop iterations longer than PIPELINE_RENDER_BUDGET_MS
+    atomic_t heap_used_percent; // LVGL heap usage as of the last evaluation
+    atomic_t last_rx_ms[NUM_METRIC_GROUPS]; // Uptime of the last write to each metric group (32-bit, wraps after ~49 days)
+
+    // Ingest to display latency: cycle count of the oldest metric write not yet on screen (0 when there is none), and the
+    // latencies of the writes shown since the last ingest report
+    atomic_t ingest_start_cycles;
+    atomic_t ingest_latency_total_us;
+    atomic_t ingest_latency_max_us;
+    atomic_t ingest_latency_samples;
+} pipeline_counters_t;
+
+extern pipeline_counters_t pipeline_counters;
+
+/**
+ * Function prototypes
+ */
+
+// Starts the periodic evaluation behind the status LEDs, the ingest report and the heap usage. Without LEDs only the LED output
+// is skipped
+void pipeline_status_init(bool leds_available);
+
+void pipeline_status_frame_done(uint32_t frame_time_ms);
+
+bool pipeline_status_metric_stale(metric_group_t group);
+
+// Called by the UI once the metric writes pending since start_cycles have been rendered
+void pipeline_status_ingest_shown(uint32_t start_cycles);
+
+// Called for every accepted write, the metric groups are counted by the metric bus listener
+static inline void pipeline_status_count_rx() {
+    atomic_inc(&pipeline_counters.rx_updates);
+}
+
+// Called from the GATT write callbacks for every refused write
+static inline void pipeline_status_count_rx_rejected() {
+    atomic_inc(&pipeline_counters.rx_rejected);
+}
+
+// Called when a write finds a redraw already pending
+static inline void pipeline_status_count_coalesced() {
+    atomic_inc(&pipeline_counters.rx_coalesced);
+}
+
+// Called for every metric group published on the metric bus, a suppressed (unchanged) metric is still fresh as long as its heartbeat arrives
+static inline void pipeline_status_metric_received(metric_group_t group) {
+    atomic_set(&pipeline_counters.last_rx_ms[group], k_uptime_get_32());
+
+    // Only the first write since the screen last caught up starts the latency clock
+    atomic_cas(&pipeline_counters.ingest_start_cycles, 0, k_cycle_get_32() | 1);
+}
+
+#endif
@@ -0,0 +1,103 @@
+/**
+ * @file process_list.c
+ */
+
+#include <errno.h>
+#include <string.h>
+
+#include "process_list.h"
+
+/**
+ * Local variables
+ */
+
+// All names live in one static arena, a slot is a fixed-size null terminated string so nothing is ever allocated
+static char process_name_arena[PROCESS_NAME_SLOTS][PROCESS_NAME_MAX_LENGTH + 1];
+
+// The latest top list, as name ids
+static process_list_entry_t process_list_entries[PROCESS_LIST_TOP_N];
+static uint8_t process_list_count;
+
+// Protects the arena and the list, they are written from the BT RX thread and read from the UI
+static struct k_spinlock process_list_lock;
+
+atomic_t process_list_updates;
+
+/**
+ * Function definitions
+ */
+
+static int process_list_define_name(const uint8_t* msg, uint16_t len) {
+    // type, id, length, then the name
+    if (len < 3 || msg[1] >= PROCESS_NAME_SLOTS || msg[2] > PROCESS_NAME_MAX_LENGTH || len != 3 + msg[2]) {
+        return -EINVAL;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&process_list_lock);
+    memcpy(process_name_arena[msg[1]], &msg[3], msg[2]);
+    process_name_arena[msg[1]][msg[2]] = '\0';
+    k_spin_unlock(&process_list_lock, key);
+
+    return 0;
+}
+
+static int process_list_update(const uint8_t* msg, uint16_t len) {
+    // type, count, then count entries
+    uint8_t count = len >= 2 ? msg[1] : 0;
+    if (len < 2 || count > PROCESS_LIST_TOP_N || len != 2 + count * sizeof(process_list_entry_t)) {
+        return -EINVAL;
+    }
+
+    const process_list_entry_t* entries = (const process_list_entry_t*) &msg[2];
+    for (uint8_t i = 0; i < count; i++) {
+        if (entries[i].name_id >= PROCESS_NAME_SLOTS) {
+            return -EINVAL;
+        }
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&process_list_lock);
+    memcpy(process_list_entries, entries, count * sizeof(process_list_entry_t));
+    process_list_count = count;
+    k_spin_unlock(&process_list_lock, key);
+
+    atomic_inc(&process_list_updates);
+    return 0;
+}
+
+int process_list_handle_message(const uint8_t* msg, uint16_t len) {
+    if (len == 0) {
+        return -EINVAL;
+    }
+
+    switch (msg[0]) {
+        case PROCESS_MSG_DEFINE_NAME:
+            return process_list_define_name(msg, len);
+        case PROCESS_MSG_TOP_LIST:
+            return process_list_update(msg, len);
+        default:
+            return -EINVAL;
+    }
+}
+
+void process_list_reset() {
+    k_spinlock_key_t key = k_spin_lock(&process_list_lock);
+    memset(process_name_arena, 0, sizeof(process_name_arena));
+    process_list_count = 0;
+    k_spin_unlock(&process_list_lock, key);
+
+    atomic_inc(&process_list_updates);
+}
+
+void process_list_get(process_list_view_t* out) {
+    k_spinlock_key_t key = k_spin_lock(&process_list_lock);
+
+    out->count = process_list_count;
+    for (uint8_t i = 0; i < process_list_count; i++) {
+        const process_list_entry_t* entry = &process_list_entries[i];
+        memcpy(out->rows[i].name, process_name_arena[entry->name_id], sizeof(out->rows[i].name));
+        out->rows[i].cpu_percent = entry->cpu_percent;
+        out->rows[i].mem_percent = entry->mem_percent;
+    }
+
+    k_spin_unlock(&process_list_lock, key);
+}
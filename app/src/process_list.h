@@ -0,0 +1,70 @@
+/**
+ * @file process_list.h
+ */
+
+#ifndef PROCESS_LIST_H
+#define PROCESS_LIST_H
+
+/**
+ * Includes
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/atomic.h>
+
+/**
+ * Defines
+ */
+
+// Size of the process name table. The client mirrors this and decides which name to evict (its least recently used) when it
+// needs a new one, so names are addressed by slot and both sides always agree on what is cached
+#define PROCESS_NAME_SLOTS 32
+#define PROCESS_NAME_MAX_LENGTH 23 // Bytes of UTF-8, without the null terminator
+
+// Rows shown on the process list screen, the client never sends more
+#define PROCESS_LIST_TOP_N 8
+
+// Every write to the process list characteristic starts with one of these
+#define PROCESS_MSG_DEFINE_NAME 0x01 // uint8_t type, uint8_t id, uint8_t length, then the name (not null terminated)
+#define PROCESS_MSG_TOP_LIST 0x02 // uint8_t type, uint8_t count, then count process_list_entry_t
+
+/**
+ * Typedefs
+ */
+
+typedef struct __packed {
+    uint8_t name_id;
+    uint8_t cpu_percent; // Share of the whole machine, 0 to 100
+    uint8_t mem_percent;
+} process_list_entry_t;
+
+// One row of the list as shown on screen, the name resolved from the table
+typedef struct {
+    char name[PROCESS_NAME_MAX_LENGTH + 1];
+    uint8_t cpu_percent;
+    uint8_t mem_percent;
+} process_list_row_t;
+
+typedef struct {
+    uint8_t count;
+    process_list_row_t rows[PROCESS_LIST_TOP_N];
+} process_list_view_t;
+
+// Number of top lists received, a change means process_list_get has something new
+extern atomic_t process_list_updates;
+
+/**
+ * Function prototypes
+ */
+
+// Called from the BLE write callback with one message, returns 0 or a negative errno for a malformed message
+int process_list_handle_message(const uint8_t* msg, uint16_t len);
+
+// The name table only lives as long as the connection that filled it
+void process_list_reset();
+
+// Copies out the latest list with names resolved, safe to call from any thread
+void process_list_get(process_list_view_t* out);
+
+#endif
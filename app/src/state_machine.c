@@ -4,6 +4,8 @@
 
 #include "state_machine.h"
 
+LOG_MODULE_REGISTER(state_machine, CONFIG_APP_LOG_LEVEL);
+
 /**
  * Function prototypes
  * 
@@ -16,12 +18,27 @@ static enum smf_state_result main_menu_on_state_run(void* o);
 
 // Performance metrics page
 static void performance_metrics_on_state_entry(void* o);
+static void performance_metrics_show_group(metric_group_t group, bool fresh);
 static enum smf_state_result performance_metrics_on_state_run(void* o);
 
 // Computer details page
 static void computer_details_on_state_entry(void* o);
 static enum smf_state_result computer_details_on_state_run(void* o);
 
+// Per-core heatmap page
+static void heatmap_on_state_entry(void* o);
+static enum smf_state_result heatmap_on_state_run(void* o);
+
+// Top processes page
+static void processes_on_state_entry(void* o);
+static enum smf_state_result processes_on_state_run(void* o);
+
+static void ui_timer_handler();
+static void ui_metric_listener_cb(const struct zbus_channel* chan);
+#if defined(CONFIG_APP_TRACE)
+static void ui_trace_flush_cb(lv_event_t* event);
+#endif
+
 // Button press menu transition callback
 void lv_change_menu_cb(lv_event_t* event);
 
@@ -32,7 +49,9 @@ void lv_change_menu_cb(lv_event_t* event);
 enum ui_state_machine_states {
     MAIN_MENU,
     PERFORMANCE_METRICS,
-    COMPUTER_DETAILS
+    COMPUTER_DETAILS,
+    HEATMAP,
+    PROCESSES
 };
 
 // Object that Zephyr uses to keep track of current state (this is what is constantly ran inside the super loop)
@@ -48,14 +67,6 @@ typedef struct {
  * Local variables
  */
 
-// Flag indicating whether or not there is new data for LVGL to re-draw onto the LCD
-extern bool new_data;
-
-// Structs that contain metrics incoming from a GATT client
-extern cpu_gpu_scalar_metrics_t ble_cpu_gpu_scalar_metrics_characteristic_data;
-extern network_scalar_metrics_t ble_network_scalar_metrics_characteristic_data;
-extern cpu_gpu_ram_percentage_metrics_t ble_cpu_gpu_ram_percentage_metrics_characteristic_data;
-
 // Struct representing the menu "back" button
 static const struct gpio_dt_spec button = GPIO_DT_SPEC_GET(SW0_NODE, gpios);
 
@@ -70,13 +81,13 @@ typedef struct {
     // The only things that should be stored in this struct are labels/text that need to be constantly updated during runtime,
     // i.e. our performance metrics updated over bluetooth
 
-    // Scalar metrics (top container)
-    lv_obj_t* label_cpu_clock;
-    lv_obj_t* label_cpu_power;
-    lv_obj_t* label_cpu_temp;
-    lv_obj_t* label_gpu_temp;
-    lv_obj_t* label_net_upload;
-    lv_obj_t* label_net_download;
+    // Scalar metrics (top container), numeric readouts that only redraw the digits that change
+    lv_obj_t* readout_cpu_clock;
+    lv_obj_t* readout_cpu_power;
+    lv_obj_t* readout_cpu_temp;
+    lv_obj_t* readout_gpu_temp;
+    lv_obj_t* readout_net_upload;
+    lv_obj_t* readout_net_download;
     
     // Percentage-range metrics (bottom container)
     lv_obj_t* bar_cpu_usage;
@@ -85,6 +96,16 @@ typedef struct {
     lv_obj_t* gpu_usage_title;
     lv_obj_t* bar_ram_usage;
     lv_obj_t* ram_usage_title;
+
+    // Whether each metric group is currently showing values (true) or dashes (false), see performance_metrics_show_group
+    bool group_shown[NUM_METRIC_GROUPS];
+
+    // Ingest clock of the writes handed to the widgets on the previous iteration, they are on screen once LVGL has run
+    uint32_t ingest_pending_cycles;
+
+    // Copy of the metrics taken on the last refresh, the widgets are only ever fed from this so one refresh never mixes
+    // values from two different writes
+    ble_metrics_snapshot_t metrics;
 } perf_metrics_ui_t;
 
 typedef struct {
@@ -93,16 +114,43 @@ typedef struct {
     lv_obj_t* label_gpu_details;
 } computer_details_ui_t;
 
+typedef struct {
+    lv_obj_t* title;
+    lv_obj_t* heatmap; // Draws every core itself, one object no matter how many cores
+
+    atomic_val_t frames_shown; // Value of ble_per_core_frames when the heatmap was last updated
+    per_core_metrics_t frame; // Copy of the latest frame, so the BLE side can keep receiving while we draw
+} heatmap_ui_t;
+
+// One line of the top processes page, created once on entry and reused for whatever process lands in that position
+typedef struct {
+    lv_obj_t* row;
+    lv_obj_t* label_name;
+    lv_obj_t* readout_cpu;
+    lv_obj_t* readout_mem;
+    char name_shown[PROCESS_NAME_MAX_LENGTH + 1]; // Only relabel when the process in this position changes
+} process_row_ui_t;
+
+typedef struct {
+    process_row_ui_t rows[PROCESS_LIST_TOP_N];
+    atomic_val_t updates_shown; // Value of process_list_updates when the rows were last updated
+    process_list_view_t view; // Copy of the latest list, names already resolved from the name table
+} processes_ui_t;
+
 
 // Static struct that ACTUALLY holds our performance metrics data that we're updated during runtime
 static perf_metrics_ui_t perf_metrics_ui;
 static computer_details_ui_t computer_details_ui;
+static heatmap_ui_t heatmap_ui;
+static processes_ui_t processes_ui;
 
 // Struct that holds the actual states that Zephyr will traverse throughout runtime
 static const struct smf_state ui_states[] = {
     [MAIN_MENU] = SMF_CREATE_STATE(main_menu_on_state_entry, main_menu_on_state_run, NULL, NULL, NULL),
     [PERFORMANCE_METRICS] = SMF_CREATE_STATE(performance_metrics_on_state_entry, performance_metrics_on_state_run, NULL, NULL, NULL),
-    [COMPUTER_DETAILS] = SMF_CREATE_STATE(computer_details_on_state_entry, computer_details_on_state_run, NULL, NULL, NULL)
+    [COMPUTER_DETAILS] = SMF_CREATE_STATE(computer_details_on_state_entry, computer_details_on_state_run, NULL, NULL, NULL),
+    [HEATMAP] = SMF_CREATE_STATE(heatmap_on_state_entry, heatmap_on_state_run, NULL, NULL, NULL),
+    [PROCESSES] = SMF_CREATE_STATE(processes_on_state_entry, processes_on_state_run, NULL, NULL, NULL)
 };
 
 // Indicates the next state to transition to
@@ -111,17 +159,63 @@ static enum ui_state_machine_states next_state = -1; // -1 indicates no state ch
 // Objects that hold the enum value of states that can be transitioned to for button callback pointers
 static enum ui_state_machine_states perf_metrics_state = PERFORMANCE_METRICS;
 static enum ui_state_machine_states computer_details_state = COMPUTER_DETAILS;
+static enum ui_state_machine_states heatmap_state = HEATMAP;
+static enum ui_state_machine_states processes_state = PROCESSES;
 
 void state_machine_init() {
+#if defined(CONFIG_APP_TRACE)
+    // LVGL calls the display driver's flush itself, so the flush is traced from the display's events
+    lv_display_t* display = lv_display_get_default();
+    lv_display_add_event_cb(display, ui_trace_flush_cb, LV_EVENT_FLUSH_START, NULL);
+    lv_display_add_event_cb(display, ui_trace_flush_cb, LV_EVENT_FLUSH_FINISH, NULL);
+#endif
+
     // Set initial state to be the main menu
     smf_set_initial(SMF_CTX(&ui_state_object), &ui_states[MAIN_MENU]);
 }
 
 int state_machine_run() {
     // When we run the state machine, we just want to return the state currently held in the ui_state_object
-    return smf_run_state(SMF_CTX(&ui_state_object));
+    APP_TRACE_BEGIN("smf_run", 0);
+    const struct smf_state* previous = SMF_CTX(&ui_state_object)->current;
+    int ret = smf_run_state(SMF_CTX(&ui_state_object));
+    APP_TRACE_END("smf_run", ret);
+
+#if defined(CONFIG_APP_ACTIVITY)
+    // Changing screens counts as activity, whatever input caused it
+    if (SMF_CTX(&ui_state_object)->current != previous) {
+        activity_report();
+    }
+#endif
+    return ret;
 }
 
+// The UI only needs to know that something changed, the values are read when it redraws. A listener, so setting the flag costs
+// the publisher next to nothing and no thread is woken for it
+ZBUS_LISTENER_DEFINE(state_machine_metric_listener, ui_metric_listener_cb);
+
+static void ui_metric_listener_cb(const struct zbus_channel* chan) {
+    ble_metrics_signal_new_data();
+}
+
+// Every state runs LVGL through here, so its timers, redraws and flushes show up as one span per iteration
+static void ui_timer_handler() {
+    APP_TRACE_BEGIN("lv_timer", 0);
+    lv_timer_handler();
+    APP_TRACE_END("lv_timer", 0);
+}
+
+#if defined(CONFIG_APP_TRACE)
+static void ui_trace_flush_cb(lv_event_t* event) {
+    if (lv_event_get_code(event) == LV_EVENT_FLUSH_START) {
+        const lv_area_t* area = lv_event_get_param(event);
+        APP_TRACE_BEGIN("lv_flush", lv_area_get_size(area));
+    } else {
+        APP_TRACE_END("lv_flush", 0);
+    }
+}
+#endif
+
 // Definition of button press menu transition callback
 void lv_change_menu_cb(lv_event_t* event) {
     // Retrieve the next state data from the associated button
@@ -137,6 +231,8 @@ void lv_change_menu_cb(lv_event_t* event) {
  */
 
 static void main_menu_on_state_entry(void* o) {
+    APP_TRACE_BEGIN("smf_entry", MAIN_MENU);
+
     // Clear any existing screen contents to display the new menu
     lv_obj_clean(screen);
 
@@ -185,10 +281,34 @@ static void main_menu_on_state_entry(void* o) {
 
     // When the Computer Details button is clicked, we want to transition to that state/menu
     lv_obj_add_event_cb(computer_details_button, lv_change_menu_cb, LV_EVENT_CLICKED, details_state);
+
+    // Create the CPU Cores (heatmap) button and associate the state
+    lv_obj_t* heatmap_button = lv_button_create(button_container);
+    lv_obj_t* heatmap_text = lv_label_create(heatmap_button); // add the button text
+    lv_label_set_text(heatmap_text, "CPU Cores");
+
+    // Data to send to the menu change callback when the button is clicked
+    lv_obj_t* cores_state = lv_data_obj_create_alloc_assign(heatmap_button, &heatmap_state, sizeof(HEATMAP));
+
+    // When the CPU Cores button is clicked, we want to transition to that state/menu
+    lv_obj_add_event_cb(heatmap_button, lv_change_menu_cb, LV_EVENT_CLICKED, cores_state);
+
+    // Create the Top Processes button and associate the state
+    lv_obj_t* processes_button = lv_button_create(button_container);
+    lv_obj_t* processes_text = lv_label_create(processes_button); // add the button text
+    lv_label_set_text(processes_text, "Top Processes");
+
+    // Data to send to the menu change callback when the button is clicked
+    lv_obj_t* top_state = lv_data_obj_create_alloc_assign(processes_button, &processes_state, sizeof(PROCESSES));
+
+    // When the Top Processes button is clicked, we want to transition to that state/menu
+    lv_obj_add_event_cb(processes_button, lv_change_menu_cb, LV_EVENT_CLICKED, top_state);
+
+    APP_TRACE_END("smf_entry", MAIN_MENU);
 }
 
 static enum smf_state_result main_menu_on_state_run(void* o) {
-    lv_timer_handler();
+    ui_timer_handler();
     
     if (next_state == PERFORMANCE_METRICS) {
         next_state = -1; // Clear the next state flag since we're now handling the transition
@@ -198,6 +318,14 @@ static enum smf_state_result main_menu_on_state_run(void* o) {
         next_state = -1; // Clear the next state flag since we're now handling the transition
         smf_set_state(SMF_CTX(&ui_state_object), &ui_states[COMPUTER_DETAILS]);
     }
+    else if (next_state == HEATMAP) {
+        next_state = -1; // Clear the next state flag since we're now handling the transition
+        smf_set_state(SMF_CTX(&ui_state_object), &ui_states[HEATMAP]);
+    }
+    else if (next_state == PROCESSES) {
+        next_state = -1; // Clear the next state flag since we're now handling the transition
+        smf_set_state(SMF_CTX(&ui_state_object), &ui_states[PROCESSES]);
+    }
 
     return SMF_EVENT_HANDLED;
 }
@@ -206,6 +334,8 @@ static enum smf_state_result main_menu_on_state_run(void* o) {
  * Performance metrics states
  */
 static void performance_metrics_on_state_entry(void* o) {
+    APP_TRACE_BEGIN("smf_entry", PERFORMANCE_METRICS);
+
     // Clear any existing screen contents to display the new menu
     lv_obj_clean(screen);
 
@@ -236,25 +366,26 @@ static void performance_metrics_on_state_entry(void* o) {
     // Anchor this to the TOP of the screen so it actually appears on top
     lv_obj_align(perf_top_container, LV_ALIGN_TOP_MID, 0, 0);
 
-    // Create labels, add to our static metrics struct so that we can update them with new data (via bluetooth) later.
-    // These labels should be children of the container so they are contained within them.
-    perf_metrics_ui.label_cpu_clock = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_cpu_clock, "CPU Clock: -- MHz"); 
+    // Create numeric readouts, add to our static metrics struct so that we can update them with new data (via bluetooth) later.
+    // These readouts should be children of the container so they are contained within them.
+    // The prefix and unit are drawn once; only digits that change are redrawn on each update (shown as dashes until data arrives)
+    perf_metrics_ui.readout_cpu_clock = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_cpu_clock, "CPU Clock: ", CPU_CLOCK_DIGITS, " MHz");
 
-    perf_metrics_ui.label_cpu_power = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_cpu_power, "CPU Power: -- W");
+    perf_metrics_ui.readout_cpu_power = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_cpu_power, "CPU Power: ", POWER_DIGITS, " W");
 
-    perf_metrics_ui.label_cpu_temp = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_cpu_temp, "CPU Temp: --°C");
+    perf_metrics_ui.readout_cpu_temp = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_cpu_temp, "CPU Temp: ", TEMP_DIGITS, "°C");
     
-    perf_metrics_ui.label_gpu_temp = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_gpu_temp, "GPU Temp: --°C");
+    perf_metrics_ui.readout_gpu_temp = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_gpu_temp, "GPU Temp: ", TEMP_DIGITS, "°C");
 
-    perf_metrics_ui.label_net_download = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_net_download, "Net Down: -- Kb/s");
+    perf_metrics_ui.readout_net_download = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_net_download, "Net Down: ", NETWORK_DIGITS, " Kb/s");
 
-    perf_metrics_ui.label_net_upload = lv_label_create(perf_top_container);
-    lv_label_set_text(perf_metrics_ui.label_net_upload, "Net Up: -- Kb/s");
+    perf_metrics_ui.readout_net_upload = lv_numeric_obj_create(perf_top_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.readout_net_upload, "Net Up: ", NETWORK_DIGITS, " Kb/s");
 
     /**
      * Bottom container initialization (percentage-based metrics)
@@ -269,90 +400,136 @@ static void performance_metrics_on_state_entry(void* o) {
     // Anchor this to the BOTTOM of the screen so it actually appears on the bottom
     lv_obj_align(perf_bottom_container, LV_ALIGN_BOTTOM_MID, 0, 0);
 
-    perf_metrics_ui.cpu_usage_title = lv_label_create(perf_bottom_container);
-    lv_label_set_text(perf_metrics_ui.cpu_usage_title, "CPU Usage: --%");
+    perf_metrics_ui.cpu_usage_title = lv_numeric_obj_create(perf_bottom_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.cpu_usage_title, "CPU Usage: ", PERCENT_DIGITS, "%");
 
     // Dynamic CPU usage percentage bar (store in static struct for future updates)
     perf_metrics_ui.bar_cpu_usage = lv_bar_create(perf_bottom_container);
     lv_obj_set_size(perf_metrics_ui.bar_cpu_usage, lv_pct(90), 20);
     lv_bar_set_range(perf_metrics_ui.bar_cpu_usage, 0, 100);
 
-    perf_metrics_ui.gpu_usage_title = lv_label_create(perf_bottom_container);
-    lv_label_set_text(perf_metrics_ui.gpu_usage_title, "GPU Usage: --%");
+    perf_metrics_ui.gpu_usage_title = lv_numeric_obj_create(perf_bottom_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.gpu_usage_title, "GPU Usage: ", PERCENT_DIGITS, "%");
 
     // Dynamic GPU usage percentage bar (store in static struct for future updates)
     perf_metrics_ui.bar_gpu_usage = lv_bar_create(perf_bottom_container);
     lv_obj_set_size(perf_metrics_ui.bar_gpu_usage, lv_pct(90), 20);
     lv_bar_set_range(perf_metrics_ui.bar_gpu_usage, 0, 100);
 
-    perf_metrics_ui.ram_usage_title = lv_label_create(perf_bottom_container);
-    lv_label_set_text(perf_metrics_ui.ram_usage_title, "RAM Usage: --%");         
+    perf_metrics_ui.ram_usage_title = lv_numeric_obj_create(perf_bottom_container);
+    lv_numeric_obj_set_format(perf_metrics_ui.ram_usage_title, "RAM Usage: ", PERCENT_DIGITS, "%");
 
     // Dynamic RAM usage percentage bar (store in static struct for future updates)
     perf_metrics_ui.bar_ram_usage = lv_bar_create(perf_bottom_container);
     lv_obj_set_size(perf_metrics_ui.bar_ram_usage, lv_pct(90), 20);
     lv_bar_set_range(perf_metrics_ui.bar_ram_usage, 0, 100);
 
+    // Writes that arrived while another page was shown never waited on this one, don't count them as ingest latency
+    atomic_clear(&pipeline_counters.ingest_start_cycles);
+    perf_metrics_ui.ingest_pending_cycles = 0;
+
+    // Populate the new readouts from the latest received metrics right away, rather than waiting for the next write
+    atomic_set(&new_data, 1);
+
+    APP_TRACE_END("smf_entry", PERFORMANCE_METRICS);
 }
 
 static enum smf_state_result performance_metrics_on_state_run(void* o) {
-    lv_timer_handler();
+    ui_timer_handler();
+
+    // The widgets updated on the previous iteration have now been rendered
+    if (perf_metrics_ui.ingest_pending_cycles) {
+        pipeline_status_ingest_shown(perf_metrics_ui.ingest_pending_cycles);
+        perf_metrics_ui.ingest_pending_cycles = 0;
+    }
     
     if (gpio_pin_get_dt(&button)) {
         // Go back to the main menu
         smf_set_state(SMF_CTX(&ui_state_object), &ui_states[MAIN_MENU]);
     }
-    else if (new_data) {
+    else {
         // Acknowledge incoming hardware metrics ONLY IF NEW DATA IS AVAILABLE
-        new_data = false;
-
-        // Process incoming scalar metrics
-        char cpu_clock_text[METRIC_MAX_LENGTH];
-        char cpu_power_text[METRIC_MAX_LENGTH];
-        char cpu_temp_text[METRIC_MAX_LENGTH];
-        char gpu_temp_text[METRIC_MAX_LENGTH];
-        char network_down_text[METRIC_MAX_LENGTH];
-        char network_up_text[METRIC_MAX_LENGTH];
-
-        snprintf(cpu_clock_text, sizeof(cpu_clock_text), "CPU Clock: %u MHz", ble_cpu_gpu_scalar_metrics_characteristic_data.cpu_clock_mhz);
-        snprintf(cpu_power_text, sizeof(cpu_power_text), "CPU Power: %u W", ble_cpu_gpu_scalar_metrics_characteristic_data.cpu_power_watts);
-        snprintf(cpu_temp_text, sizeof(cpu_temp_text), "CPU Temp: %u°C", ble_cpu_gpu_scalar_metrics_characteristic_data.cpu_temp_celsius);
-        snprintf(gpu_temp_text, sizeof(gpu_temp_text), "GPU Temp: %u°C", ble_cpu_gpu_scalar_metrics_characteristic_data.gpu_temp_celsius);
-        snprintf(network_down_text, sizeof(network_down_text), "Net Down: %u Kb/s", ble_network_scalar_metrics_characteristic_data.network_down_bits);
-        snprintf(network_up_text, sizeof(network_up_text), "Net Up: %u Kb/s", ble_network_scalar_metrics_characteristic_data.network_up_bits);
-
-        lv_label_set_text(perf_metrics_ui.label_cpu_clock, cpu_clock_text); 
-        lv_label_set_text(perf_metrics_ui.label_cpu_power, cpu_power_text);
-        lv_label_set_text(perf_metrics_ui.label_cpu_temp, cpu_temp_text);
-        lv_label_set_text(perf_metrics_ui.label_gpu_temp, gpu_temp_text);
-        lv_label_set_text(perf_metrics_ui.label_net_download, network_down_text);
-        lv_label_set_text(perf_metrics_ui.label_net_upload, network_up_text);
-
-        // Process percentage metrics
-        char cpu_usage_text[METRIC_MAX_LENGTH];
-        char gpu_usage_text[METRIC_MAX_LENGTH];
-        char ram_usage_text[METRIC_MAX_LENGTH];
-
-        snprintf(cpu_usage_text, sizeof(cpu_usage_text), "CPU Usage: %u%%", ble_cpu_gpu_ram_percentage_metrics_characteristic_data.cpu_usage_percent);
-        snprintf(gpu_usage_text, sizeof(gpu_usage_text), "GPU Usage: %u%%", ble_cpu_gpu_ram_percentage_metrics_characteristic_data.gpu_usage_percent);
-        snprintf(ram_usage_text, sizeof(ram_usage_text), "RAM Usage: %u%%", ble_cpu_gpu_ram_percentage_metrics_characteristic_data.ram_usage_percent);
-
-        lv_label_set_text(perf_metrics_ui.cpu_usage_title, cpu_usage_text);
-        lv_label_set_text(perf_metrics_ui.gpu_usage_title, gpu_usage_text);
-        lv_label_set_text(perf_metrics_ui.ram_usage_title, ram_usage_text);
-
-        lv_bar_set_value(perf_metrics_ui.bar_cpu_usage, ble_cpu_gpu_ram_percentage_metrics_characteristic_data.cpu_usage_percent, LV_ANIM_ON);
-        lv_bar_set_value(perf_metrics_ui.bar_gpu_usage, ble_cpu_gpu_ram_percentage_metrics_characteristic_data.gpu_usage_percent, LV_ANIM_ON);
-        lv_bar_set_value(perf_metrics_ui.bar_ram_usage, ble_cpu_gpu_ram_percentage_metrics_characteristic_data.ram_usage_percent, LV_ANIM_ON);
+        bool refresh = atomic_clear(&new_data);
+        if (refresh) {
+            perf_metrics_ui.ingest_pending_cycles = atomic_clear(&pipeline_counters.ingest_start_cycles);
+            metric_bus_get(&perf_metrics_ui.metrics);
+        }
+
+        // The client suppresses unchanged metrics, so a quiet group is only blanked once its heartbeat stops arriving too
+        bool link_up = atomic_get(&pipeline_counters.link_up);
+        for (int group = 0; group < NUM_METRIC_GROUPS; group++) {
+            bool fresh = link_up && !pipeline_status_metric_stale(group);
+            if (refresh || fresh != perf_metrics_ui.group_shown[group]) {
+                performance_metrics_show_group(group, fresh);
+            }
+        }
     }
 
     return SMF_EVENT_HANDLED;
 }
 
+// Shows the latest values of one metric group, or dashes when the group is stale
+static void performance_metrics_show_group(metric_group_t group, bool fresh) {
+    perf_metrics_ui.group_shown[group] = fresh;
+
+    switch (group) {
+        case METRIC_GROUP_SCALAR:
+            if (!fresh) {
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_cpu_clock);
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_cpu_power);
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_cpu_temp);
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_gpu_temp);
+                break;
+            }
+
+            // Process incoming scalar metrics, each readout only invalidates the digits that actually changed
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_cpu_clock, perf_metrics_ui.metrics.scalar.cpu_clock_mhz);
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_cpu_power, perf_metrics_ui.metrics.scalar.cpu_power_watts);
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_cpu_temp, perf_metrics_ui.metrics.scalar.cpu_temp_celsius);
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_gpu_temp, perf_metrics_ui.metrics.scalar.gpu_temp_celsius);
+            break;
+
+        case METRIC_GROUP_NETWORK:
+            if (!fresh) {
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_net_download);
+                lv_numeric_obj_clear_value(perf_metrics_ui.readout_net_upload);
+                break;
+            }
+
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_net_download, perf_metrics_ui.metrics.network.network_down_bits);
+            lv_numeric_obj_set_value(perf_metrics_ui.readout_net_upload, perf_metrics_ui.metrics.network.network_up_bits);
+            break;
+
+        case METRIC_GROUP_PERCENT:
+            if (!fresh) {
+                // Bars keep their last position, the dashed titles already say the value is not current
+                lv_numeric_obj_clear_value(perf_metrics_ui.cpu_usage_title);
+                lv_numeric_obj_clear_value(perf_metrics_ui.gpu_usage_title);
+                lv_numeric_obj_clear_value(perf_metrics_ui.ram_usage_title);
+                break;
+            }
+
+            // Process percentage metrics
+            lv_numeric_obj_set_value(perf_metrics_ui.cpu_usage_title, perf_metrics_ui.metrics.percent.cpu_usage_percent);
+            lv_numeric_obj_set_value(perf_metrics_ui.gpu_usage_title, perf_metrics_ui.metrics.percent.gpu_usage_percent);
+            lv_numeric_obj_set_value(perf_metrics_ui.ram_usage_title, perf_metrics_ui.metrics.percent.ram_usage_percent);
+
+            lv_bar_set_value(perf_metrics_ui.bar_cpu_usage, perf_metrics_ui.metrics.percent.cpu_usage_percent, LV_ANIM_ON);
+            lv_bar_set_value(perf_metrics_ui.bar_gpu_usage, perf_metrics_ui.metrics.percent.gpu_usage_percent, LV_ANIM_ON);
+            lv_bar_set_value(perf_metrics_ui.bar_ram_usage, perf_metrics_ui.metrics.percent.ram_usage_percent, LV_ANIM_ON);
+            break;
+
+        default:
+            break;
+    }
+}
+
 /**
  * Computer details states
  */
 static void computer_details_on_state_entry(void* o) {
+    APP_TRACE_BEGIN("smf_entry", COMPUTER_DETAILS);
+
     // Clear any existing screen contents to display the new menu
     lv_obj_clean(screen);
 
@@ -385,25 +562,29 @@ static void computer_details_on_state_entry(void* o) {
 
     computer_details_ui.label_gpu_details = lv_label_create(details_container);
     lv_label_set_text(computer_details_ui.label_gpu_details, "GPU: --");
+
+    APP_TRACE_END("smf_entry", COMPUTER_DETAILS);
 }
 
 static enum smf_state_result computer_details_on_state_run(void* o) {
-    lv_timer_handler();
+    ui_timer_handler();
     
     if (gpio_pin_get_dt(&button)) {
         // Go back to the main menu
         smf_set_state(SMF_CTX(&ui_state_object), &ui_states[MAIN_MENU]);
     }
-    else if (new_data) {
-        new_data = false; // acknowledge that we are processing data
+    else if (atomic_clear(&new_data)) { // acknowledge that we are processing data
+        // Static, three detail strings are too much for the main stack on top of the formatted text
+        static ble_details_snapshot_t details;
+        ble_details_get(&details);
 
         char system_details_text[METRIC_MAX_LENGTH];
         char cpu_details_text[METRIC_MAX_LENGTH];
         char gpu_details_text[METRIC_MAX_LENGTH];
 
-        snprintf(system_details_text, sizeof(system_details_text), "System: %s", ble_system_details);
-        snprintf(cpu_details_text, sizeof(cpu_details_text), "CPU: %s", ble_cpu_details);
-        snprintf(gpu_details_text, sizeof(gpu_details_text), "GPU: %s", ble_gpu_details);
+        snprintf(system_details_text, sizeof(system_details_text), "System: %s", details.system);
+        snprintf(cpu_details_text, sizeof(cpu_details_text), "CPU: %s", details.cpu);
+        snprintf(gpu_details_text, sizeof(gpu_details_text), "GPU: %s", details.gpu);
 
         lv_label_set_text(computer_details_ui.label_system_details, system_details_text);
         lv_label_set_text(computer_details_ui.label_cpu_details, cpu_details_text);
@@ -411,4 +592,311 @@ static enum smf_state_result computer_details_on_state_run(void* o) {
     }
 
     return SMF_EVENT_HANDLED;
-}
\ No newline at end of file
+}
+
+/**
+ * Per-core heatmap states
+ */
+static void heatmap_on_state_entry(void* o) {
+    APP_TRACE_BEGIN("smf_entry", HEATMAP);
+
+    // Clear any existing screen contents to display the new menu
+    lv_obj_clean(screen);
+
+    lv_obj_t* heatmap_container = lv_obj_create(screen);
+    lv_obj_set_size(heatmap_container, lv_pct(100), lv_pct(100));
+    lv_obj_set_flex_flow(heatmap_container, LV_FLEX_FLOW_COLUMN); // Title on top, heatmap filling the rest
+    lv_obj_set_flex_align(heatmap_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    heatmap_ui.title = lv_label_create(heatmap_container);
+    lv_label_set_text(heatmap_ui.title, "CPU Cores: --");
+
+    // A single object draws every core in one pass, 128 cores cost 128 rectangles rather than 128 LVGL objects
+    heatmap_ui.heatmap = lv_heatmap_obj_create(heatmap_container);
+    lv_obj_set_width(heatmap_ui.heatmap, lv_pct(100));
+    lv_obj_set_flex_grow(heatmap_ui.heatmap, 1);
+
+    // Show the latest frame right away rather than waiting for the next one
+    heatmap_ui.frames_shown = atomic_get(&ble_per_core_frames) - 1;
+
+    APP_TRACE_END("smf_entry", HEATMAP);
+}
+
+static enum smf_state_result heatmap_on_state_run(void* o) {
+    atomic_val_t frames = atomic_get(&ble_per_core_frames);
+
+    // Only copy out and hand the heatmap a frame when a new one has been completed
+    if (frames != heatmap_ui.frames_shown) {
+        heatmap_ui.frames_shown = frames;
+        ble_per_core_metrics_get(&heatmap_ui.frame);
+
+        if (heatmap_ui.frame.core_count > 0) {
+            lv_label_set_text_fmt(heatmap_ui.title, "CPU Cores: %u", heatmap_ui.frame.core_count);
+            lv_heatmap_obj_set_cells(heatmap_ui.heatmap, heatmap_ui.frame.usage_percent, heatmap_ui.frame.clock_mhz,
+                heatmap_ui.frame.core_count);
+        }
+    }
+
+    ui_timer_handler();
+
+    if (gpio_pin_get_dt(&button)) {
+        // Go back to the main menu
+        smf_set_state(SMF_CTX(&ui_state_object), &ui_states[MAIN_MENU]);
+    }
+
+    return SMF_EVENT_HANDLED;
+}
+
+/**
+ * Top processes states
+ */
+static void processes_on_state_entry(void* o) {
+    APP_TRACE_BEGIN("smf_entry", PROCESSES);
+
+    // Clear any existing screen contents to display the new menu
+    lv_obj_clean(screen);
+
+    lv_obj_t* processes_container = lv_obj_create(screen);
+    lv_obj_set_size(processes_container, lv_pct(100), lv_pct(100));
+    lv_obj_set_flex_flow(processes_container, LV_FLEX_FLOW_COLUMN); // One process per line, top-to-bottom
+    lv_obj_set_flex_align(processes_container, LV_FLEX_ALIGN_START, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+    lv_obj_t* title = lv_label_create(processes_container);
+    lv_label_set_text(title, "Top Processes");
+
+    // Every row exists for the whole time the page is shown, an update only changes text and digits, never the object tree
+    for (uint8_t i = 0; i < PROCESS_LIST_TOP_N; i++) {
+        process_row_ui_t* row = &processes_ui.rows[i];
+
+        row->row = lv_obj_create(processes_container);
+        lv_obj_set_size(row->row, lv_pct(100), LV_SIZE_CONTENT);
+        lv_obj_set_flex_flow(row->row, LV_FLEX_FLOW_ROW); // Name on the left, usage on the right
+        lv_obj_set_flex_align(row->row, LV_FLEX_ALIGN_SPACE_BETWEEN, LV_FLEX_ALIGN_CENTER, LV_FLEX_ALIGN_CENTER);
+
+        row->label_name = lv_label_create(row->row);
+        lv_label_set_long_mode(row->label_name, LV_LABEL_LONG_DOT); // Cut long names off rather than wrapping the row
+        lv_obj_set_flex_grow(row->label_name, 1);
+
+        row->readout_cpu = lv_numeric_obj_create(row->row);
+        lv_numeric_obj_set_format(row->readout_cpu, "CPU ", PERCENT_DIGITS, "%");
+
+        row->readout_mem = lv_numeric_obj_create(row->row);
+        lv_numeric_obj_set_format(row->readout_mem, " MEM ", PERCENT_DIGITS, "%");
+
+        // Rows stay hidden until a process is sent for them
+        row->name_shown[0] = '\0';
+        lv_obj_add_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+    }
+
+    // Show the latest list right away rather than waiting for the next one
+    processes_ui.updates_shown = atomic_get(&process_list_updates) - 1;
+
+    APP_TRACE_END("smf_entry", PROCESSES);
+}
+
+static enum smf_state_result processes_on_state_run(void* o) {
+    atomic_val_t updates = atomic_get(&process_list_updates);
+
+    if (updates != processes_ui.updates_shown) {
+        processes_ui.updates_shown = updates;
+        process_list_get(&processes_ui.view);
+
+        for (uint8_t i = 0; i < PROCESS_LIST_TOP_N; i++) {
+            process_row_ui_t* row = &processes_ui.rows[i];
+
+            if (i >= processes_ui.view.count) {
+                lv_obj_add_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+                row->name_shown[0] = '\0';
+                continue;
+            }
+
+            const process_list_row_t* process = &processes_ui.view.rows[i];
+
+            // Relabelling means a relayout, skip it while the same process holds this position
+            if (strcmp(row->name_shown, process->name) != 0) {
+                strcpy(row->name_shown, process->name);
+                lv_label_set_text(row->label_name, row->name_shown);
+            }
+
+            lv_numeric_obj_set_value(row->readout_cpu, process->cpu_percent);
+            lv_numeric_obj_set_value(row->readout_mem, process->mem_percent);
+            lv_obj_remove_flag(row->row, LV_OBJ_FLAG_HIDDEN);
+        }
+    }
+
+    ui_timer_handler();
+
+    if (gpio_pin_get_dt(&button)) {
+        // Go back to the main menu
+        smf_set_state(SMF_CTX(&ui_state_object), &ui_states[MAIN_MENU]);
+    }
+
+    return SMF_EVENT_HANDLED;
+}
+
+/**
+ * UI benchmark
+ */
+#if defined(CONFIG_APP_UI_BENCHMARK)
+
+typedef struct {
+    uint32_t runs;
+    uint32_t total_cycles;
+    uint32_t max_cycles;
+    uint32_t total_px;
+} ui_benchmark_result_t;
+
+// Pixels invalidated since the last reset, summed over every invalidated area (overlapping areas count twice)
+static uint32_t ui_benchmark_invalidated_px;
+
+// Fixed seed, so every run (and every build being compared) renders the same sequence of updates
+static uint32_t ui_benchmark_seed = 0x2545f491;
+
+// Static, too large for the main stack
+static per_core_metrics_t ui_benchmark_per_core;
+
+static uint32_t ui_benchmark_random(uint32_t range) {
+    // xorshift32
+    ui_benchmark_seed ^= ui_benchmark_seed << 13;
+    ui_benchmark_seed ^= ui_benchmark_seed >> 17;
+    ui_benchmark_seed ^= ui_benchmark_seed << 5;
+    return ui_benchmark_seed % range;
+}
+
+static void ui_benchmark_invalidate_cb(lv_event_t* event) {
+    const lv_area_t* area = lv_event_get_param(event);
+    ui_benchmark_invalidated_px += lv_area_get_size(area);
+}
+
+static uint32_t ui_benchmark_count_objects(lv_obj_t* obj) {
+    uint32_t count = 1;
+    for (uint32_t i = 0; i < lv_obj_get_child_count(obj); i++) {
+        count += ui_benchmark_count_objects(lv_obj_get_child(obj, i));
+    }
+    return count;
+}
+
+// Fills every source the screens read from with new values, as if a full update of everything had just arrived from a
+// host with core_count cores
+static void ui_benchmark_randomize_metrics(uint8_t core_count) {
+    // Published like real writes, so every observer of the bus sees them too
+    const cpu_gpu_scalar_metrics_t scalar = {
+        .cpu_clock_mhz = 800 + ui_benchmark_random(5000),
+        .cpu_power_watts = ui_benchmark_random(300),
+        .cpu_temp_celsius = 20 + ui_benchmark_random(80),
+        .gpu_temp_celsius = 20 + ui_benchmark_random(80),
+    };
+    const network_scalar_metrics_t network = {
+        .network_down_bits = ui_benchmark_random(1000000),
+        .network_up_bits = ui_benchmark_random(1000000),
+    };
+    const cpu_gpu_ram_percentage_metrics_t percent = {
+        .cpu_usage_percent = ui_benchmark_random(101),
+        .gpu_usage_percent = ui_benchmark_random(101),
+        .ram_usage_percent = ui_benchmark_random(101),
+    };
+    metric_bus_publish(METRIC_GROUP_SCALAR, &scalar);
+    metric_bus_publish(METRIC_GROUP_NETWORK, &network);
+    metric_bus_publish(METRIC_GROUP_PERCENT, &percent);
+
+    ui_benchmark_per_core.core_count = core_count;
+    for (uint8_t i = 0; i < ui_benchmark_per_core.core_count; i++) {
+        ui_benchmark_per_core.usage_percent[i] = ui_benchmark_random(101);
+        ui_benchmark_per_core.clock_mhz[i] = 800 + ui_benchmark_random(5000);
+    }
+    ble_per_core_metrics_publish(&ui_benchmark_per_core);
+
+    // The names were defined once up front, only the order and the usage change
+    uint8_t message[2 + PROCESS_LIST_TOP_N * sizeof(process_list_entry_t)] = {PROCESS_MSG_TOP_LIST, PROCESS_LIST_TOP_N};
+    process_list_entry_t* entries = (process_list_entry_t*) &message[2];
+    for (uint8_t i = 0; i < PROCESS_LIST_TOP_N; i++) {
+        entries[i].name_id = ui_benchmark_random(PROCESS_LIST_TOP_N);
+        entries[i].cpu_percent = ui_benchmark_random(101);
+        entries[i].mem_percent = ui_benchmark_random(101);
+    }
+    process_list_handle_message(message, sizeof(message));
+}
+
+static void ui_benchmark_record(ui_benchmark_result_t* result, uint32_t cycles) {
+    result->runs++;
+    result->total_cycles += cycles;
+    result->max_cycles = MAX(result->max_cycles, cycles);
+    result->total_px += ui_benchmark_invalidated_px;
+}
+
+// One JSON object per line, prefixed so it can be picked out of the rest of the console output
+static void ui_benchmark_print(const char* scenario, const char* phase, const ui_benchmark_result_t* result) {
+    struct sys_memory_stats heap;
+    lvgl_heap_stats(&heap);
+
+    printk("UIBENCH {\"scenario\":\"%s\",\"phase\":\"%s\",\"runs\":%u,\"time_us_avg\":%u,\"time_us_max\":%u,"
+        "\"invalidated_px_avg\":%u,\"heap_used\":%u,\"heap_peak\":%u,\"objects\":%u}\n",
+        scenario, phase, result->runs, k_cyc_to_us_floor32(result->total_cycles / result->runs),
+        k_cyc_to_us_floor32(result->max_cycles), result->total_px / result->runs, (uint32_t) heap.allocated_bytes,
+        (uint32_t) heap.max_allocated_bytes, ui_benchmark_count_objects(screen));
+}
+
+void state_machine_benchmark() {
+    // The heatmap is the one screen whose cost grows with the host, so it is swept across the core counts a host may
+    // have. Each count is its own scenario with its own baseline and limits in regression_baseline.json
+    static const struct {
+        enum ui_state_machine_states state;
+        const char* name;
+        uint8_t core_count;
+    } scenarios[] = {
+        {MAIN_MENU, "main_menu", 16},
+        {PERFORMANCE_METRICS, "performance_metrics", 16},
+        {COMPUTER_DETAILS, "computer_details", 16},
+        {HEATMAP, "heatmap_4", 4},
+        {HEATMAP, "heatmap_8", 8},
+        {HEATMAP, "heatmap_16", 16},
+        {HEATMAP, "heatmap_32", 32},
+        {HEATMAP, "heatmap_64", 64},
+        {HEATMAP, "heatmap_128", BLE_PER_CORE_MAX_CORES},
+        {PROCESSES, "processes", 16},
+    };
+
+    lv_display_t* display = lv_display_get_default();
+    lv_display_add_event_cb(display, ui_benchmark_invalidate_cb, LV_EVENT_INVALIDATE_AREA, NULL);
+
+    // Pretend to be connected, otherwise the metrics page blanks everything as stale
+    atomic_set(&pipeline_counters.link_up, 1);
+
+    for (uint8_t i = 0; i < PROCESS_LIST_TOP_N; i++) {
+        uint8_t message[3 + PROCESS_NAME_MAX_LENGTH] = {PROCESS_MSG_DEFINE_NAME, i};
+        message[2] = snprintf((char*) &message[3], PROCESS_NAME_MAX_LENGTH + 1, "benchmark-process-%u", i);
+        process_list_handle_message(message, 3 + message[2]);
+    }
+
+    for (size_t s = 0; s < ARRAY_SIZE(scenarios); s++) {
+        const struct smf_state* state = &ui_states[scenarios[s].state];
+        ui_benchmark_result_t entry = {0};
+        ui_benchmark_result_t update = {0};
+
+        // Entering a screen also tears down the previous one, which is the cost of a menu transition
+        lv_refr_now(NULL); // Don't charge anything still pending from the previous scenario to this one
+        ui_benchmark_invalidated_px = 0;
+        uint32_t start = k_cycle_get_32();
+        state->entry(&ui_state_object);
+        lv_refr_now(NULL);
+        ui_benchmark_record(&entry, k_cycle_get_32() - start);
+        ui_benchmark_print(scenarios[s].name, "entry", &entry);
+
+        for (int run = 0; run < CONFIG_APP_UI_BENCHMARK_UPDATES; run++) {
+            ui_benchmark_randomize_metrics(scenarios[s].core_count);
+
+            ui_benchmark_invalidated_px = 0;
+            start = k_cycle_get_32();
+            state->run(&ui_state_object);
+            lv_refr_now(NULL);
+            ui_benchmark_record(&update, k_cycle_get_32() - start);
+        }
+        ui_benchmark_print(scenarios[s].name, "update", &update);
+    }
+
+    atomic_set(&pipeline_counters.link_up, 0);
+    process_list_reset();
+    lv_display_remove_event_cb_with_user_data(display, ui_benchmark_invalidate_cb, NULL);
+}
+
+#endif
@@ -9,15 +9,27 @@
  * Includes
  */
 
+#include <stdio.h>
+#include <string.h>
 #include <zephyr/smf.h>
+#include <zephyr/logging/log.h>
 #include <zephyr/drivers/display.h>
 #include <zephyr/drivers/gpio.h>
+#include <zephyr/sys/mem_stats.h>
 #include <lvgl.h>
+#include <lvgl_mem.h>
 
 #include "touchscreen_defines.h"
+#include "app_trace.h"
 #include "lv_data_obj.h"
+#include "lv_numeric_obj.h"
+#include "lv_heatmap_obj.h"
 #include "BTN.h"
 #include "ble_peripheral.h"
+#include "pipeline_status.h"
+#include "process_list.h"
+#include "metric_bus.h"
+#include "activity.h"
 
 /**
  * Function prototypes
@@ -29,6 +41,11 @@ void state_machine_init();
 
 int state_machine_run();
 
+#if defined(CONFIG_APP_UI_BENCHMARK)
+// Measures every screen and prints the results, must run before state_machine_init
+void state_machine_benchmark();
+#endif
+
 /**
  * Defines
  */
@@ -36,4 +53,11 @@ int state_machine_run();
 #define SW0_NODE DT_ALIAS(sw0) // device tree identifier for button 0 (physical button 1)
 #define METRIC_MAX_LENGTH 64
 
+// Fixed digit counts of the numeric readouts on the performance metrics page
+#define CPU_CLOCK_DIGITS 4
+#define POWER_DIGITS 3
+#define TEMP_DIGITS 3
+#define NETWORK_DIGITS 7 // Up to ~10 Gb/s in Kb/s
+#define PERCENT_DIGITS 3
+
 #endif  
\ No newline at end of file
@@ -6,16 +6,27 @@ Header to define button interface
 #define BTN_H
 
 #include <stdbool.h>
+#include <zephyr/devicetree.h>
+
+/* ----------------------------------------------------------------------------
+                                  Constants
+---------------------------------------------------------------------------- */
+// Buttons are the enabled children of the board's gpio-keys node, in devicetree order
+#define BTN_PARENT_NODE   DT_COMPAT_GET_ANY_STATUS_OKAY(gpio_keys)
+#define NUM_BTNS          DT_CHILD_NUM_STATUS_OKAY(BTN_PARENT_NODE)
+
+// A press only counts once the button has stayed active this long after its last edge
+#define BTN_DEBOUNCE_MS   20
 
 /* ----------------------------------------------------------------------------
                                     TYPES
 ---------------------------------------------------------------------------- */
+// Named ids for the first buttons, boards with more buttons use ids up to NUM_BTNS - 1
 typedef enum btn_id_t {
   BTN0 = 0,
   BTN1,
   BTN2,
   BTN3,
-  NUM_BTNS,
 } btn_id;
 
 /* ----------------------------------------------------------------------------
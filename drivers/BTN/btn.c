@@ -9,21 +9,15 @@ Header to define button module logic
 #include <inttypes.h>
 
 #include "BTN.h"
-
-/* ----------------------------------------------------------------------------
-                                    Constants
----------------------------------------------------------------------------- */
-#define BTN_DEBOUNCE_MS   20
+#include "TRACE.h"
 
 /* ----------------------------------------------------------------------------
                                   Macro Helpers
 ---------------------------------------------------------------------------- */
-#define BTN0_NODE             DT_ALIAS(sw0)
-#define BTN1_NODE             DT_ALIAS(sw1)
-#define BTN2_NODE             DT_ALIAS(sw2)
-#define BTN3_NODE             DT_ALIAS(sw3)
+#define BTN_GPIO_INIT(node_id)  {.spec=GPIO_DT_SPEC_GET(node_id, gpios), .pressed=false}
 
-#define IS_INVALID_BTN(btn)   (btn >= NUM_BTNS || btn < 0)
+// A single unsigned compare also rejects negative ids
+#define IS_INVALID_BTN(btn)     ((unsigned int)(btn) >= NUM_BTNS)
 
 /* ----------------------------------------------------------------------------
                                     Types
@@ -47,11 +41,9 @@ static void _btn_debounce(struct k_work *work);
 /* ----------------------------------------------------------------------------
                                 Global States
 ---------------------------------------------------------------------------- */
-static btn_gpio _btn0 = {.spec=GPIO_DT_SPEC_GET(BTN0_NODE, gpios), .pressed=false};
-static btn_gpio _btn1 = {.spec=GPIO_DT_SPEC_GET(BTN1_NODE, gpios), .pressed=false};
-static btn_gpio _btn2 = {.spec=GPIO_DT_SPEC_GET(BTN2_NODE, gpios), .pressed=false};
-static btn_gpio _btn3 = {.spec=GPIO_DT_SPEC_GET(BTN3_NODE, gpios), .pressed=false};
-static btn_gpio *_btns[NUM_BTNS] = {&_btn0, &_btn1, &_btn2, &_btn3};
+static btn_gpio _btns[NUM_BTNS] = {
+  DT_FOREACH_CHILD_STATUS_OKAY_SEP(BTN_PARENT_NODE, BTN_GPIO_INIT, (,))
+};
 
 /* ----------------------------------------------------------------------------
                               Private Functions
@@ -80,17 +72,16 @@ static int _btn_config(btn_gpio *btn) {
 
 /**
  * @brief Invoked as an interrupt when a button goes to the active state (high)
+ *        Each button registers its own callback, so the button is found from cb directly
  * 
  * @param [in] dev The GPIO port that triggered the interrupt
  * @param [in] cb A pointer to the registered callback structure for this ISR
  * @param [in] pins A bitmask for all the GPIO pins that triggered this interrupt
  */
 static void _btn_interrupt_service_routine(const struct device *dev, struct gpio_callback *cb, uint32_t pins) {
-  for (uint8_t i = 0; i < NUM_BTNS; i++) {
-    if (pins & BIT(_btns[i]->spec.pin)) {
-      k_work_reschedule(&_btns[i]->work, K_MSEC(BTN_DEBOUNCE_MS));
-    }
-  }
+  btn_gpio *btn = CONTAINER_OF(cb, btn_gpio, cb);
+
+  k_work_reschedule(&btn->work, K_MSEC(BTN_DEBOUNCE_MS));
   return;
 }
 
@@ -103,9 +94,11 @@ static void _btn_debounce(struct k_work *_work) {
   struct k_work_delayable *dwork = CONTAINER_OF(_work, struct k_work_delayable, work);
   btn_gpio *btn = CONTAINER_OF(dwork, btn_gpio, work);
 
+  DRV_TRACE_BEGIN("btn_debounce", btn->spec.pin);
   if (gpio_pin_get_dt(&btn->spec)) {
     btn->pressed = true;
   }
+  DRV_TRACE_END("btn_debounce", btn->pressed);
 }
 
 /* ----------------------------------------------------------------------------
@@ -118,7 +111,7 @@ static void _btn_debounce(struct k_work *_work) {
  */
 int BTN_init() {
   for (uint8_t i = 0; i < NUM_BTNS; i++) {
-    int rv = _btn_config(_btns[i]);
+    int rv = _btn_config(&_btns[i]);
     if (rv < 0) {
       return rv;
     }
@@ -136,7 +129,7 @@ int BTN_init() {
 bool BTN_is_pressed(btn_id btn) {
   if (IS_INVALID_BTN(btn)) {
     return false;
-  } else if (0 < gpio_pin_get_dt(&_btns[btn]->spec)) {
+  } else if (0 < gpio_pin_get_dt(&_btns[btn].spec)) {
     return true;
   } else {
     return false;
@@ -155,8 +148,8 @@ bool BTN_check_clear_pressed(btn_id btn) {
   if (IS_INVALID_BTN(btn)) {
     return false;
   } else {
-    bool was_pressed = _btns[btn]->pressed;
-    _btns[btn]->pressed = false;
+    bool was_pressed = _btns[btn].pressed;
+    _btns[btn].pressed = false;
     return was_pressed;
   }
 }
@@ -172,7 +165,7 @@ bool BTN_check_pressed(btn_id btn) {
   if (IS_INVALID_BTN(btn)) {
     return false;
   } else {
-    return _btns[btn]->pressed;
+    return _btns[btn].pressed;
   }
 }
 
@@ -185,7 +178,7 @@ void BTN_clear_pressed(btn_id btn) {
   if (IS_INVALID_BTN(btn)) {
     return;
   } else {
-    _btns[btn]->pressed = false;
+    _btns[btn].pressed = false;
     return;
   }
 }
@@ -0,0 +1,265 @@
+/**
+ * @file lv_heatmap_obj.c
+ *
+ */
+
+/***********************************************************************
+ * Includes
+ **********************************************************************/
+
+#include <lvgl.h>
+#include <stddef.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include "core/lv_obj_class_private.h"
+#include "core/lv_obj_private.h"
+#include "draw/lv_draw_private.h"
+#include "lv_heatmap_obj.h"
+
+/***********************************************************************
+ * Defines
+ **********************************************************************/
+
+#define MY_CLASS (&lv_heatmap_obj_class)
+
+/* Gap between cells, and the height of the clock strip as a fraction of the
+ * cell height */
+#define LV_HEATMAP_OBJ_GAP 2
+#define LV_HEATMAP_OBJ_STRIP_DIV 4
+
+/***********************************************************************
+ * Types
+ **********************************************************************/
+
+typedef struct _lv_heatmap_obj_t {
+  lv_obj_t obj;
+  uint8_t count;
+  uint8_t load_percent[LV_HEATMAP_OBJ_MAX_CELLS];
+  uint16_t clock_mhz[LV_HEATMAP_OBJ_MAX_CELLS];
+  /* Highest clock seen, the strips are scaled against it. It only grows, so
+   * the scale (and every strip) rarely changes */
+  uint16_t clock_scale_mhz;
+  /* Grid layout, recomputed when the size or the cell count changes */
+  uint8_t cols;
+  uint8_t rows;
+  int32_t cell_w;
+  int32_t cell_h;
+} lv_heatmap_obj_t;
+
+/***********************************************************************
+ * Prototypes
+ **********************************************************************/
+
+static void lv_heatmap_obj_constructor(const lv_obj_class_t *class_p,
+                                       lv_obj_t *obj);
+static void lv_heatmap_obj_event(const lv_obj_class_t *class_p,
+                                 lv_event_t *e);
+static void lv_heatmap_obj_layout(lv_heatmap_obj_t *heatmap);
+static void lv_heatmap_obj_cell_area(lv_heatmap_obj_t *heatmap, uint8_t cell,
+                                     lv_area_t *area);
+static void lv_heatmap_obj_draw(lv_heatmap_obj_t *heatmap, lv_layer_t *layer);
+
+/***********************************************************************
+ * Variables
+ **********************************************************************/
+
+const lv_obj_class_t lv_heatmap_obj_class = {
+    .constructor_cb = lv_heatmap_obj_constructor,
+    .event_cb = lv_heatmap_obj_event,
+    .width_def = LV_PCT(100),
+    .height_def = LV_PCT(100),
+    .instance_size = sizeof(lv_heatmap_obj_t),
+    .base_class = &lv_obj_class,
+    .name = "lv_heatmap_obj",
+};
+
+/***********************************************************************
+ * Functions
+ **********************************************************************/
+
+lv_obj_t *lv_heatmap_obj_create(lv_obj_t *parent) {
+  lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+  lv_obj_class_init_obj(obj);
+
+  return obj;
+}
+
+void lv_heatmap_obj_set_cells(lv_obj_t *obj, const uint8_t *load_percent,
+                              const uint16_t *clock_mhz, uint8_t count) {
+  lv_heatmap_obj_t *heatmap = (lv_heatmap_obj_t *)obj;
+  count = LV_MIN(count, LV_HEATMAP_OBJ_MAX_CELLS);
+
+  uint16_t clock_scale_mhz = heatmap->clock_scale_mhz;
+  for (uint8_t i = 0; i < count; i++) {
+    clock_scale_mhz = LV_MAX(clock_scale_mhz, clock_mhz[i]);
+  }
+
+  /* A new grid or a new clock scale changes every cell */
+  bool full = count != heatmap->count ||
+              clock_scale_mhz != heatmap->clock_scale_mhz;
+  heatmap->clock_scale_mhz = clock_scale_mhz;
+
+  if (full) {
+    heatmap->count = count;
+    memcpy(heatmap->load_percent, load_percent, count);
+    memcpy(heatmap->clock_mhz, clock_mhz, count * sizeof(clock_mhz[0]));
+    lv_heatmap_obj_layout(heatmap);
+    lv_obj_invalidate(obj);
+    return;
+  }
+
+  /* No content area yet, so no grid to place cells in. Keep the values for
+   * when a size change lays it out, there is nothing on screen to invalidate */
+  if (heatmap->cols == 0) {
+    memcpy(heatmap->load_percent, load_percent, count);
+    memcpy(heatmap->clock_mhz, clock_mhz, count * sizeof(clock_mhz[0]));
+    return;
+  }
+
+  /* Invalidate one bounding box around the changed cells. Invalidating each
+   * cell separately would overflow LVGL's invalid area list with many cores
+   * and fall back to redrawing the whole screen */
+  lv_area_t dirty;
+  bool any = false;
+  for (uint8_t i = 0; i < count; i++) {
+    if (heatmap->load_percent[i] == load_percent[i] &&
+        heatmap->clock_mhz[i] == clock_mhz[i]) {
+      continue;
+    }
+    heatmap->load_percent[i] = load_percent[i];
+    heatmap->clock_mhz[i] = clock_mhz[i];
+
+    lv_area_t cell;
+    lv_heatmap_obj_cell_area(heatmap, i, &cell);
+    if (any) {
+      dirty.x1 = LV_MIN(dirty.x1, cell.x1);
+      dirty.y1 = LV_MIN(dirty.y1, cell.y1);
+      dirty.x2 = LV_MAX(dirty.x2, cell.x2);
+      dirty.y2 = LV_MAX(dirty.y2, cell.y2);
+    } else {
+      dirty = cell;
+      any = true;
+    }
+  }
+
+  if (any) {
+    lv_obj_invalidate_area(obj, &dirty);
+  }
+}
+
+static void lv_heatmap_obj_layout(lv_heatmap_obj_t *heatmap) {
+  lv_area_t content;
+  lv_obj_get_content_coords(&heatmap->obj, &content);
+  int32_t w = lv_area_get_width(&content);
+  int32_t h = lv_area_get_height(&content);
+
+  if (heatmap->count == 0 || w <= 0 || h <= 0) {
+    heatmap->cols = 0;
+    heatmap->rows = 0;
+    return;
+  }
+
+  /* Pick the column count that keeps cells closest to square, 128 cores on
+   * a 320x240 panel comes out as 13 x 10 */
+  uint8_t cols = 1;
+  while (cols < heatmap->count &&
+         (int64_t)cols * cols * h < (int64_t)heatmap->count * w) {
+    cols++;
+  }
+  heatmap->cols = cols;
+  heatmap->rows = (heatmap->count + cols - 1) / cols;
+  heatmap->cell_w = w / heatmap->cols;
+  heatmap->cell_h = h / heatmap->rows;
+}
+
+static void lv_heatmap_obj_cell_area(lv_heatmap_obj_t *heatmap, uint8_t cell,
+                                     lv_area_t *area) {
+  lv_area_t content;
+  lv_obj_get_content_coords(&heatmap->obj, &content);
+
+  area->x1 = content.x1 + (cell % heatmap->cols) * heatmap->cell_w;
+  area->y1 = content.y1 + (cell / heatmap->cols) * heatmap->cell_h;
+  area->x2 = area->x1 + heatmap->cell_w - 1 - LV_HEATMAP_OBJ_GAP;
+  area->y2 = area->y1 + heatmap->cell_h - 1 - LV_HEATMAP_OBJ_GAP;
+}
+
+static void lv_heatmap_obj_draw(lv_heatmap_obj_t *heatmap, lv_layer_t *layer) {
+  if (heatmap->cols == 0) {
+    return;
+  }
+
+  lv_draw_rect_dsc_t dsc;
+  lv_draw_rect_dsc_init(&dsc);
+  dsc.bg_opa = LV_OPA_COVER;
+  dsc.radius = 2;
+
+  lv_color_t cool = lv_palette_main(LV_PALETTE_GREEN);
+  lv_color_t hot = lv_palette_main(LV_PALETTE_RED);
+  lv_color_t strip = lv_color_black();
+
+  for (uint8_t i = 0; i < heatmap->count; i++) {
+    lv_area_t cell;
+    lv_heatmap_obj_cell_area(heatmap, i, &cell);
+
+    /* Only cells inside the invalidated area generate draw tasks, so a
+     * partial update costs in proportion to what changed */
+    const lv_area_t *clip = &layer->_clip_area;
+    if (cell.x2 < clip->x1 || cell.x1 > clip->x2 || cell.y2 < clip->y1 ||
+        cell.y1 > clip->y2) {
+      continue;
+    }
+
+    uint8_t load = LV_MIN(heatmap->load_percent[i], 100);
+    dsc.bg_color = lv_color_mix(hot, cool, (load * 255) / 100);
+    lv_draw_rect(layer, &dsc, &cell);
+
+    if (heatmap->clock_scale_mhz == 0) {
+      continue;
+    }
+
+    int32_t strip_w = (lv_area_get_width(&cell) * heatmap->clock_mhz[i]) /
+                      heatmap->clock_scale_mhz;
+    if (strip_w <= 0) {
+      continue;
+    }
+
+    lv_area_t strip_area = cell;
+    strip_area.y1 =
+        strip_area.y2 - lv_area_get_height(&cell) / LV_HEATMAP_OBJ_STRIP_DIV;
+    strip_area.x2 = strip_area.x1 + strip_w - 1;
+
+    lv_draw_rect_dsc_t strip_dsc = dsc;
+    strip_dsc.bg_color = strip;
+    strip_dsc.bg_opa = LV_OPA_40;
+    lv_draw_rect(layer, &strip_dsc, &strip_area);
+  }
+}
+
+static void lv_heatmap_obj_constructor(
+    const lv_obj_class_t __attribute__((unused)) * class_p, lv_obj_t *obj) {
+  lv_heatmap_obj_t *heatmap = (lv_heatmap_obj_t *)obj;
+  heatmap->count = 0;
+  heatmap->clock_scale_mhz = 0;
+  heatmap->cols = 0;
+  heatmap->rows = 0;
+  lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+}
+
+static void lv_heatmap_obj_event(
+    const lv_obj_class_t __attribute__((unused)) * class_p, lv_event_t *e) {
+  if (lv_obj_event_base(MY_CLASS, e) != LV_RESULT_OK) {
+    return;
+  }
+
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_heatmap_obj_t *heatmap =
+      (lv_heatmap_obj_t *)lv_event_get_current_target(e);
+
+  if (code == LV_EVENT_SIZE_CHANGED || code == LV_EVENT_STYLE_CHANGED) {
+    lv_heatmap_obj_layout(heatmap);
+    lv_obj_invalidate(&heatmap->obj);
+  } else if (code == LV_EVENT_DRAW_MAIN) {
+    lv_heatmap_obj_draw(heatmap, lv_event_get_layer(e));
+  }
+}
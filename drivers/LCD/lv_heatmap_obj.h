@@ -0,0 +1,43 @@
+#ifndef LV_HEATMAP_OBJ_H
+#define LV_HEATMAP_OBJ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lvgl.h>
+
+#define LV_HEATMAP_OBJ_MAX_CELLS 128
+
+/**
+ * @brief Create a heatmap that is a child of parent. Every cell is drawn by
+ * the heatmap itself in one draw pass, so the cost of a cell is a couple of
+ * rectangles rather than a whole LVGL object.
+ *
+ * Each cell is coloured by its load (green at 0 %, red at 100 %) and has a
+ * strip along its bottom edge showing its clock relative to the highest
+ * clock seen so far.
+ *
+ * @param[in] parent The parent object
+ * @return lv_obj_t* The heatmap object
+ */
+lv_obj_t* lv_heatmap_obj_create(lv_obj_t* parent);
+
+/**
+ * @brief Show a new set of cells. Only the bounding box of the cells that
+ * changed is invalidated, and a change in the number of cells relays the
+ * grid out.
+ *
+ * @param[in] obj The heatmap object
+ * @param[in] load_percent Load of each cell, 0 to 100
+ * @param[in] clock_mhz Clock of each cell
+ * @param[in] count Number of cells, clamped to LV_HEATMAP_OBJ_MAX_CELLS
+ */
+void lv_heatmap_obj_set_cells(lv_obj_t* obj, const uint8_t* load_percent,
+                              const uint16_t* clock_mhz, uint8_t count);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,228 @@
+/**
+ * @file lv_numeric_obj.c
+ *
+ */
+
+/***********************************************************************
+ * Includes
+ **********************************************************************/
+
+#include <lvgl.h>
+#include <stddef.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+
+#include "core/lv_obj_class_private.h"
+#include "core/lv_obj_private.h"
+#include "lv_numeric_obj.h"
+
+/***********************************************************************
+ * Defines
+ **********************************************************************/
+
+#define MY_CLASS (&lv_numeric_obj_class)
+
+#define LV_NUMERIC_OBJ_BLANK ' '
+#define LV_NUMERIC_OBJ_DASH '-'
+
+/***********************************************************************
+ * Types
+ **********************************************************************/
+
+typedef struct _lv_numeric_obj_t {
+  lv_obj_t obj;
+  const char *prefix;
+  const char *unit;
+  uint8_t digits;
+  /* Each cell is its own NUL terminated string so draw tasks can point
+   * straight at it without copying */
+  char cells[LV_NUMERIC_OBJ_MAX_DIGITS][2];
+  int32_t prefix_width;
+  int32_t cell_width;
+  int32_t unit_width;
+} lv_numeric_obj_t;
+
+/***********************************************************************
+ * Prototypes
+ **********************************************************************/
+
+static void lv_numeric_obj_constructor(const lv_obj_class_t *class_p,
+                                       lv_obj_t *obj);
+static void lv_numeric_obj_event(const lv_obj_class_t *class_p,
+                                 lv_event_t *e);
+static void lv_numeric_obj_measure(lv_numeric_obj_t *numeric);
+static void lv_numeric_obj_set_cell(lv_numeric_obj_t *numeric, uint8_t cell,
+                                    char c);
+static void lv_numeric_obj_draw(lv_numeric_obj_t *numeric, lv_layer_t *layer);
+
+/***********************************************************************
+ * Variables
+ **********************************************************************/
+
+const lv_obj_class_t lv_numeric_obj_class = {
+    .constructor_cb = lv_numeric_obj_constructor,
+    .event_cb = lv_numeric_obj_event,
+    .width_def = LV_SIZE_CONTENT,
+    .height_def = LV_SIZE_CONTENT,
+    .instance_size = sizeof(lv_numeric_obj_t),
+    .base_class = &lv_obj_class,
+    .name = "lv_numeric_obj",
+};
+
+/***********************************************************************
+ * Functions
+ **********************************************************************/
+
+lv_obj_t *lv_numeric_obj_create(lv_obj_t *parent) {
+  lv_obj_t *obj = lv_obj_class_create_obj(MY_CLASS, parent);
+  lv_obj_class_init_obj(obj);
+
+  return obj;
+}
+
+void lv_numeric_obj_set_format(lv_obj_t *obj, const char *prefix,
+                               uint8_t digits, const char *unit) {
+  lv_numeric_obj_t *numeric = (lv_numeric_obj_t *)obj;
+
+  numeric->prefix = prefix != NULL ? prefix : "";
+  numeric->unit = unit != NULL ? unit : "";
+  numeric->digits = LV_CLAMP(1, digits, LV_NUMERIC_OBJ_MAX_DIGITS);
+  for (uint8_t i = 0; i < LV_NUMERIC_OBJ_MAX_DIGITS; i++) {
+    numeric->cells[i][0] = LV_NUMERIC_OBJ_DASH;
+    numeric->cells[i][1] = '\0';
+  }
+
+  /* The overall size changes, so this is the one place a full relayout is
+   * needed */
+  lv_numeric_obj_measure(numeric);
+  lv_obj_refresh_self_size(obj);
+  lv_obj_invalidate(obj);
+}
+
+void lv_numeric_obj_set_value(lv_obj_t *obj, uint32_t value) {
+  lv_numeric_obj_t *numeric = (lv_numeric_obj_t *)obj;
+
+  /* Fill from the least significant cell, leading zeros are blank */
+  for (int8_t i = numeric->digits - 1; i >= 0; i--) {
+    bool leading = value == 0 && i != numeric->digits - 1;
+    lv_numeric_obj_set_cell(numeric, i,
+                            leading ? LV_NUMERIC_OBJ_BLANK : '0' + value % 10);
+    value /= 10;
+  }
+
+  /* Out of range, clamp to all nines */
+  if (value != 0) {
+    for (uint8_t i = 0; i < numeric->digits; i++) {
+      lv_numeric_obj_set_cell(numeric, i, '9');
+    }
+  }
+}
+
+void lv_numeric_obj_clear_value(lv_obj_t *obj) {
+  lv_numeric_obj_t *numeric = (lv_numeric_obj_t *)obj;
+
+  for (uint8_t i = 0; i < numeric->digits; i++) {
+    lv_numeric_obj_set_cell(numeric, i, LV_NUMERIC_OBJ_DASH);
+  }
+}
+
+static void lv_numeric_obj_set_cell(lv_numeric_obj_t *numeric, uint8_t cell,
+                                    char c) {
+  if (numeric->cells[cell][0] == c) {
+    return;
+  }
+  numeric->cells[cell][0] = c;
+
+  /* Invalidate just this digit's cell instead of the whole object */
+  lv_area_t area;
+  lv_obj_get_content_coords(&numeric->obj, &area);
+  area.x1 += numeric->prefix_width + cell * numeric->cell_width;
+  area.x2 = area.x1 + numeric->cell_width - 1;
+  lv_obj_invalidate_area(&numeric->obj, &area);
+}
+
+static void lv_numeric_obj_measure(lv_numeric_obj_t *numeric) {
+  lv_obj_t *obj = &numeric->obj;
+  const lv_font_t *font = lv_obj_get_style_text_font(obj, LV_PART_MAIN);
+  int32_t letter_space = lv_obj_get_style_text_letter_space(obj, LV_PART_MAIN);
+
+  /* Every cell is as wide as the widest glyph it can hold, so a digit
+   * changing never moves its neighbours */
+  int32_t widest = lv_font_get_glyph_width(font, LV_NUMERIC_OBJ_DASH, 0);
+  for (char c = '0'; c <= '9'; c++) {
+    widest = LV_MAX(widest, lv_font_get_glyph_width(font, c, 0));
+  }
+  numeric->cell_width = widest + letter_space;
+
+  numeric->prefix_width = lv_text_get_width(
+      numeric->prefix, strlen(numeric->prefix), font, letter_space);
+  numeric->unit_width = lv_text_get_width(numeric->unit, strlen(numeric->unit),
+                                          font, letter_space);
+}
+
+static void lv_numeric_obj_draw(lv_numeric_obj_t *numeric, lv_layer_t *layer) {
+  lv_obj_t *obj = &numeric->obj;
+  lv_draw_label_dsc_t dsc;
+  lv_draw_label_dsc_init(&dsc);
+  lv_obj_init_draw_label_dsc(obj, LV_PART_MAIN, &dsc);
+
+  lv_area_t content;
+  lv_obj_get_content_coords(obj, &content);
+
+  lv_area_t area = content;
+  area.x2 = area.x1 + numeric->prefix_width - 1;
+  dsc.text = numeric->prefix;
+  lv_draw_label(layer, &dsc, &area);
+
+  dsc.align = LV_TEXT_ALIGN_CENTER;
+  for (uint8_t i = 0; i < numeric->digits; i++) {
+    area.x1 = area.x2 + 1;
+    area.x2 = area.x1 + numeric->cell_width - 1;
+    dsc.text = numeric->cells[i];
+    lv_draw_label(layer, &dsc, &area);
+  }
+
+  dsc.align = LV_TEXT_ALIGN_LEFT;
+  area.x1 = area.x2 + 1;
+  area.x2 = content.x2;
+  dsc.text = numeric->unit;
+  lv_draw_label(layer, &dsc, &area);
+}
+
+static void lv_numeric_obj_constructor(
+    const lv_obj_class_t __attribute__((unused)) * class_p, lv_obj_t *obj) {
+  lv_numeric_obj_t *numeric = (lv_numeric_obj_t *)obj;
+  numeric->prefix = "";
+  numeric->unit = "";
+  numeric->digits = 1;
+  numeric->cells[0][0] = LV_NUMERIC_OBJ_DASH;
+  numeric->cells[0][1] = '\0';
+  lv_obj_remove_flag(obj, LV_OBJ_FLAG_CLICKABLE | LV_OBJ_FLAG_SCROLLABLE);
+  lv_numeric_obj_measure(numeric);
+}
+
+static void lv_numeric_obj_event(
+    const lv_obj_class_t __attribute__((unused)) * class_p, lv_event_t *e) {
+  if (lv_obj_event_base(MY_CLASS, e) != LV_RESULT_OK) {
+    return;
+  }
+
+  lv_event_code_t code = lv_event_get_code(e);
+  lv_numeric_obj_t *numeric =
+      (lv_numeric_obj_t *)lv_event_get_current_target(e);
+
+  if (code == LV_EVENT_STYLE_CHANGED) {
+    lv_numeric_obj_measure(numeric);
+    lv_obj_refresh_self_size(&numeric->obj);
+  } else if (code == LV_EVENT_GET_SELF_SIZE) {
+    lv_point_t *size = lv_event_get_param(e);
+    const lv_font_t *font =
+        lv_obj_get_style_text_font(&numeric->obj, LV_PART_MAIN);
+    size->x = LV_MAX(size->x, numeric->prefix_width +
+                                  numeric->digits * numeric->cell_width +
+                                  numeric->unit_width);
+    size->y = LV_MAX(size->y, lv_font_get_line_height(font));
+  } else if (code == LV_EVENT_DRAW_MAIN) {
+    lv_numeric_obj_draw(numeric, lv_event_get_layer(e));
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef LV_NUMERIC_OBJ_H
+#define LV_NUMERIC_OBJ_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <lvgl.h>
+
+#define LV_NUMERIC_OBJ_MAX_DIGITS 10
+
+/**
+ * @brief Create a fixed-width numeric readout that is a child of parent.
+ * The readout draws "<prefix><digits><unit>" and only invalidates the digits
+ * that change when its value is updated.
+ *
+ * @param[in] parent The parent object
+ * @return lv_obj_t* The numeric object
+ */
+lv_obj_t* lv_numeric_obj_create(lv_obj_t* parent);
+
+/**
+ * @brief Set the static text around the digits and the number of digits shown.
+ * The value is cleared and shown as dashes until the next set_value call.
+ *
+ * @param[in] obj The numeric object
+ * @param[in] prefix Text drawn before the digits, not copied so it must stay
+ *   valid for the lifetime of the object (use a string literal)
+ * @param[in] digits Number of digit cells, 1 to LV_NUMERIC_OBJ_MAX_DIGITS
+ * @param[in] unit Text drawn after the digits, not copied like prefix
+ */
+void lv_numeric_obj_set_format(lv_obj_t* obj, const char* prefix,
+                               uint8_t digits, const char* unit);
+
+/**
+ * @brief Show a new value, invalidating only the digit cells that changed.
+ * Values wider than the digit cells are clamped to all nines.
+ *
+ * @param[in] obj The numeric object
+ * @param[in] value The value to show
+ */
+void lv_numeric_obj_set_value(lv_obj_t* obj, uint32_t value);
+
+/**
+ * @brief Show dashes in every digit cell, e.g. before any data arrives
+ *
+ * @param[in] obj The numeric object
+ */
+void lv_numeric_obj_clear_value(lv_obj_t* obj);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
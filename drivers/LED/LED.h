@@ -6,16 +6,37 @@ Header to define led interface
 #define LED_H
 
 #include "stdint.h"
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
+/* ----------------------------------------------------------------------------
+                                  Constants
+---------------------------------------------------------------------------- */
+// LEDs are the enabled children of the board's pwm-leds node, in devicetree order
+#define LED_PARENT_NODE   DT_COMPAT_GET_ANY_STATUS_OKAY(pwm_leds)
+#define NUM_LEDS          DT_CHILD_NUM_STATUS_OKAY(LED_PARENT_NODE)
+
+/* ----------------------------------------------------------------------------
+                                Macro Helpers
+---------------------------------------------------------------------------- */
+// Brightness is linear in on-time: static LEDs, blinking and every waveform step all go through
+// these, so an LED handed between the PWM driver and a sequence keeps its brightness
+#define LED_DUTY_TO_PERMILLE(duty_cycle)  ((uint16_t)(duty_cycle) * 10)
+
+// Pulse for an active-low LED lit for permille / 1000 of each period, in the period's own units
+// (ns for the Zephyr PWM API, counter ticks for a PWM sequence)
+#define LED_PERMILLE_TO_PULSE(period, permille) \
+  ((uint32_t)(period) - (uint32_t)(((uint64_t)(period) * (permille)) / 1000))
 
 /* ----------------------------------------------------------------------------
                                     TYPES
 ---------------------------------------------------------------------------- */
+// Named ids for the first LEDs, boards with more LEDs use ids up to NUM_LEDS - 1
 typedef enum led_id_t {
   LED0 = 0,
   LED1,
   LED2,
   LED3,
-  NUM_LEDS,
 } led_id;
 
 typedef enum led_state_t {
@@ -44,4 +65,12 @@ int LED_pwm(led_id led, uint8_t duty_cycle);
 
 void LED_blink(led_id led, led_frequency frequency);
 
+int LED_fade(led_id led, uint8_t duty_cycle, uint16_t duration_ms);
+
+int LED_breathe(led_id led, uint16_t period_ms);
+
+int LED_pattern(led_id led, const uint8_t *duty_cycles, uint8_t length, uint16_t step_ms, bool repeat);
+
+uint32_t LED_dropped_commands();
+
 #endif
\ No newline at end of file
@@ -4,29 +4,54 @@ Header to define led module logic
 
 #include <zephyr/kernel.h>
 #include <zephyr/drivers/pwm.h>
+#include <zephyr/sys/atomic.h>
+#include <zephyr/sys/util.h>
 #include <inttypes.h>
 
+#ifdef CONFIG_PWM_NRFX
+#include <hal/nrf_pwm.h>
+#endif
+
 #include "LED.h"
+#include "TRACE.h"
 
 /* ----------------------------------------------------------------------------
                                     Constants
 ---------------------------------------------------------------------------- */
-#define LED_BLINK_STACK_SIZE      384
-#define LED_BLINK_PRIORITY        1
+#define LED_ENGINE_STACK_SIZE     384
+#define LED_ENGINE_PRIORITY       1
+#define LED_CMD_RING_SIZE         16 // Must be a power of two
 #define LED_COUNTER_UNIT          100 // Units per ms (1 unit == 10us)
 #define LED_COUNTER_HALF_PERIOD   500 * LED_COUNTER_UNIT // Units per half second (1 second / 2 == 500ms)
 
 #define PWM_MAX_DUTY_CYCLE        100 // Valid duty cycle range for this application is 0 - 100
 
+#define LED_WAVE_MAX_STEPS        64 // Steps held in the DMA sequence buffer shared by all LEDs
+
 /* ----------------------------------------------------------------------------
                                   Macro Helpers
 ---------------------------------------------------------------------------- */
-#define LED0_NODE             DT_ALIAS(pwm_led0)
-#define LED1_NODE             DT_ALIAS(pwm_led1)
-#define LED2_NODE             DT_ALIAS(pwm_led2)
-#define LED3_NODE             DT_ALIAS(pwm_led3)
+#define LED_INIT(node_id)     {.spec=PWM_DT_SPEC_GET(node_id), .current_duty_cycle=0}
+
+#define LED_CMD_RING_MASK     (LED_CMD_RING_SIZE - 1)
+
+// A single unsigned compare also rejects negative ids
+#define IS_INVALID_LED(led)   ((unsigned int)(led) >= NUM_LEDS)
+
+#ifdef CONFIG_PWM_NRFX
+#define LED_PWM_REGS(node_id) ((NRF_PWM_Type *)DT_REG_ADDR(DT_PWMS_CTLR(node_id)))
+
+#define LED_PWM_ADDR_OR(node_id)  | DT_REG_ADDR(DT_PWMS_CTLR(node_id))
+#define LED_PWM_ADDR_AND(node_id) & DT_REG_ADDR(DT_PWMS_CTLR(node_id))
+
+// All LEDs share one PWM instance so a single sequence can drive every channel
+#define LED_WAVE_PWM          _led_wave_pwms[0]
+#define LED_WAVE_POLARITY     0x8000 // Sequence value bit selecting falling-edge polarity
+#define LED_WAVE_MAX_REFRESH  PWM_SEQ_REFRESH_CNT_Msk // Extra periods a step can be held for
 
-#define IS_INVALID_LED(led)   (led >= NUM_LEDS || led < 0)
+// The 16-bit sequence entry driving the given LED's channel at the given step
+#define LED_WAVE_CHANNEL(step, led) (((uint16_t *)&_led_wave_seq[step])[_leds[led].spec.channel])
+#endif
 
 /* ----------------------------------------------------------------------------
                                     Types
@@ -36,17 +61,79 @@ typedef struct led_blink_t {
   uint16_t offset; // Units of 10us
 } led_blink;
 
+typedef enum led_wave_type_t {
+  LED_WAVE_NONE = 0,
+  LED_WAVE_FADE,
+  LED_WAVE_BREATHE,
+  LED_WAVE_PATTERN,
+} led_wave_type;
+
+typedef struct led_wave_t {
+  led_wave_type type;
+  uint8_t from; // Fade start duty cycle
+  uint8_t to; // Fade end duty cycle
+  const uint8_t *pattern; // Pattern duty cycles, 0 - 100
+  uint8_t length; // Number of entries in pattern
+  bool repeat; // Loop until told otherwise, otherwise hold the last step after one pass
+} led_wave;
+
 typedef struct led_t {
   struct pwm_dt_spec spec; 
   led_blink blink;
+  led_wave wave;
   uint8_t current_duty_cycle; // Valid from 0 - 100
 } led_type;
 
-typedef struct blink_thread_t {
+typedef enum led_cmd_op_t {
+  LED_CMD_TOGGLE = 0,
+  LED_CMD_PWM,
+  LED_CMD_BLINK,
+  LED_CMD_FADE,
+  LED_CMD_BREATHE,
+  LED_CMD_PATTERN,
+} led_cmd_op;
+
+typedef struct led_cmd_t {
+  uint8_t op; // One of led_cmd_op
+  uint8_t led;
+  uint8_t value; // Duty cycle for PWM and FADE, frequency for BLINK
+  uint8_t length; // Number of entries in pattern
+  uint16_t time_ms; // Fade duration, breathe period or pattern step
+  bool repeat;
+  const uint8_t *pattern;
+} led_cmd;
+
+typedef struct led_cmd_slot_t {
+  atomic_t sequence; // Ring position the slot is ready for, see _led_cmd_post
+  led_cmd cmd;
+} led_cmd_slot;
+
+/*
+ * Ownership: the engine thread is the only writer of every led_type, the blink and
+ * waveform bitmasks and the PWM itself. Callers (threads or ISRs) only validate their
+ * arguments and post a command, so the public API never blocks and never races.
+ */
+typedef struct led_engine_t {
   struct k_thread thread;
   k_tid_t id;
-  uint8_t led_bitmask;
-} blink_thread;
+  atomic_t running; // Set once LED_init has started the engine, commands are refused before that
+  struct k_sem wake; // Given by producers after posting a command
+  atomic_t blink_bitmask; // LEDs currently blinking, written by the engine only
+  int64_t next_tick; // Uptime of the next blink tick in ms, engine only
+  atomic_t head; // Next ring position claimed by a producer
+  uint32_t tail; // Next ring position consumed by the engine, engine only
+  atomic_t dropped; // Commands rejected because the ring was full
+  led_cmd_slot ring[LED_CMD_RING_SIZE];
+} led_engine;
+
+typedef struct wave_sequence_t {
+  uint8_t steps; // Steps currently used in the sequence buffer
+  uint32_t refresh; // Extra PWM periods each step is held for
+  bool looping; // The sequence loops in hardware, true while any animated LED repeats
+  uint32_t one_shot_bitmask; // Animated LEDs that stop after one pass, engine only
+  int64_t pass_end; // Uptime in ms the current pass of the sequence ends at, engine only
+  atomic_t led_bitmask; // LEDs currently driven by the sequence, written by the engine only
+} wave_sequence;
 
 /* ----------------------------------------------------------------------------
                             Private Function Prototypes
@@ -55,25 +142,67 @@ static int _led_pwm_preserve_blink(led_id led, uint8_t duty_cycle);
 
 static void _led_halt_blink(led_id led);
 
-static void _led_blink_loop(void *led, void *p2, void *p3);
+static int _led_cmd_post(const led_cmd *cmd);
+
+static bool _led_cmd_take(led_cmd *cmd);
+
+static void _led_cmd_run(const led_cmd *cmd);
+
+static void _led_engine_loop(void *p1, void *p2, void *p3);
+
+#ifdef CONFIG_PWM_NRFX
+static uint16_t _led_wave_value(led_id led, uint16_t permille);
+#endif
+
+static int _led_wave_play(led_id led, const led_wave *wave, uint32_t duration_ms);
+
+static void _led_wave_halt(led_id led);
+
+static void _led_wave_poll(void);
 
 /* ----------------------------------------------------------------------------
                                 Global States
 ---------------------------------------------------------------------------- */
-static led_type _led0 = {.spec=PWM_DT_SPEC_GET(LED0_NODE), .current_duty_cycle=0};
-static led_type _led1 = {.spec=PWM_DT_SPEC_GET(LED1_NODE), .current_duty_cycle=0};
-static led_type _led2 = {.spec=PWM_DT_SPEC_GET(LED2_NODE), .current_duty_cycle=0};
-static led_type _led3 = {.spec=PWM_DT_SPEC_GET(LED3_NODE), .current_duty_cycle=0};
-static led_type *_leds[NUM_LEDS] = {&_led0, &_led1, &_led2, &_led3};
-
-static blink_thread _led_blink_thread = {.led_bitmask=0};
-K_THREAD_STACK_DEFINE(_led_blink_stack, LED_BLINK_STACK_SIZE);
+static led_type _leds[NUM_LEDS] = {
+  DT_FOREACH_CHILD_STATUS_OKAY_SEP(LED_PARENT_NODE, LED_INIT, (,))
+};
+BUILD_ASSERT(NUM_LEDS <= 32, "LED bitmasks hold at most 32 LEDs");
+
+BUILD_ASSERT(IS_POWER_OF_TWO(LED_CMD_RING_SIZE), "LED command ring size must be a power of two");
+
+static led_engine _led_engine = {.running=ATOMIC_INIT(0), .blink_bitmask=ATOMIC_INIT(0), .head=ATOMIC_INIT(0), .tail=0};
+K_THREAD_STACK_DEFINE(_led_engine_stack, LED_ENGINE_STACK_SIZE);
+
+#ifdef CONFIG_PWM_NRFX
+static NRF_PWM_Type *const _led_wave_pwms[NUM_LEDS] = {
+  DT_FOREACH_CHILD_STATUS_OKAY_SEP(LED_PARENT_NODE, LED_PWM_REGS, (,))
+};
+// The addresses are all equal exactly when OR-ing them gives the same as AND-ing them
+BUILD_ASSERT((0 DT_FOREACH_CHILD_STATUS_OKAY(LED_PARENT_NODE, LED_PWM_ADDR_OR))
+    == (0xFFFFFFFFU DT_FOREACH_CHILD_STATUS_OKAY(LED_PARENT_NODE, LED_PWM_ADDR_AND)),
+  "Every pwm-leds child must use the same PWM instance, waveforms drive them all from one sequence");
+
+static wave_sequence _led_wave = {.steps=0, .led_bitmask=ATOMIC_INIT(0)};
+
+// Read by the PWM's EasyDMA every period, so it must live in RAM
+static nrf_pwm_values_individual_t _led_wave_seq[LED_WAVE_MAX_STEPS];
+
+// One breathing cycle in permille of on-time, on the same linear scale as LED_pwm:
+// round(1000 * (1 - cos(2 * pi * i / 64)) / 2)
+static const uint16_t _led_breathe_lut[LED_WAVE_MAX_STEPS] = {
+  0, 2, 10, 22, 38, 59, 84, 113, 146, 183, 222, 264, 309, 355, 402, 451,
+  500, 549, 598, 645, 691, 736, 778, 817, 854, 887, 916, 941, 962, 978, 990, 998,
+  1000, 998, 990, 978, 962, 941, 916, 887, 854, 817, 778, 736, 691, 645, 598, 549,
+  500, 451, 402, 355, 309, 264, 222, 183, 146, 113, 84, 59, 38, 22, 10, 2,
+};
+#endif
 
 /* ----------------------------------------------------------------------------
                               Private Functions
 ---------------------------------------------------------------------------- */
 /**
  * @brief Sets the LED to the given duty cycle, doesn't halt blinking
+ *        Engine thread only
  * 
  * @param [in] led the LED to set the duty cycle of
  * @param [in] duty_cycle the duty cycle to set the LED to
@@ -81,89 +210,495 @@ K_THREAD_STACK_DEFINE(_led_blink_stack, LED_BLINK_STACK_SIZE);
  * @return Error code, < 0 on failures
  */
 static int _led_pwm_preserve_blink(led_id led, uint8_t duty_cycle) {
-  if (IS_INVALID_LED(led)) {
-    return -EINVAL;
-  }
   uint8_t clamped_duty_cycle = PWM_MAX_DUTY_CYCLE < duty_cycle ? PWM_MAX_DUTY_CYCLE : duty_cycle;
-  uint32_t pwm_step = _leds[led]->spec.period / PWM_MAX_DUTY_CYCLE;
-  // Subtract clamped duty cycle as leds are active low
-  return pwm_set_pulse_dt(&_leds[led]->spec, pwm_step * (PWM_MAX_DUTY_CYCLE - clamped_duty_cycle));
+  _leds[led].current_duty_cycle = clamped_duty_cycle;
+
+#ifdef CONFIG_PWM_NRFX
+  // While a sequence owns the PWM, static LEDs are held as constant columns of that sequence
+  if (atomic_get(&_led_wave.led_bitmask)) {
+    uint16_t value = _led_wave_value(led, LED_DUTY_TO_PERMILLE(clamped_duty_cycle));
+    for (uint8_t i = 0; i < _led_wave.steps; i++) {
+      LED_WAVE_CHANNEL(i, led) = value;
+    }
+    return 0;
+  }
+#endif
+
+  // Same mapping as the sequence values, so an LED handed between the two paths keeps its brightness
+  uint32_t pulse = LED_PERMILLE_TO_PULSE(_leds[led].spec.period, LED_DUTY_TO_PERMILLE(clamped_duty_cycle));
+  return pwm_set_pulse_dt(&_leds[led].spec, pulse);
 }
 
 /**
  * @brief Halts blinking for the given LED
+ *        Engine thread only, the engine stops ticking by itself once no LED blinks
  * 
  * @param [in] led the LED instance to halt blinking for
  */
 static void _led_halt_blink(led_id led) {
-  if (IS_INVALID_LED(led)) {
-    return;
+  atomic_clear_bit(&_led_engine.blink_bitmask, led);
+}
+
+/**
+ * @brief Posts a command to the LED engine without locking, safe from threads and ISRs
+ *        Bounded multi-producer ring: each slot's sequence equals the ring position it is
+ *        free for, producers claim a position with a CAS on head and publish the slot by
+ *        advancing its sequence, the engine releases it one lap ahead once consumed
+ * 
+ * @param [in] cmd the command to copy into the ring
+ * 
+ * @return Error code, -ENODEV before LED_init succeeded, -EAGAIN if the ring is full
+ */
+static int _led_cmd_post(const led_cmd *cmd) {
+  if (!atomic_get(&_led_engine.running)) {
+    return -ENODEV;
+  }
+
+  atomic_val_t pos = atomic_get(&_led_engine.head);
+
+  while (1) {
+    led_cmd_slot *slot = &_led_engine.ring[pos & LED_CMD_RING_MASK];
+    atomic_val_t lag = (atomic_val_t)((uintptr_t)atomic_get(&slot->sequence) - (uintptr_t)pos);
+
+    if (0 == lag) {
+      if (atomic_cas(&_led_engine.head, pos, pos + 1)) {
+        slot->cmd = *cmd;
+        atomic_set(&slot->sequence, pos + 1);
+        k_sem_give(&_led_engine.wake);
+        return 0;
+      }
+    } else if (lag < 0) {
+      // The engine hasn't consumed this slot from the previous lap yet
+      atomic_inc(&_led_engine.dropped);
+      return -EAGAIN;
+    }
+    pos = atomic_get(&_led_engine.head);
+  }
+}
+
+/**
+ * @brief Takes the next published command off the ring, engine thread only
+ * 
+ * @param [out] cmd the command taken
+ * 
+ * @return true if a command was taken
+ */
+static bool _led_cmd_take(led_cmd *cmd) {
+  led_cmd_slot *slot = &_led_engine.ring[_led_engine.tail & LED_CMD_RING_MASK];
+
+  if (atomic_get(&slot->sequence) != (atomic_val_t)(_led_engine.tail + 1)) {
+    return false;
+  }
+
+  *cmd = slot->cmd;
+  atomic_set(&slot->sequence, _led_engine.tail + LED_CMD_RING_SIZE);
+  _led_engine.tail++;
+  return true;
+}
+
+/**
+ * @brief Applies a command to the LEDs, engine thread only
+ * 
+ * @param [in] cmd the command to apply
+ */
+static void _led_cmd_run(const led_cmd *cmd) {
+  led_id led = cmd->led;
+
+  switch (cmd->op) {
+    case LED_CMD_TOGGLE:
+      _led_wave_halt(led);
+      _led_pwm_preserve_blink(led, (0 == _leds[led].current_duty_cycle) ? PWM_MAX_DUTY_CYCLE : 0);
+      break;
+
+    case LED_CMD_PWM:
+      _led_halt_blink(led);
+      _led_wave_halt(led);
+      _led_pwm_preserve_blink(led, cmd->value);
+      break;
+
+    case LED_CMD_BLINK:
+      _led_wave_halt(led);
+      _leds[led].blink.half_period = LED_COUNTER_HALF_PERIOD / cmd->value;
+      _leds[led].blink.offset = 0;
+      // Start ticking from now if nothing was blinking before
+      if (!atomic_or(&_led_engine.blink_bitmask, BIT(led))) {
+        _led_engine.next_tick = k_uptime_get();
+      }
+      break;
+
+    case LED_CMD_FADE: {
+      led_wave wave = {.type=LED_WAVE_FADE, .from=_leds[led].current_duty_cycle, .to=cmd->value};
+      if (0 == _led_wave_play(led, &wave, cmd->time_ms)) {
+        _leds[led].current_duty_cycle = wave.to;
+      }
+      break;
+    }
+
+    case LED_CMD_BREATHE: {
+      led_wave wave = {.type=LED_WAVE_BREATHE, .repeat=true};
+      _led_wave_play(led, &wave, cmd->time_ms);
+      break;
+    }
+
+    case LED_CMD_PATTERN: {
+      led_wave wave = {.type=LED_WAVE_PATTERN, .pattern=cmd->pattern, .length=cmd->length, .repeat=cmd->repeat};
+      uint32_t duration_ms = (uint32_t)cmd->time_ms * cmd->length;
+      if (0 == _led_wave_play(led, &wave, duration_ms) && !cmd->repeat) {
+        _leds[led].current_duty_cycle = cmd->pattern[cmd->length - 1];
+      }
+      break;
+    }
+
+    default:
+      break;
   }
+}
 
-  _led_blink_thread.led_bitmask &= ~BIT(led);
-  if (!_led_blink_thread.led_bitmask) {
-    k_thread_suspend(_led_blink_thread.id);
+/**
+ * @brief How long the engine may sleep for, until the next blink tick or the end of a
+ *        one-shot waveform, engine thread only
+ * 
+ * @return Timeout for the engine's wait on its semaphore
+ */
+static k_timeout_t _led_engine_timeout(void) {
+  int64_t deadline = INT64_MAX;
+
+  if (atomic_get(&_led_engine.blink_bitmask)) {
+    deadline = _led_engine.next_tick;
+  }
+#ifdef CONFIG_PWM_NRFX
+  if (_led_wave.one_shot_bitmask) {
+    deadline = MIN(deadline, _led_wave.pass_end);
   }
+#endif
+
+  return (INT64_MAX == deadline) ? K_FOREVER : K_TIMEOUT_ABS_MS(deadline);
 }
 
 /**
- * @brief Handles blinking all LEDs
+ * @brief LED engine, applies posted commands, handles blinking all LEDs and ends one-shot waveforms
+ *        Sleeps indefinitely while no LED is blinking, no one-shot waveform plays and no command is pending
  * 
  * @param [in] p1 Unused thread parameter 1
  * @param [in] p2 Unused thread parameter 2
  * @param [in] p2 Unused thread parameter 3
  */
-static void _led_blink_loop(void *p1 __attribute__((unused)), void *p2 __attribute__((unused)), void *p3 __attribute__((unused))) {
+static void _led_engine_loop(void *p1 __attribute__((unused)), void *p2 __attribute__((unused)), void *p3 __attribute__((unused))) {
   uint16_t min_half_period = LED_COUNTER_HALF_PERIOD / LED_16HZ;
+  led_cmd cmd;
 
   while (1) {
-    k_msleep(min_half_period / LED_COUNTER_UNIT);
+    k_sem_take(&_led_engine.wake, _led_engine_timeout());
+
+    _led_wave_poll();
+
+    DRV_TRACE_BEGIN("led_cmds", 0);
+    while (_led_cmd_take(&cmd)) {
+      _led_cmd_run(&cmd);
+    }
+    DRV_TRACE_END("led_cmds", 0);
+
+    atomic_val_t blink_bitmask = atomic_get(&_led_engine.blink_bitmask);
+    if (!blink_bitmask || k_uptime_get() < _led_engine.next_tick) {
+      continue;
+    }
+    _led_engine.next_tick += min_half_period / LED_COUNTER_UNIT;
+
+    DRV_TRACE_BEGIN("led_blink", blink_bitmask);
 
     for (int i = 0; i < NUM_LEDS; i++) {
-      if (_led_blink_thread.led_bitmask & BIT(i)) {
-        _leds[i]->blink.offset += min_half_period;
-        if (_leds[i]->blink.offset >= _leds[i]->blink.half_period){
-          _leds[i]->blink.offset = 0;
-          LED_toggle(i);
+      if (blink_bitmask & BIT(i)) {
+        _leds[i].blink.offset += min_half_period;
+        if (_leds[i].blink.offset >= _leds[i].blink.half_period){
+          _leds[i].blink.offset = 0;
+          _led_pwm_preserve_blink(i, (0 == _leds[i].current_duty_cycle) ? PWM_MAX_DUTY_CYCLE : 0);
         }
       }
     }
+    DRV_TRACE_END("led_blink", blink_bitmask);
+  }
+}
+
+#ifdef CONFIG_PWM_NRFX
+/**
+ * @brief Converts a brightness into the raw sequence value for an LED's channel
+ * 
+ * @param [in] led the LED the value is for
+ * @param [in] permille the fraction of each period the LED should be lit, 0 - 1000
+ * 
+ * @return Compare value with polarity bit, as read by the PWM decoder
+ */
+static uint16_t _led_wave_value(led_id led, uint16_t permille) {
+  uint16_t compare = LED_PERMILLE_TO_PULSE(LED_WAVE_PWM->COUNTERTOP, permille);
+
+  if (_leds[led].spec.flags & PWM_POLARITY_INVERTED) {
+    return compare;
+  }
+  return compare | LED_WAVE_POLARITY;
+}
+
+/**
+ * @brief Brightness of an animated LED at a given step of the shared sequence
+ * 
+ * @param [in] led the animated LED
+ * @param [in] step the sequence step, 0 - _led_wave.steps - 1
+ * 
+ * @return Brightness in permille
+ */
+static uint16_t _led_wave_sample(led_id led, uint8_t step) {
+  const led_wave *wave = &_leds[led].wave;
+  uint8_t steps = _led_wave.steps;
+
+  switch (wave->type) {
+    case LED_WAVE_FADE: {
+      int16_t delta = (int16_t)wave->to - (int16_t)wave->from;
+      return LED_DUTY_TO_PERMILLE(wave->from + (delta * (step + 1)) / steps);
+    }
+    case LED_WAVE_BREATHE:
+      return _led_breathe_lut[(step * LED_WAVE_MAX_STEPS) / steps];
+    case LED_WAVE_PATTERN:
+      return LED_DUTY_TO_PERMILLE(wave->pattern[(step * wave->length) / steps]);
+    default:
+      return LED_DUTY_TO_PERMILLE(_leds[led].current_duty_cycle);
+  }
+}
+
+/**
+ * @brief Fills an LED's column of the sequence buffer from its waveform
+ * 
+ * @param [in] led the LED to render
+ */
+static void _led_wave_render(led_id led) {
+  for (uint8_t i = 0; i < _led_wave.steps; i++) {
+    LED_WAVE_CHANNEL(i, led) = _led_wave_value(led, _led_wave_sample(led, i));
+  }
+}
+
+/**
+ * @brief Points the PWM at the sequence buffer and starts playback
+ *        The PWM then steps through the buffer by EasyDMA with no further CPU involvement
+ */
+static void _led_wave_start(void) {
+  NRF_PWM_Type *pwm = LED_WAVE_PWM;
+
+  nrf_pwm_decoder_set(pwm, NRF_PWM_LOAD_INDIVIDUAL, NRF_PWM_STEP_AUTO);
+  for (uint8_t seq = 0; seq < 2; seq++) {
+    nrf_pwm_seq_ptr_set(pwm, seq, (const uint16_t *)_led_wave_seq);
+    nrf_pwm_seq_cnt_set(pwm, seq, _led_wave.steps * NRF_PWM_CHANNEL_COUNT);
+    nrf_pwm_seq_refresh_set(pwm, seq, _led_wave.refresh);
+    nrf_pwm_seq_end_delay_set(pwm, seq, 0);
+  }
+
+  if (_led_wave.looping) {
+    // Play SEQ[0] then SEQ[1] and restart forever, both point at the same buffer
+    nrf_pwm_loop_set(pwm, 1);
+    nrf_pwm_shorts_set(pwm, NRF_PWM_SHORT_LOOPSDONE_SEQSTART0_MASK);
+  } else {
+    // Play SEQ[0] once then stop, the engine hands the PWM back to the Zephyr driver once it sees SEQEND0
+    nrf_pwm_loop_set(pwm, 0);
+    nrf_pwm_shorts_set(pwm, NRF_PWM_SHORT_SEQEND0_STOP_MASK);
   }
+
+  nrf_pwm_event_clear(pwm, NRF_PWM_EVENT_SEQEND0);
+  nrf_pwm_event_clear(pwm, NRF_PWM_EVENT_STOPPED);
+  nrf_pwm_task_trigger(pwm, NRF_PWM_TASK_SEQSTART0);
+}
+
+/**
+ * @brief Stops sequence playback and hands the PWM back to the Zephyr driver
+ */
+static void _led_wave_stop(void) {
+  NRF_PWM_Type *pwm = LED_WAVE_PWM;
+
+  nrf_pwm_shorts_set(pwm, 0);
+  // A one-shot sequence has already been stopped by its SEQEND0 -> STOP short
+  if (!nrf_pwm_event_check(pwm, NRF_PWM_EVENT_STOPPED)) {
+    nrf_pwm_task_trigger(pwm, NRF_PWM_TASK_STOP);
+    // Stopping takes effect at the end of the current PWM period
+    uint32_t timeout_us = 2 * (_leds[0].spec.period / NSEC_PER_USEC);
+    WAIT_FOR(nrf_pwm_event_check(pwm, NRF_PWM_EVENT_STOPPED), timeout_us, k_busy_wait(10));
+  }
+
+  _led_wave.steps = 0;
+  _led_wave.looping = false;
+  _led_wave.one_shot_bitmask = 0;
+
+  // The Zephyr driver restarts its own single-step playback once it sees the PWM stopped
+  for (int i = 0; i < NUM_LEDS; i++) {
+    _led_pwm_preserve_blink(i, _leds[i].current_duty_cycle);
+  }
+}
+#endif
+
+/**
+ * @brief Starts a waveform on the given LED using the PWM's sequence playback
+ *        All animated LEDs share the one sequence, so the most recently started effect
+ *        sets the timeline and any other running effects are resampled onto it. The
+ *        sequence loops while any of them repeats, one-shot effects are ended by the
+ *        engine after one pass, see _led_wave_poll
+ * 
+ * @param [in] led the LED to animate
+ * @param [in] wave the waveform to play
+ * @param [in] duration_ms the length of one pass of the waveform
+ * 
+ * @return Error code, < 0 on failures
+ */
+static int _led_wave_play(led_id led, const led_wave *wave, uint32_t duration_ms) {
+#ifdef CONFIG_PWM_NRFX
+  // In ns, PWM periods are usually well under a millisecond
+  uint32_t period_ns = _leds[led].spec.period;
+  uint64_t periods = (0 == period_ns) ? 0 : ((uint64_t)duration_ms * NSEC_PER_MSEC) / period_ns;
+  if (0 == periods) {
+    return -EINVAL;
+  }
+
+  // Hold each step for as many PWM periods as needed to fit the buffer
+  uint64_t periods_per_step = DIV_ROUND_UP(periods, LED_WAVE_MAX_STEPS);
+  if (periods_per_step - 1 > LED_WAVE_MAX_REFRESH) {
+    return -EINVAL;
+  }
+  uint8_t steps = periods / periods_per_step;
+  uint64_t pass_ns = (uint64_t)steps * periods_per_step * period_ns;
+
+  _led_halt_blink(led);
+  _leds[led].wave = *wave;
+
+  atomic_val_t led_bitmask = atomic_or(&_led_wave.led_bitmask, BIT(led)) | BIT(led);
+  if (wave->repeat) {
+    _led_wave.one_shot_bitmask &= ~BIT(led);
+  } else {
+    _led_wave.one_shot_bitmask |= BIT(led);
+  }
+  _led_wave.steps = steps;
+  _led_wave.refresh = periods_per_step - 1;
+  _led_wave.looping = 0 != (led_bitmask & ~_led_wave.one_shot_bitmask);
+  _led_wave.pass_end = k_uptime_get() + DIV_ROUND_UP(pass_ns, NSEC_PER_MSEC);
+
+  for (int i = 0; i < NUM_LEDS; i++) {
+    if (atomic_test_bit(&_led_wave.led_bitmask, i)) {
+      _led_wave_render(i);
+    } else {
+      // Static LEDs become constant columns of the sequence
+      _led_pwm_preserve_blink(i, _leds[i].current_duty_cycle);
+    }
+  }
+
+  _led_wave_start();
+  return 0;
+#else
+  return -ENOTSUP;
+#endif
+}
+
+/**
+ * @brief Halts any waveform playing on the given LED
+ * 
+ * @param [in] led the LED instance to halt the waveform for
+ */
+static void _led_wave_halt(led_id led) {
+#ifdef CONFIG_PWM_NRFX
+  if (!atomic_test_bit(&_led_wave.led_bitmask, led)) {
+    return;
+  }
+
+  _leds[led].wave.type = LED_WAVE_NONE;
+  _led_wave.one_shot_bitmask &= ~BIT(led);
+  if (!(atomic_and(&_led_wave.led_bitmask, ~BIT(led)) & ~BIT(led))) {
+    _led_wave_stop();
+  } else {
+    _led_pwm_preserve_blink(led, _leds[led].current_duty_cycle);
+  }
+#endif
+}
+
+/**
+ * @brief Ends the one-shot waveforms once their pass is over, engine thread only
+ *        A sequence that doesn't loop has stopped itself by then and is handed back to
+ *        the Zephyr driver, in a looping one the finished LEDs become constant columns
+ *        holding their final duty cycle while the repeating LEDs carry on
+ */
+static void _led_wave_poll(void) {
+#ifdef CONFIG_PWM_NRFX
+  uint32_t finished = _led_wave.one_shot_bitmask;
+  if (!finished) {
+    return;
+  }
+
+  int64_t now = k_uptime_get();
+  if (_led_wave.looping && now < _led_wave.pass_end) {
+    return;
+  } else if (!_led_wave.looping && !nrf_pwm_event_check(LED_WAVE_PWM, NRF_PWM_EVENT_SEQEND0)) {
+    // The PWM clock and the uptime drift apart slightly, check again on the next tick
+    _led_wave.pass_end = MAX(_led_wave.pass_end, now + 1);
+    return;
+  }
+
+  _led_wave.one_shot_bitmask = 0;
+  for (int i = 0; i < NUM_LEDS; i++) {
+    if (finished & BIT(i)) {
+      _leds[i].wave.type = LED_WAVE_NONE;
+    }
+  }
+
+  if (!(atomic_and(&_led_wave.led_bitmask, ~finished) & ~finished)) {
+    _led_wave_stop();
+    return;
+  }
+  for (int i = 0; i < NUM_LEDS; i++) {
+    if (finished & BIT(i)) {
+      _led_pwm_preserve_blink(i, _leds[i].current_duty_cycle);
+    }
+  }
+#endif
 }
 
 /* ----------------------------------------------------------------------------
                               Public Functions
 ---------------------------------------------------------------------------- */
 /**
- * @brief Inits all LEDs
+ * @brief Inits all LEDs and starts the LED engine
  * 
  * @return Error code, < 0 on failures
  */
 int LED_init() {
+  for (int i = 0; i < LED_CMD_RING_SIZE; i++) {
+    atomic_set(&_led_engine.ring[i].sequence, i);
+  }
+  k_sem_init(&_led_engine.wake, 0, 1);
+
   for (int i = 0; i < NUM_LEDS; i++) {
-    int rv = pwm_is_ready_dt(&_leds[i]->spec);
+    if (!pwm_is_ready_dt(&_leds[i].spec)) {
+      return -ENODEV;
+    }
+    // Start every LED off, this also programs the PWM period used by waveforms
+    int rv = _led_pwm_preserve_blink(i, 0);
     if (rv < 0) {
       return rv;
     }
   }
 
-  _led_blink_thread.id = k_thread_create(
-    &_led_blink_thread.thread,
-    _led_blink_stack,
-    K_THREAD_STACK_SIZEOF(_led_blink_stack),
-    _led_blink_loop,
+  _led_engine.id = k_thread_create(
+    &_led_engine.thread,
+    _led_engine_stack,
+    K_THREAD_STACK_SIZEOF(_led_engine_stack),
+    _led_engine_loop,
     NULL, NULL, NULL,
-    LED_BLINK_PRIORITY,
+    LED_ENGINE_PRIORITY,
     0,
     K_NO_WAIT
   );
-  k_thread_suspend(_led_blink_thread.id);
+  k_thread_name_set(_led_engine.id, "led_engine");
+
+  // The ring and the semaphore are set up, LED_* calls may post from here on
+  atomic_set(&_led_engine.running, 1);
   
   return 0;
 }
 
 /**
  * @brief Toggle specified LED
+ *        Like every LED command, this is applied asynchronously by the LED engine
+ *        and may be called from any thread or ISR
  * 
  * @param [in] led The LED instance to toggle
  * 
@@ -172,14 +707,10 @@ int LED_init() {
 int LED_toggle(led_id led) {
   if (IS_INVALID_LED(led)) {
     return -EINVAL;
-  } else {
-    if (0 == _leds[led]->current_duty_cycle) {
-      _leds[led]->current_duty_cycle = PWM_MAX_DUTY_CYCLE;
-    } else {
-      _leds[led]->current_duty_cycle = 0;
-    }
-    return _led_pwm_preserve_blink(led, _leds[led]->current_duty_cycle);
   }
+
+  led_cmd cmd = {.op=LED_CMD_TOGGLE, .led=led};
+  return _led_cmd_post(&cmd);
 }
 
 /**
@@ -191,14 +722,7 @@ int LED_toggle(led_id led) {
  * @return Error code, < 0 on failures
  */
 int LED_set(led_id led, led_state new_state) {
-  if (IS_INVALID_LED(led)) {
-    return -EINVAL;
-  }
-
-  _led_halt_blink(led);
-
-  _leds[led]->current_duty_cycle = (0 == new_state) ? 0 : PWM_MAX_DUTY_CYCLE;
-  return LED_pwm(led, _leds[led]->current_duty_cycle);
+  return LED_pwm(led, (0 == new_state) ? 0 : PWM_MAX_DUTY_CYCLE);
 }
 
 /**
@@ -214,9 +738,8 @@ int LED_pwm(led_id led, uint8_t duty_cycle) {
     return -EINVAL;
   }
 
-  _led_halt_blink(led);
-
-  return _led_pwm_preserve_blink(led, duty_cycle);
+  led_cmd cmd = {.op=LED_CMD_PWM, .led=led, .value=duty_cycle};
+  return _led_cmd_post(&cmd);
 }
 
 /**
@@ -232,12 +755,99 @@ void LED_blink(led_id led, led_frequency frequency) {
     return;
   }
 
-  _leds[led]->blink.half_period = LED_COUNTER_HALF_PERIOD / frequency;
-  _leds[led]->blink.offset = 0;
+  led_cmd cmd = {.op=LED_CMD_BLINK, .led=led, .value=frequency};
+  _led_cmd_post(&cmd);
+}
 
-  if (!_led_blink_thread.led_bitmask) {
-    k_thread_resume(_led_blink_thread.id);
+/**
+ * @brief Fades the given LED from its current duty cycle to a new one
+ *        Played by the PWM peripheral, the LED holds the target once the fade completes
+ * 
+ * @param [in] led The LED instance to fade
+ * @param [in] duty_cycle The duty cycle to fade to, expects 0 - 100 only
+ * @param [in] duration_ms How long the fade takes, at least one PWM period
+ * 
+ * @return Error code, < 0 on failures
+ */
+int LED_fade(led_id led, uint8_t duty_cycle, uint16_t duration_ms) {
+  if (!IS_ENABLED(CONFIG_PWM_NRFX)) {
+    return -ENOTSUP;
+  } else if (IS_INVALID_LED(led)) {
+    return -EINVAL;
   }
 
-  _led_blink_thread.led_bitmask |= BIT(led);
+  led_cmd cmd = {
+    .op=LED_CMD_FADE,
+    .led=led,
+    .value=PWM_MAX_DUTY_CYCLE < duty_cycle ? PWM_MAX_DUTY_CYCLE : duty_cycle,
+    .time_ms=duration_ms,
+  };
+  return _led_cmd_post(&cmd);
+}
+
+/**
+ * @brief Smoothly pulses the given LED between off and fully on until told otherwise
+ * 
+ * @param [in] led The LED instance to breathe
+ * @param [in] period_ms The length of one off-on-off cycle
+ * 
+ * @return Error code, < 0 on failures
+ */
+int LED_breathe(led_id led, uint16_t period_ms) {
+  if (!IS_ENABLED(CONFIG_PWM_NRFX)) {
+    return -ENOTSUP;
+  } else if (IS_INVALID_LED(led)) {
+    return -EINVAL;
+  }
+
+  led_cmd cmd = {.op=LED_CMD_BREATHE, .led=led, .time_ms=period_ms};
+  return _led_cmd_post(&cmd);
+}
+
+/**
+ * @brief Plays a sequence of duty cycles on the given LED, each held for step_ms
+ *        The pattern is resampled into the PWM sequence buffer by the LED engine, so
+ *        duty_cycles must stay valid until then, pass a static or const table
+ * 
+ * @param [in] led The LED instance to play the pattern on
+ * @param [in] duty_cycles The duty cycles to step through, expects 0 - 100 only
+ * @param [in] length The number of entries in duty_cycles
+ * @param [in] step_ms How long each entry is held for
+ * @param [in] repeat true to loop the pattern until told otherwise
+ * 
+ * @return Error code, < 0 on failures
+ */
+int LED_pattern(led_id led, const uint8_t *duty_cycles, uint8_t length, uint16_t step_ms, bool repeat) {
+  if (!IS_ENABLED(CONFIG_PWM_NRFX)) {
+    return -ENOTSUP;
+  } else if (IS_INVALID_LED(led)) {
+    return -EINVAL;
+  } else if (NULL == duty_cycles || 0 == length) {
+    return -EINVAL;
+  }
+
+  for (uint8_t i = 0; i < length; i++) {
+    if (duty_cycles[i] > PWM_MAX_DUTY_CYCLE) {
+      return -EINVAL;
+    }
+  }
+
+  led_cmd cmd = {
+    .op=LED_CMD_PATTERN,
+    .led=led,
+    .length=length,
+    .time_ms=step_ms,
+    .repeat=repeat,
+    .pattern=duty_cycles,
+  };
+  return _led_cmd_post(&cmd);
+}
+
+/**
+ * @brief Number of LED commands dropped because the LED engine fell behind
+ * 
+ * @return Dropped command count since boot
+ */
+uint32_t LED_dropped_commands() {
+  return (uint32_t)atomic_get(&_led_engine.dropped);
 }
@@ -0,0 +1,38 @@
+/*
+Header to define driver trace points
+*/
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "stdint.h"
+
+#ifdef CONFIG_TRACING
+#include <zephyr/tracing/tracing.h>
+#endif
+
+/* ----------------------------------------------------------------------------
+                                  Constants
+---------------------------------------------------------------------------- */
+// Phase passed as the first argument of every trace point, scripts/trace_analyze.py pairs a BEGIN
+// with the next END of the same name on the same thread
+#define TRACE_PHASE_BEGIN 0
+#define TRACE_PHASE_END   1
+
+/* ----------------------------------------------------------------------------
+                                Macro Helpers
+---------------------------------------------------------------------------- */
+// One CTF named event (names are cut to 20 characters), only use it behind a CONFIG_*_TRACE check
+#define TRACE_NAMED_EVENT(name, phase, arg) sys_trace_named_event((name), (phase), (uint32_t)(arg))
+
+// Driver hot path trace points. arg is any 32-bit value worth seeing next to the span. Without
+// CONFIG_DRIVERS_TRACE these expand to nothing and arg isn't evaluated
+#ifdef CONFIG_DRIVERS_TRACE
+#define DRV_TRACE_BEGIN(name, arg) TRACE_NAMED_EVENT(name, TRACE_PHASE_BEGIN, arg)
+#define DRV_TRACE_END(name, arg)   TRACE_NAMED_EVENT(name, TRACE_PHASE_END, arg)
+#else
+#define DRV_TRACE_BEGIN(name, arg) do { } while (0)
+#define DRV_TRACE_END(name, arg)   do { } while (0)
+#endif
+
+#endif
@@ -2,15 +2,25 @@
 Constants & Configuration
 '''
 
-import psutil
-import pynvml
+import os
+import sys
 import struct
-import bleak
 import time
+import random
 import asyncio
-import mmap
-import platform
-import cpuinfo
+import argparse
+import threading
+import queue
+import signal
+import logging
+import statistics
+from dataclasses import dataclass
+from collections import OrderedDict
+import sensor_providers
+import transports
+import metric_log
+
+log = logging.getLogger("gatt_client")
 
 TARGET_DEVICE_NAME = "EiE 6248 Hardware Monitor" # Match the Zephyr config
 
@@ -22,212 +32,124 @@ CHAR_UUID_PERCENT = "01928374-1234-5678-1234-56789abcdef3"
 CHAR_UUID_SYSTEM_DETAILS = "01928374-1234-5678-1234-56789abcdef4"
 CHAR_UUID_CPU_DETAILS = "01928374-1234-5678-1234-56789abcdef5"
 CHAR_UUID_GPU_DETAILS = "01928374-1234-5678-1234-56789abcdef6"
-
-# Define the shared memory name to obtain motherboard sensor data from HWiNFO64
-shm_name = "Global\\HWiNFO_SENS_SM2"
-shm_size = 1024*1024 # 1 MB is safely large enough to capture the header and all sensor readings.
-
-# Initialize pynvml and grab the handle for the primary GPU which we want to read (GPU0)
-pynvml.nvmlInit()
-gpu_handle = pynvml.nvmlDeviceGetHandleByIndex(0)
-
-# Global variables to keep track of network download and upload activity (since starting this script, NOT since computer boot-up)
-last_net_bytes_recv = psutil.net_io_counters().bytes_recv
-last_net_bytes_sent = psutil.net_io_counters().bytes_sent 
-last_net_time = time.time()
+CHAR_UUID_PER_CORE = "01928374-1234-5678-1234-56789abcdef7"
+CHAR_UUID_PROCESS_LIST = "01928374-1234-5678-1234-56789abcdef8"
+CHAR_UUID_TELEMETRY = "01928374-1234-5678-1234-56789abcdef9"
+
+# Fastest metric update rate (used while values are changing quickly), the device can comfortably take 10+ Hz
+DEFAULT_RATE_HZ = 10
+
+# How often metrics are sampled and checked while values are stable
+DEFAULT_CALM_RATE_HZ = 1
+
+# Every metric group is re-sent at least this often even when unchanged, so the device can tell suppression from a dead link
+DEFAULT_HEARTBEAT_S = 2
+
+# A group is only sent early when at least one of its fields moved more than its deadband since it was last sent
+# scalar: CPU clock (MHz), CPU power (W), CPU temp (°C), GPU temp (°C)
+# network: download, upload (Kb/s)
+# percent: CPU, GPU, RAM usage (%)
+DEADBANDS = {
+    "scalar": (50, 2, 1, 1),
+    "network": (50, 50),
+    "percent": (2, 2, 1),
+}
+
+# Switch to the fast rate when any field changes by more than this many deadbands per second
+BURST_THRESHOLD = 4
+
+# Drop back to the calm rate after this long without a fast change
+BURST_HOLD_S = 3
+
+# Snapshots older than this many send periods are skipped rather than sent late
+STALE_PERIODS = 2
+
+# The sampler only ever needs to be a snapshot or two ahead of the transmitter
+SNAPSHOT_QUEUE_SIZE = 2
+
+# How often jitter/throughput statistics are printed
+STATS_INTERVAL_S = 10
+
+# Header of each per-core chunk, see per_core_chunk_header_t in ble_peripheral.h
+PER_CORE_HEADER = struct.Struct("<BBBB")
+
+# Per-core frames are much larger than the other groups (3 bytes per core), so they go out at a slower fixed rate
+PER_CORE_PERIOD_S = 1
+PER_CORE_MAX_CORES = 128 # Matches BLE_PER_CORE_MAX_CORES on the device
+
+# Top process list, see process_list.h. Names are sent once into a table on the device and then referred to by slot,
+# the table size and name length must match PROCESS_NAME_SLOTS and PROCESS_NAME_MAX_LENGTH
+PROCESS_PERIOD_S = 2
+PROCESS_TOP_N = 8
+PROCESS_NAME_SLOTS = 32
+PROCESS_NAME_MAX_LENGTH = 23
+PROCESS_MSG_DEFINE_NAME = 0x01
+PROCESS_MSG_TOP_LIST = 0x02
+
+# Device diagnostics (--telemetry), see diagnostics.h: a header, then one entry per thread with its name, CPU share and stack use
+TELEMETRY_HEADER = struct.Struct("<BBHIIIII")
+TELEMETRY_THREAD = struct.Struct("<12sHHH")
+TELEMETRY_VERSION = 1
+
+# Characteristic for each metric group
+GROUP_CHAR_UUIDS = {
+    "scalar": CHAR_UUID_SCALAR,
+    "network": CHAR_UUID_NETWORK,
+    "percent": CHAR_UUID_PERCENT,
+}
+
+# Reconnect backoff: the first retry is immediate, later ones double up to the cap, with jitter so retries don't phase-lock
+# with the device's advertising or with other hosts
+RECONNECT_INITIAL_S = 0.25
+RECONNECT_MAX_S = 30
+
+# After an outage this long the device has most likely been power cycled and lost the detail strings, so they are re-sent
+DETAILS_REFRESH_S = 60
+
+# The address of the last device we connected to, so later starts can skip scanning
+ADDRESS_CACHE_PATH = os.path.join(os.path.dirname(os.path.abspath(__file__)), ".device_address")
+
+# Ingest rate sweep (--sweep): each rate is held this long, and a step passes when this share of its slots got sent
+SWEEP_STEP_S = 10
+SWEEP_MIN_DELIVERY = 0.95
+
+# The sensor provider is picked in main (see sensor_providers.py), it is only ever used from the sampler thread
+sensor_provider = None
 
 '''
 Hardware Acquisition Functions
 '''
 
-def read_hwinfo_shared_memory():
-    # fileno is -1 for Windows named shared memory.
-    try:
-        shared_memory = mmap.mmap(-1, shm_size, shm_name, mmap.ACCESS_READ)
-    except:
-        print("\nError: HWiNFO shared memory not found.")
-        print("Please ensure HWiNFO64 is running and 'Shared Memory Support' is enabled.")
-        return None, None, None # Return three values as typically we'd return CPU clock, temperature and CPU package power
-    
-    # Parse the SM2 (shared memory) header
-    # L = 32-bit unsigned int, Q = 64-bit unsigned int
-    # We need to parse this header as it contains details of which exact bytes in this shared memory bytestream represent the sensor data we want
-
-    # The header has the following format due to the C++ definition of the HWiNFO64 shared memory block as follows:
-    '''
-    typedef struct _HWiNFO_SENSORS_SHARED_MEM2 {
-        DWORD  dwSignature;             // Magic number to verify HWiNFO
-        DWORD  dwVersion;               // Shared memory version
-        DWORD  dwRevision;              // Shared memory revision
-        __int64 poll_time;              // Timestamp of the last sensor poll
-        DWORD  dwOffsetOfSensorSection; // Memory offset where sensor names start
-        DWORD  dwSizeOfSensorElement;   // Size in bytes of one sensor element
-        DWORD  dwNumSensorElements;     // Total number of sensors
-        DWORD  dwOffsetOfReadingSection;// Memory offset where actual sensor information starts
-        DWORD  dwSizeOfReadingElement;  // Size in bytes of one reading element struct
-        DWORD  dwNumReadingElements;    // Total number of sensors with values to read
-    } HWiNFO_SENSORS_SHARED_MEM2;
-    '''
-
-    header_format = "<LLLQLLLLLL"
-    header_size = struct.calcsize(header_format)
-    
-    shared_memory.seek(0) # Point to the start of the shared memory
-    header_data = shared_memory.read(header_size) # Read the entire SM2 header
-    if len(header_data) < header_size:
-        return None, None, None # We may have read the wrong shared memory block somehow if we get here
-    
-    # Unpack the raw memory bytestream into distinct sections
-    (signature, version, revision, poll_time, 
-     offset_sensors, size_sensor, num_sensors, 
-     offset_readings, size_reading, num_readings) = struct.unpack(header_format, header_data)
-    
-    # Validate that we're reading proper HWiNFO data
-    if signature == 0x0:
-        print("Cannot read HWiNFO shared memory region as it is empty.\n")
-        return None, None, None
-    
-    # Define the Reading Element struct which is the struct WITHIN the shared memory block that contains our actual sensor data that we want to look through
-    # 3x uint32 (12b), 2x char[128] (256b), 1x char[16] (16b), 4x double (32b) = 316 bytes total
-    # The Reading Element struct holds information pertaining to each sensor and is defined as follows in C++, hence the following formatting:
-    '''
-    typedef struct _HWiNFO_SENSORS_READING_ELEMENT {
-        SENSOR_READING_TYPE tReading; // Enum/DWORD: Type of sensor (Temp, Power, etc.)
-        DWORD dwSensorIndex;          // The index of the parent sensor block
-        DWORD dwReadingID;            // Unique ID for this specific reading
-        char szLabelOrig[128];        // Original label string (e.g., "CPU Package")
-        char szLabelUser[128];        // Custom label if renamed by the user
-        char szUnit[16];              // Unit string (e.g., "°C", "W", "RPM")
-        double Value;                 // Current sensor value
-        double ValueMin;              // Minimum recorded value
-        double ValueMax;              // Maximum recorded value
-        double ValueAvg;              // Average recorded value
-    } HWiNFO_SENSORS_READING_ELEMENT;
-    '''
-    reading_fmt = "<III128s128s16sdddd"
-    unpack_size = struct.calcsize(reading_fmt)
-    
-    cpu_clock = 0 # Currently represents the average of all core clocks within the CPU
-    cpu_temp = 0
-    cpu_power = 0 
-
-    # To calculate average of all core clocks
-    core_clocks = []
-
-    # max_core_clock = 0
-
-    # Loop through the Reading Element struct to find our CPU temp and package power readings
-    for i in range(num_readings):
-        shared_memory.seek(offset_readings + (i * size_reading)) # Start reading from the beginning of sensor values and read each value sequentially
-        reading_data = shared_memory.read(size_reading) # Read the sensor value as a raw bytestream
-
-        # Unpack the raw bytestream into distinct values up to the size of each sensor reading (calculated with the formatting)
-        (tReading, sensor_idx, reading_id, label_orig_bytes, label_user_bytes, 
-         unit_bytes, value, val_min, val_max, val_avg) = struct.unpack(reading_fmt, reading_data[:unpack_size]) 
-        
-        # Decode the original sensor label and strip the null terminators
-        try:
-            label_orig = label_orig_bytes.decode('utf-8', errors='ignore').split('\x00')[0]
-        except:
-            continue
-
-        # Filter for CPU clock, temperature and package power
-        if tReading == 1: # If reading is from a temperature sensor
-            print(f'TEMPERATURE LABEL FOUND: [{label_orig}]')
-            if label_orig in ["CPU Package", "CPU (Tctl/Tdie)"]: # CPU Package for Intel, CPU (Tctl/Tdie) for AMD
-                cpu_temp = value
-        elif tReading == 5: # If reading is from a power draw sensor
-            print(f'POWER LABEL FOUND: [{label_orig}]')
-            if label_orig == "CPU Package Power":
-                cpu_power = value
-        elif tReading == 6: # If reading is from a core clock sensor
-            print(f'CLOCK LABEL FOUND: [{label_orig}]')
-
-            # We want to display the average of the individual core clocks that we read
-            if ("P-core" in label_orig or "E-core" in label_orig) and "Clock" in label_orig and "Effective" not in label_orig:
-                core_clocks.append(value)
-                # if value > max_core_clock:
-                #     max_core_clock = value
-
-    # Always clean up the memory map mapping
-    shared_memory.close()
-
-    for value in core_clocks:
-        cpu_clock += value
-
-    cpu_clock = cpu_clock / len(core_clocks) # Get average core clock
-    # cpu_clock = max_core_clock
-
-    return cpu_clock, cpu_temp, cpu_power
-
-
 def get_scalar_metrics():
-    # Use HWiNFO64 shared memory for CPU Clock/Temp/Power
-    # Use pynvml to get GPU Temp
-    cpu_clock, cpu_temp, cpu_power = read_hwinfo_shared_memory() # Retrieve instantaneous CPU temperature and package power
-    
-    # If CPU temp/power is None, then handle it and notify user to run HWiNFO with shared memory support
-    if (cpu_clock == None) or (cpu_temp == None) or (cpu_power == None):
-        cpu_clock = 0
-        cpu_temp = 0
-        cpu_power = 0
-        print("Failed to access HWiNFO shared memory.\n")
-
-    gpu_temp = pynvml.nvmlDeviceGetTemperature(gpu_handle, pynvml.NVML_TEMPERATURE_GPU) # Retrieve instantaneous GPU temperature
-
-    print(f'\nRetrieved scalar metrics: CPU Clock ({cpu_clock} MHz), CPU Power ({cpu_power} W), CPU Temp ({cpu_temp}°C), GPU Temp ({gpu_temp}°C)')
-    return int(cpu_clock), int(cpu_power), int(cpu_temp), int(gpu_temp)
+    cpu_clock, cpu_power, cpu_temp, gpu_temp = sensor_provider.scalar()
+    log.debug('Retrieved scalar metrics: CPU Clock (%s MHz), CPU Power (%s W), CPU Temp (%s°C), GPU Temp (%s°C)', cpu_clock, cpu_power, cpu_temp, gpu_temp)
+    return cpu_clock, cpu_power, cpu_temp, gpu_temp
 
 def get_network_metrics():
-    # Use psutil.net_io_counters() to get bytes sent/recv
-    # Convert to bits
-    global last_net_bytes_recv
-    global last_net_bytes_sent
-    global last_net_time
-
-    current_time = time.time()
-    time_since_last = current_time - last_net_time
-
-    current_bytes_recv_since_last = psutil.net_io_counters().bytes_recv - last_net_bytes_recv
-    current_bytes_sent_since_last = psutil.net_io_counters().bytes_sent - last_net_bytes_sent
-    
-    # The current time and bytes will be the last time and bytes in the next iteration
-    last_net_bytes_recv = psutil.net_io_counters().bytes_recv
-    last_net_bytes_sent = psutil.net_io_counters().bytes_sent
-    last_net_time = current_time
-
-    down_bits = (current_bytes_recv_since_last / time_since_last) / (1e3) # Get average download network activity in Kb/s since last iteration
-    up_bits = (current_bytes_sent_since_last / time_since_last) / (1e3) # Get average upload network activity in Kb/s since last iteration
-
-    print(f'Retrieved network metrics: Network Download ({down_bits} Kb/s), Network Upload ({up_bits} Kb/s)')
-    return int(down_bits), int(up_bits)
+    down_bits, up_bits = sensor_provider.network()
+    log.debug('Retrieved network metrics: Network Download (%s Kb/s), Network Upload (%s Kb/s)', down_bits, up_bits)
+    return down_bits, up_bits
 
 def get_percentage_metrics():
-    # Use psutil for CPU % and RAM usage (convert bytes to GB)
-    # Use pynvml for GPU %
-    cpu_percent = psutil.cpu_percent(interval=None) # Retrieve instantaneous CPU usage percentage
-    
-    try:
-        gpu_util = pynvml.nvmlDeviceGetUtilizationRates(gpu_handle) # Retrieve instantaneous GPU usage percentage
-        gpu_percent = gpu_util.gpu
-    except(pynvml.NVMLError):
-        gpu_percent = 0
-
-    ram_usage_percent = psutil.virtual_memory().percent # Retrieve instantaneous RAM usage in percent
-
-    print(f'Received percentage metrics: CPU Percent ({cpu_percent}%), GPU Percent ({gpu_percent}%), RAM Percent ({ram_usage_percent}%)')
-    return int(cpu_percent), int(gpu_percent), int(ram_usage_percent)
+    cpu_percent, gpu_percent, ram_usage_percent = sensor_provider.percent()
+    log.debug('Retrieved percentage metrics: CPU Percent (%s%%), GPU Percent (%s%%), RAM Percent (%s%%)', cpu_percent, gpu_percent, ram_usage_percent)
+    return cpu_percent, gpu_percent, ram_usage_percent
+
+def get_per_core_metrics():
+    usages, clocks = sensor_provider.per_core()
+    if usages and log.isEnabledFor(logging.DEBUG):
+        log.debug('Retrieved per-core metrics: %d cores, busiest %d%%, fastest %d MHz', len(usages), max(usages), max(clocks))
+    return usages, clocks
+
+def get_top_processes():
+    processes = sensor_provider.top_processes(PROCESS_TOP_N)
+    # These run every sample, so skip building the messages unless debug logging is on
+    if processes and log.isEnabledFor(logging.DEBUG):
+        log.debug('Retrieved top processes: %s', ", ".join(f"{name} ({cpu}%)" for name, cpu, _ in processes))
+    return processes
 
 def get_computer_details():
-    # use platform to get system name
-    # use cpuinfo to get CPU name 
-    # use pynvml to get GPU name
-
-    system_details = platform.node()
-    cpu_details = cpuinfo.get_cpu_info()['brand_raw']
-    gpu_details = pynvml.nvmlDeviceGetName(gpu_handle)
-
-    return system_details, cpu_details, gpu_details
+    return sensor_provider.details()
      
 '''
 Data Serialization (The "struct" module)
@@ -251,52 +173,659 @@ def pack_metrics_to_bytes(metric_type, data_array):
     else:
         raise ValueError("Unknown metric type")
 
+def pack_per_core_chunks(frame_id, usages, clocks, max_write_size):
+    # Splits one frame of per-core metrics into chunks that each fit in a single write.
+    # Each chunk: frame id, total cores, first core, reserved (4 x uint8), then the loads (uint8) and clocks (uint16) of its cores
+    core_count = min(len(usages), PER_CORE_MAX_CORES)
+    cores_per_chunk = (max_write_size - PER_CORE_HEADER.size) // 3
+    chunks = []
+    for first_core in range(0, core_count, cores_per_chunk):
+        last_core = min(first_core + cores_per_chunk, core_count)
+        n = last_core - first_core
+        chunks.append(PER_CORE_HEADER.pack(frame_id & 0xFF, core_count, first_core, 0)
+                      + struct.pack(f"<{n}B{n}H", *(min(usage, 100) for usage in usages[first_core:last_core]),
+                                    *(min(clock, 0xFFFF) for clock in clocks[first_core:last_core])))
+    return chunks
+
+def truncate_utf8(text, max_bytes):
+    # Cut on a character boundary so the device never receives half a multi-byte character
+    encoded = text.encode('utf-8')
+    if len(encoded) <= max_bytes:
+        return encoded
+    return encoded[:max_bytes].decode('utf-8', errors='ignore').encode('utf-8')
+
+class ProcessNameDictionary:
+    '''
+    Mirrors the device's process name table. Each name is sent once and later lists refer to it by slot id, so a steady set of
+    top processes costs 3 bytes per row. This side picks the slot to evict (the least recently listed name), and since the
+    device simply stores whatever it is told into that slot, both tables always agree. Only valid for one connection.
+    '''
+
+    def __init__(self, slots=PROCESS_NAME_SLOTS):
+        self.slots = slots
+        self.ids = OrderedDict() # name -> slot id, least recently listed first
+
+    def encode(self, processes):
+        # Returns the messages to write, in order: a definition for every name the device doesn't have, then the list
+        names = [truncate_utf8(name, PROCESS_NAME_MAX_LENGTH) for name, _, _ in processes]
+
+        # Touch the names already cached first, so none of them is evicted to make room for another name in the same list
+        for name in names:
+            if name in self.ids:
+                self.ids.move_to_end(name)
+
+        messages = []
+        for name in names:
+            if name in self.ids:
+                continue
+            if len(self.ids) < self.slots:
+                slot = len(self.ids)
+            else:
+                _, slot = self.ids.popitem(last=False)
+            self.ids[name] = slot
+            messages.append(struct.pack("<BBB", PROCESS_MSG_DEFINE_NAME, slot, len(name)) + name)
+
+        entries = b"".join(struct.pack("<BBB", self.ids[name], cpu, mem) for name, (_, cpu, mem) in zip(names, processes))
+        messages.append(struct.pack("<BB", PROCESS_MSG_TOP_LIST, len(processes)) + entries)
+        return messages
+
+'''
+Sampling Pipeline
+'''
+
+@dataclass
+class MetricSnapshot:
+    timestamp: float # time.monotonic() when sampling finished
+    values: dict # Unpacked metrics per group, used for the deadband and rate checks
+    scalar_bytes: bytes
+    network_bytes: bytes
+    percent_bytes: bytes
+
+    def group_bytes(self, group):
+        return {"scalar": self.scalar_bytes, "network": self.network_bytes, "percent": self.percent_bytes}[group]
+
+class MetricSampler(threading.Thread):
+    '''
+    Runs the blocking psutil/pynvml/HWiNFO calls on their own thread so they never stall the asyncio event loop.
+    Packed snapshots go into a small bounded queue, and when the transmitter falls behind the oldest snapshot is dropped.
+    '''
+
+    def __init__(self, period_s, recorder=None):
+        super().__init__(name="metric-sampler", daemon=True)
+        self.period_s = period_s
+        self.recorder = recorder # Optional MetricLogWriter, every snapshot is appended to it
+        self.snapshots = queue.Queue(maxsize=SNAPSHOT_QUEUE_SIZE)
+        self.stop_event = threading.Event()
+        self.dropped = 0
+
+    def run(self):
+        next_deadline = time.monotonic()
+        # Walking the process table is by far the slowest reading, so it is refreshed on its own slower period.
+        # Every snapshot carries the latest list with a sequence number, the transmitter only sends a list it hasn't sent yet
+        processes = (0, [])
+        next_processes = next_deadline
+        while not self.stop_event.is_set():
+            if time.monotonic() >= next_processes:
+                processes = (processes[0] + 1, get_top_processes())
+                next_processes = time.monotonic() + PROCESS_PERIOD_S
+
+            # Gather and pack metrics
+            values = {
+                "scalar": get_scalar_metrics(),
+                "network": get_network_metrics(),
+                "percent": get_percentage_metrics(),
+                "cores": get_per_core_metrics(),
+                "processes": processes,
+            }
+            snapshot = MetricSnapshot(
+                timestamp=0,
+                values=values,
+                scalar_bytes=pack_metrics_to_bytes("scalar", values["scalar"]),
+                network_bytes=pack_metrics_to_bytes("network", values["network"]),
+                percent_bytes=pack_metrics_to_bytes("percent", values["percent"]),
+            )
+            snapshot.timestamp = time.monotonic()
+
+            if self.recorder is not None:
+                self.recorder.write(snapshot.timestamp, snapshot.scalar_bytes, snapshot.network_bytes, snapshot.percent_bytes)
+
+            try:
+                self.snapshots.put_nowait(snapshot)
+            except queue.Full:
+                # Make room by dropping the oldest snapshot, the newest one is always the most useful
+                try:
+                    self.snapshots.get_nowait()
+                    self.dropped += 1
+                except queue.Empty:
+                    pass
+                self.snapshots.put_nowait(snapshot)
+
+            # Sample on a fixed grid rather than sleeping a fixed time after the work, which would drift
+            # (period_s is changed by the transmitter when the adaptive scheduler switches rate)
+            next_deadline += self.period_s
+            delay = next_deadline - time.monotonic()
+            if delay < 0:
+                next_deadline = time.monotonic() # Sampling took longer than a period, don't try to catch up
+                delay = 0
+            self.stop_event.wait(delay)
+
+    def latest(self):
+        # Drain the queue, keeping only the newest snapshot
+        snapshot = None
+        while True:
+            try:
+                snapshot = self.snapshots.get_nowait()
+            except queue.Empty:
+                return snapshot
+
+    def stop(self):
+        self.stop_event.set()
+
+class AdaptiveScheduler:
+    '''
+    Decides which metric groups are worth sending, and how fast the pipeline should run.
+    Stable values are only re-sent as a heartbeat at the calm rate, and a fast change switches everything to the burst rate
+    until values settle again for BURST_HOLD_S.
+    '''
+
+    def __init__(self, burst_period_s, calm_period_s, heartbeat_s, adaptive=True):
+        self.burst_period_s = burst_period_s
+        self.calm_period_s = calm_period_s
+        self.heartbeat_s = heartbeat_s
+        self.adaptive = adaptive
+
+        self.bursting = False
+        self.last_fast_change = 0
+        self.previous = None # Last snapshot observed, for the rate of change
+        self.last_sent = {} # group -> (values, time) of the last send
+
+    @property
+    def period_s(self):
+        if not self.adaptive or self.bursting:
+            return self.burst_period_s
+        return self.calm_period_s
+
+    @staticmethod
+    def deadbands_moved(group, values, reference):
+        # Largest change of any field, measured in deadbands
+        return max(abs(value - ref) / deadband for value, ref, deadband in zip(values, reference, DEADBANDS[group]))
+
+    def observe(self, snapshot):
+        # Update the rate mode from how fast values moved since the previous sample
+        if self.adaptive and self.previous is not None:
+            elapsed = snapshot.timestamp - self.previous.timestamp
+            if elapsed > 0:
+                fastest = max(self.deadbands_moved(group, snapshot.values[group], self.previous.values[group]) / elapsed
+                              for group in DEADBANDS)
+                if fastest > BURST_THRESHOLD:
+                    self.last_fast_change = snapshot.timestamp
+                    self.bursting = True
+                elif snapshot.timestamp - self.last_fast_change > BURST_HOLD_S:
+                    self.bursting = False
+        self.previous = snapshot
+
+    def groups_to_send(self, snapshot):
+        if not self.adaptive:
+            return list(DEADBANDS)
+
+        groups = []
+        for group in DEADBANDS:
+            sent = self.last_sent.get(group)
+            if (sent is None or snapshot.timestamp - sent[1] >= self.heartbeat_s
+                    or self.deadbands_moved(group, snapshot.values[group], sent[0]) >= 1):
+                groups.append(group)
+        return groups
+
+    def sent(self, group, snapshot):
+        self.last_sent[group] = (snapshot.values[group], snapshot.timestamp)
+
+    def reset(self):
+        # After a reconnect nothing counts as sent yet, so every group goes out on the first slot
+        self.bursting = False
+        self.previous = None
+        self.last_sent = {}
+
+class TransmitStats:
+    '''
+    Tracks how closely sends follow their deadlines, and how much data actually goes out.
+    '''
+
+    def __init__(self):
+        self.reset()
+
+    def reset(self):
+        self.window_start = time.monotonic()
+        self.jitter_ms = []
+        self.sent = 0
+        self.bytes_sent = 0
+        self.stale = 0
+        self.missed_deadlines = 0
+        self.groups_sent = 0
+        self.groups_suppressed = 0
+        self.burst_slots = 0
+        self.process_lists = 0
+        self.process_names = 0
+
+    def report(self, sampler):
+        elapsed = time.monotonic() - self.window_start
+        if self.jitter_ms:
+            jitter = sorted(self.jitter_ms)
+            jitter_text = (f'jitter mean {statistics.fmean(jitter):.2f} ms, '
+                           f'p99 {jitter[int(0.99 * (len(jitter) - 1))]:.2f} ms, max {jitter[-1]:.2f} ms')
+        else:
+            jitter_text = 'no scheduled sends'
+        log.info(f'[stats] {self.sent / elapsed:.2f} updates/s, {self.bytes_sent / elapsed:.0f} B/s, {jitter_text}, '
+                 f'{self.stale} stale skipped, {self.missed_deadlines} deadlines missed, {sampler.dropped if sampler else 0} samples dropped')
+        if self.groups_sent + self.groups_suppressed:
+            log.info(f'[stats] {self.groups_suppressed} of {self.groups_sent + self.groups_suppressed} group writes suppressed by deadband, '
+                     f'{self.burst_slots} burst slots')
+        if self.process_lists:
+            log.info(f'[stats] {self.process_lists} process lists sent, {self.process_names} names defined')
+        self.reset()
+
+async def send_snapshot(transport, scalar_bytes, network_bytes, percent_bytes):
+    await transport.write(CHAR_UUID_SCALAR, scalar_bytes)
+    await transport.write(CHAR_UUID_PERCENT, percent_bytes)
+    await transport.write(CHAR_UUID_NETWORK, network_bytes)
+    return len(scalar_bytes) + len(percent_bytes) + len(network_bytes)
+
+async def send_details(transport, system_details, cpu_details, gpu_details):
+    # We only want to send computer details to the server one time
+    await transport.write(CHAR_UUID_SYSTEM_DETAILS, pack_metrics_to_bytes("details", system_details))
+    await transport.write(CHAR_UUID_CPU_DETAILS, pack_metrics_to_bytes("details", cpu_details))
+    await transport.write(CHAR_UUID_GPU_DETAILS, pack_metrics_to_bytes("details", gpu_details))
+
+async def transmit_metrics(transport, sampler, scheduler):
+    '''
+    Sends the newest snapshot on a fixed-rate, deadline-based schedule.
+    Deadlines are absolute, so time spent sending never accumulates into drift. The rate itself is chosen by the scheduler,
+    and only the metric groups it selects are written.
+    '''
+    loop = asyncio.get_running_loop()
+    stats = TransmitStats()
+    period_s = scheduler.period_s
+    next_deadline = loop.time() + period_s
+    next_report = time.monotonic() + STATS_INTERVAL_S
+    per_core_frame_id = 0
+    next_per_core = 0
+    process_names = ProcessNameDictionary() # The device forgets every name on disconnect, so each connection starts empty
+    processes_sent = 0
+    session = transport.session
+
+    while True:
+        await asyncio.sleep(max(0, next_deadline - loop.time()))
+        stats.jitter_ms.append((loop.time() - next_deadline) * 1e3)
+
+        if transport.session != session:
+            # A display joined a fan-out without this loop restarting, treat it like a new connection for everyone:
+            # every group and a full per-core frame on this slot, and the current process list with all its names
+            session = transport.session
+            scheduler.reset()
+            process_names = ProcessNameDictionary()
+            processes_sent = 0
+            next_per_core = 0
+
+        snapshot = sampler.latest()
+        if snapshot is None or time.monotonic() - snapshot.timestamp > STALE_PERIODS * period_s:
+            # Nothing new (or only something old) to send, skip this slot rather than send stale data
+            stats.stale += 1
+        else:
+            scheduler.observe(snapshot)
+            groups = scheduler.groups_to_send(snapshot)
+
+            # Send to nRF52840, in the same order as always (scalar, percent, network)
+            for group in ("scalar", "percent", "network"):
+                if group in groups:
+                    data = snapshot.group_bytes(group)
+                    await transport.write(GROUP_CHAR_UUIDS[group], data)
+                    scheduler.sent(group, snapshot)
+                    stats.bytes_sent += len(data)
+                    stats.groups_sent += 1
+                else:
+                    stats.groups_suppressed += 1
+            stats.sent += 1 if groups else 0
+
+            # Per-core frames go out whole, at their own slower rate
+            usages, clocks = snapshot.values["cores"]
+            if usages and snapshot.timestamp >= next_per_core:
+                for chunk in pack_per_core_chunks(per_core_frame_id, usages, clocks, transport.max_write_size()):
+                    await transport.write(CHAR_UUID_PER_CORE, chunk)
+                    stats.bytes_sent += len(chunk)
+                per_core_frame_id += 1
+                next_per_core = snapshot.timestamp + PER_CORE_PERIOD_S
+
+            # Process lists go out once each, as new names (if any) followed by the list itself
+            processes_seq, processes = snapshot.values["processes"]
+            if processes and processes_seq != processes_sent:
+                messages = process_names.encode(processes)
+                for message in messages:
+                    await transport.write(CHAR_UUID_PROCESS_LIST, message)
+                    stats.bytes_sent += len(message)
+                processes_sent = processes_seq
+                stats.process_lists += 1
+                stats.process_names += len(messages) - 1
+
+        # Follow the scheduler's rate, the sampler switches with it so it never samples much faster than we send
+        if scheduler.period_s != period_s:
+            period_s = scheduler.period_s
+            sampler.period_s = period_s
+        stats.burst_slots += scheduler.bursting
+
+        next_deadline += period_s
+        if loop.time() > next_deadline:
+            # Sending overran one or more slots, skip them instead of bursting to catch up
+            missed = int((loop.time() - next_deadline) // period_s) + 1
+            stats.missed_deadlines += missed
+            next_deadline += missed * period_s
+
+        if time.monotonic() >= next_report:
+            stats.report(sampler)
+            transport.report()
+            next_report += STATS_INTERVAL_S
+
+async def replay_metrics(transport, reader, speed):
+    '''
+    Sends a recorded session at its original pace multiplied by speed, or back-to-back when speed is 0.
+    Records are scheduled against absolute deadlines like the live path, so the replay keeps the recorded timing.
+    '''
+    loop = asyncio.get_running_loop()
+    stats = TransmitStats()
+    start = loop.time()
+
+    for elapsed, scalar_bytes, network_bytes, percent_bytes in reader:
+        if speed > 0:
+            deadline = start + elapsed / speed
+            await asyncio.sleep(max(0, deadline - loop.time()))
+            stats.jitter_ms.append((loop.time() - deadline) * 1e3)
+
+        stats.bytes_sent += await send_snapshot(transport, scalar_bytes, network_bytes, percent_bytes)
+        stats.sent += 1
+
+    log.info(f'Replayed {len(reader)} snapshots in {loop.time() - start:.3f} s')
+    stats.report(None)
+    transport.report()
+
+async def sweep_rates(transport, rates, step_s, min_delivery):
+    '''
+    Sends complete snapshots (all three metric groups) at each rate in turn to find where the link or the device stops
+    keeping up. A slot that is already a full period late is skipped rather than sent in a burst, so every step reports the
+    share of its slots that made it out. The device prints its side of the same run ([INGEST] lines) on its console.
+    Returns True when every step delivered at least min_delivery of its slots.
+    '''
+    loop = asyncio.get_running_loop()
+    passed = True
+    counter = 0
+
+    for rate in rates:
+        period_s = 1 / rate
+        slots = max(1, int(step_s * rate))
+        sent = 0
+        late = 0
+        write_ms = []
+        start = loop.time()
+
+        try:
+            for slot in range(slots):
+                deadline = start + slot * period_s
+                await asyncio.sleep(max(0, deadline - loop.time()))
+                if loop.time() - deadline > period_s:
+                    late += 1
+                    continue
+
+                # Values change every slot, so the device redraws every update it accepts
+                counter += 1
+                write_start = loop.time()
+                await send_snapshot(transport,
+                                    pack_metrics_to_bytes("scalar", (counter % 10000, counter % 1000, counter % 100, counter % 100)),
+                                    pack_metrics_to_bytes("network", (counter, counter)),
+                                    pack_metrics_to_bytes("percent", (counter % 101, counter % 101, counter % 101)))
+                write_ms.append((loop.time() - write_start) * 1e3)
+                sent += 1
+        except (transports.BleakError, OSError) as error:
+            log.warning(f'[sweep] {rate:7.1f} Hz: write failed after {sent} snapshots ({error}), FAIL')
+            return False
+
+        elapsed = loop.time() - start
+        delivery = sent / slots
+        step_passed = delivery >= min_delivery
+        passed &= step_passed
+        write_ms.sort()
+        log.info(f'[sweep] {rate:7.1f} Hz: {sent / elapsed:7.1f} snapshots/s, {delivery:6.1%} of slots sent, {late} late, '
+                 f'write median {write_ms[len(write_ms) // 2] if write_ms else 0:.2f} ms, '
+                 f'p99 {write_ms[int(0.99 * (len(write_ms) - 1))] if write_ms else 0:.2f} ms, {"PASS" if step_passed else "FAIL"}')
+
+    transport.report()
+    return passed
+
 '''
 Asynchronous BLE Main Loop
 '''
-async def run_ble_client():
-    # Step 1: Scan for the nRF52840
-    device = await bleak.BleakScanner.find_device_by_name(TARGET_DEVICE_NAME)
-    
-    if device == None:
-        print("Device not found.")
-        return
+def parse_telemetry(data):
+    header = TELEMETRY_HEADER.unpack_from(data)
+    version, thread_count, cpu_load, uptime_ms, rx_updates, rx_rejected, rx_coalesced, render_overruns = header
+    if version != TELEMETRY_VERSION:
+        raise ValueError(f'unknown telemetry version {version}')
+
+    threads = []
+    # Notifications and short reads carry fewer entries than thread_count, only the ones present are parsed
+    available = (len(data) - TELEMETRY_HEADER.size) // TELEMETRY_THREAD.size
+    for i in range(min(thread_count, available)):
+        name, cpu, stack_size, stack_peak = TELEMETRY_THREAD.unpack_from(data, TELEMETRY_HEADER.size + i * TELEMETRY_THREAD.size)
+        threads.append({"name": name.rstrip(b"\0").decode("utf-8", errors="replace"), "cpu_percent": cpu / 10,
+                        "stack_size": stack_size, "stack_peak": stack_peak})
+
+    return {"cpu_load_percent": cpu_load / 10, "uptime_ms": uptime_ms, "rx_updates": rx_updates, "rx_rejected": rx_rejected,
+            "rx_coalesced": rx_coalesced, "render_overruns": render_overruns, "threads": threads}
+
+def encode_telemetry(cpu_load_percent, uptime_ms, rx_updates, rx_rejected, rx_coalesced, render_overruns, threads):
+    # The inverse of parse_telemetry, used by the loopback device to answer reads
+    data = TELEMETRY_HEADER.pack(TELEMETRY_VERSION, len(threads), int(cpu_load_percent * 10), uptime_ms & 0xFFFFFFFF,
+                                 rx_updates, rx_rejected, rx_coalesced, render_overruns)
+    for name, cpu_percent, stack_size, stack_peak in threads:
+        data += TELEMETRY_THREAD.pack(name.encode("utf-8")[:12], int(cpu_percent * 10), stack_size, stack_peak)
+    return data
+
+async def poll_telemetry(transport, period_s):
+    # Read the device's diagnostics every period_s and log them, the link's health is judged by the transmit loop, not this
+    while True:
+        await asyncio.sleep(period_s)
+        try:
+            telemetry = parse_telemetry(await transport.read(CHAR_UUID_TELEMETRY))
+        except NotImplementedError:
+            log.warning(f'The {transport.name} transport cannot read telemetry, not polling it')
+            return
+        except (transports.BleakError, OSError, ValueError, struct.error) as error:
+            log.warning(f'Telemetry read failed: {error}')
+            continue
+
+        log.info(f'[telemetry] CPU {telemetry["cpu_load_percent"]:.1f}%, up {telemetry["uptime_ms"] / 1000:.0f} s, '
+                 f'{telemetry["rx_updates"]} writes ({telemetry["rx_rejected"]} rejected, {telemetry["rx_coalesced"]} coalesced), '
+                 f'{telemetry["render_overruns"]} render overruns')
+        for thread in telemetry["threads"]:
+            log.info(f'[telemetry]   {thread["name"]:<12} {thread["cpu_percent"]:5.1f}%  stack {thread["stack_peak"]} / {thread["stack_size"]} B')
+
+async def stream_until_disconnected(transport, sampler, scheduler, telemetry_s=None):
+    # Run the transmit loop until the link drops, either reported by the transport or noticed as a failed write
+    transmit = asyncio.create_task(transmit_metrics(transport, sampler, scheduler))
+    link_lost = asyncio.create_task(transport.disconnected.wait())
+    telemetry = asyncio.create_task(poll_telemetry(transport, telemetry_s)) if telemetry_s else None
+    done, _ = await asyncio.wait({transmit, link_lost}, return_when=asyncio.FIRST_COMPLETED)
+
+    transmit.cancel()
+    link_lost.cancel()
+    if telemetry is not None:
+        telemetry.cancel()
+    await asyncio.gather(transmit, link_lost, *([telemetry] if telemetry else []), return_exceptions=True)
+
+    if transmit in done and not transmit.cancelled():
+        error = transmit.exception()
+        if not isinstance(error, (transports.BleakError, OSError)):
+            raise error
+        log.warning(f'Write failed, treating the link as lost: {error}')
+
+class ReconnectStats:
+    def __init__(self):
+        self.outages_s = []
+
+    def record(self, outage_s):
+        self.outages_s.append(outage_s)
+        log.info(f'[reconnect] link restored after {outage_s:.2f} s ({len(self.outages_s)} reconnects, '
+                 f'mean {statistics.fmean(self.outages_s):.2f} s, max {max(self.outages_s):.2f} s)')
+
+async def supervise(transport, scheduler, details, recorder=None, telemetry_s=None):
+    '''
+    Keeps a link to the device up for as long as the script runs. Sampling carries on through outages, so streaming resumes
+    with current data the moment the link is back.
+    '''
+    sampler = MetricSampler(scheduler.period_s, recorder)
+    sampler.start()
+
+    reconnect_stats = ReconnectStats()
+    backoff_s = 0
+    link_lost_at = None
+    details_sent_to = None # Address of the device that already has our detail strings
 
-    # Step 2: Establish Connection
-    async with bleak.BleakClient(device) as client:
-        print("Connected!")
-        system_details, cpu_details, gpu_details = get_computer_details()
-
-        # Pack details
-        system_details_bytes = pack_metrics_to_bytes("details", system_details)
-        cpu_details_bytes = pack_metrics_to_bytes("details", cpu_details)
-        gpu_details_bytes = pack_metrics_to_bytes("details", gpu_details)
-
-        # We only want to send computer details to the server one time
-        await client.write_gatt_char(CHAR_UUID_SYSTEM_DETAILS, system_details_bytes, response=False)
-        await client.write_gatt_char(CHAR_UUID_CPU_DETAILS, cpu_details_bytes, response=False)
-        await client.write_gatt_char(CHAR_UUID_GPU_DETAILS, gpu_details_bytes, response=False)
-        
-        # Step 3: The infinite transmission loop
+    try:
         while True:
-            # Gather metrics
-            scalar_data = get_scalar_metrics()
-            network_data = get_network_metrics()
-            percent_data = get_percentage_metrics()
-            
-            # Pack metrics
-            scalar_bytes = pack_metrics_to_bytes("scalar", scalar_data)
-            network_bytes = pack_metrics_to_bytes("network", network_data)
-            percent_bytes = pack_metrics_to_bytes("percent", percent_data)
-            
-            # Send to nRF52840
-            # Use Write Without Response to match Zephyr BT_GATT_CHRC_WRITE_WITHOUT_RESP
-            await client.write_gatt_char(CHAR_UUID_SCALAR, scalar_bytes, response=False)
-            await client.write_gatt_char(CHAR_UUID_PERCENT, percent_bytes, response=False)
-            await client.write_gatt_char(CHAR_UUID_NETWORK, network_bytes, response=False)
-            
-            # Send the metrics every 2 seconds so we don't overwhelm the BLE connection
-            await asyncio.sleep(2)
+            # Step 1 & 2: Connect to the nRF52840 (or the loopback stand-in)
+            if not await transport.connect():
+                delay = backoff_s / 2 + random.uniform(0, backoff_s / 2)
+                backoff_s = min(max(backoff_s * 2, RECONNECT_INITIAL_S), RECONNECT_MAX_S)
+                log.info(f'Retrying in {delay:.2f} s')
+                await asyncio.sleep(delay)
+                continue
+            backoff_s = 0
+
+            outage_s = 0
+            if link_lost_at is not None:
+                outage_s = time.monotonic() - link_lost_at
+                reconnect_stats.record(outage_s)
+
+            # The device keeps the detail strings across reconnects, they only need sending to a new (or rebooted) device
+            address = getattr(transport, "address", None)
+            if details_sent_to != address or outage_s > DETAILS_REFRESH_S or link_lost_at is None:
+                await send_details(transport, *details)
+                details_sent_to = address
+
+            # Step 3: Transmit on a fixed schedule until the link drops
+            scheduler.reset()
+            await stream_until_disconnected(transport, sampler, scheduler, telemetry_s)
+            link_lost_at = time.monotonic()
+            await transport.close()
+    finally:
+        sampler.stop()
+        if recorder is not None:
+            sampler.join()
+            recorder.close()
+        await transport.close()
+
+async def run_client(transport, scheduler, record_path=None, replay_path=None, speed=1.0, sweep=None, telemetry_s=None):
+    if sweep:
+        # Sweeps send synthetic values, nothing is sampled
+        if not await transport.connect():
+            return False
+        try:
+            return await sweep_rates(transport, sweep, SWEEP_STEP_S, SWEEP_MIN_DELIVERY)
+        finally:
+            await transport.close()
+
+    if replay_path:
+        # Replays are one-shot benchmarks, they don't reconnect
+        reader = metric_log.MetricLogReader(replay_path) # Load the recording before connecting, so a bad file fails fast
+        if not await transport.connect():
+            return
+        try:
+            await send_details(transport, *reader.details)
+            await replay_metrics(transport, reader, speed)
+        finally:
+            await transport.close()
+        return
+
+    details = get_computer_details()
+    recorder = metric_log.MetricLogWriter(record_path, details) if record_path else None
+    await supervise(transport, scheduler, details, recorder, telemetry_s)
+
+def loopback_telemetry(transport):
+    # What the device would report, built from the loopback's own counters and this process's CPU time
+    elapsed = time.perf_counter() - transport.start
+    cpu_percent = min(100 * time.process_time() / max(elapsed, 1e-3), 100)
+    return encode_telemetry(cpu_percent, int(elapsed * 1000), transport.writes - transport.rejected, transport.rejected, 0, 0,
+                            [("loopback", cpu_percent, 0, 0)])
+
+def create_transport(name):
+    if name == "loopback":
+        # The loopback device checks writes against the same payload layouts the firmware uses
+        return transports.LoopbackTransport({
+            CHAR_UUID_SCALAR: "<IIII",
+            CHAR_UUID_NETWORK: "<II",
+            CHAR_UUID_PERCENT: "<III",
+            CHAR_UUID_SYSTEM_DETAILS: None,
+            CHAR_UUID_CPU_DETAILS: None,
+            CHAR_UUID_GPU_DETAILS: None,
+            CHAR_UUID_PER_CORE: "per_core",
+            CHAR_UUID_PROCESS_LIST: "process_list",
+        }, readers={CHAR_UUID_TELEMETRY: loopback_telemetry})
+    if name == "multi":
+        return transports.FanOutTransport(
+            TARGET_DEVICE_NAME, CHAR_UUID_SERVICE,
+            coalesce_uuids=GROUP_CHAR_UUIDS.values(),
+            reliable_uuids=[CHAR_UUID_PROCESS_LIST],
+            sticky_uuids=[CHAR_UUID_SYSTEM_DETAILS, CHAR_UUID_CPU_DETAILS, CHAR_UUID_GPU_DETAILS],
+            reconnect_initial_s=RECONNECT_INITIAL_S, reconnect_max_s=RECONNECT_MAX_S)
+    if name == "broadcast":
+        return transports.BroadcastTransport({
+            CHAR_UUID_SCALAR: ("scalar", "<IIII"),
+            CHAR_UUID_NETWORK: ("network", "<II"),
+            CHAR_UUID_PERCENT: ("percent", "<III"),
+        })
+    return transports.BleakTransport(TARGET_DEVICE_NAME, CHAR_UUID_SERVICE, ADDRESS_CACHE_PATH)
+
+def configure_logging(level, module_levels):
+    logging.basicConfig(level=level, format="%(asctime)s.%(msecs)03d %(levelname).1s %(name)s: %(message)s", datefmt="%H:%M:%S")
+    for module_level in module_levels:
+        name, _, module_level = module_level.partition("=")
+        logging.getLogger(name).setLevel(module_level.upper())
+
+    # SIGUSR1 flips debug logging on and off without restarting, e.g. "kill -USR1 <pid>" (not available on Windows)
+    if hasattr(signal, "SIGUSR1"):
+        root = logging.getLogger()
+        def toggle_debug(signum, frame):
+            root.setLevel(level if root.level == logging.DEBUG else logging.DEBUG)
+            log.warning(f'Logging at {logging.getLevelName(root.level)}')
+        signal.signal(signal.SIGUSR1, toggle_debug)
 
 if __name__ == "__main__":
-    asyncio.run(run_ble_client())
\ No newline at end of file
+    parser = argparse.ArgumentParser(description="Stream PC hardware metrics to the EiE hardware monitor over BLE")
+    parser.add_argument("--rate", type=float, default=DEFAULT_RATE_HZ, help="metric updates per second while values change quickly (default: %(default)s)")
+    parser.add_argument("--calm-rate", type=float, default=DEFAULT_CALM_RATE_HZ, help="metric checks per second while values are stable (default: %(default)s)")
+    parser.add_argument("--heartbeat", type=float, default=DEFAULT_HEARTBEAT_S, help="longest time between writes of an unchanged metric group, in seconds (default: %(default)s)")
+    parser.add_argument("--no-adapt", action="store_true", help="send every metric group at --rate, without deadbands or rate changes")
+    parser.add_argument("--provider", choices=["auto", *sensor_providers.PROVIDERS], default="auto", help="where to read sensors from (default: %(default)s)")
+    parser.add_argument("--benchmark", type=int, metavar="N", help="time N samples with each available provider and exit")
+    parser.add_argument("--transport", choices=["ble", "multi", "broadcast", "loopback"], default="ble", help="send to the device, connect to every device in range, advertise to any number of devices, or send to an in-process fake device (default: %(default)s)")
+    parser.add_argument("--record", metavar="PATH", help="also record every sampled snapshot to a metric log")
+    parser.add_argument("--replay", metavar="PATH", help="send a recorded metric log instead of sampling this machine")
+    parser.add_argument("--speed", type=float, default=1.0, help="replay speed multiplier, 0 replays as fast as possible (default: %(default)s)")
+    parser.add_argument("--sweep", type=lambda text: [float(rate) for rate in text.split(",")], metavar="RATES",
+                        help=f"send synthetic snapshots at each comma-separated rate (Hz) for {SWEEP_STEP_S} s, exit non-zero if any rate "
+                             f"delivers under {SWEEP_MIN_DELIVERY:.0%} of its slots")
+    parser.add_argument("--log-level", type=str.upper, choices=["DEBUG", "INFO", "WARNING", "ERROR"], default="INFO",
+                        help="lowest level logged, DEBUG shows every sensor sample (default: %(default)s)")
+    parser.add_argument("--log", action="append", default=[], metavar="MODULE=LEVEL",
+                        help="level for one module (gatt_client, transports, sensor_providers, metric_log), may be repeated")
+    parser.add_argument("--telemetry", type=float, metavar="SECONDS",
+                        help="read and log the device's CPU load, thread stack use and write counters every SECONDS")
+    args = parser.parse_args()
+    configure_logging(args.log_level, args.log)
+
+    if args.benchmark:
+        sensor_providers.benchmark(args.benchmark)
+    else:
+        if not args.replay and not args.sweep:
+            sensor_provider = sensor_providers.create_provider(args.provider)
+            log.info(f'Reading sensors with the {sensor_provider.name} provider')
+        scheduler = AdaptiveScheduler(1 / args.rate, 1 / args.calm_rate, args.heartbeat, adaptive=not args.no_adapt)
+        result = asyncio.run(run_client(create_transport(args.transport), scheduler, args.record, args.replay, args.speed, args.sweep,
+                                       args.telemetry))
+        if args.sweep and not result:
+            sys.exit(1)
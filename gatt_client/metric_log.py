@@ -0,0 +1,90 @@
+'''
+Metric Logs
+
+Compact binary recordings of the metric stream, so a session captured on a loaded PC can be replayed later
+(at the original pace or faster) into any transport.
+
+Layout (all little-endian):
+    header:  magic "EIEM", version (uint8), then the system/CPU/GPU detail strings as uint8 length + UTF-8 bytes
+    records: uint32 milliseconds since recording started, then the packed scalar, network and percent payloads
+             exactly as they are sent over BLE (16 + 8 + 12 bytes), 40 bytes per record
+'''
+
+import struct
+import logging
+
+log = logging.getLogger("metric_log")
+
+LOG_MAGIC = b"EIEM"
+LOG_VERSION = 1
+
+LOG_HEADER = struct.Struct("<4sB")
+LOG_TIMESTAMP = struct.Struct("<I")
+LOG_STRING_LENGTH = struct.Struct("<B")
+
+# Payload sizes match the characteristic sizes the device accepts
+SCALAR_SIZE = 16
+NETWORK_SIZE = 8
+PERCENT_SIZE = 12
+LOG_RECORD_SIZE = LOG_TIMESTAMP.size + SCALAR_SIZE + NETWORK_SIZE + PERCENT_SIZE
+
+class MetricLogWriter:
+    def __init__(self, path, details):
+        self.file = open(path, "wb")
+        self.start = None
+        self.records = 0
+
+        self.file.write(LOG_HEADER.pack(LOG_MAGIC, LOG_VERSION))
+        for detail in details:
+            encoded = detail.encode('utf-8')[:255]
+            self.file.write(LOG_STRING_LENGTH.pack(len(encoded)) + encoded)
+
+    def write(self, timestamp, scalar_bytes, network_bytes, percent_bytes):
+        if self.start is None:
+            self.start = timestamp
+        elapsed_ms = int((timestamp - self.start) * 1e3)
+        self.file.write(LOG_TIMESTAMP.pack(elapsed_ms) + scalar_bytes + network_bytes + percent_bytes)
+        self.records += 1
+
+    def close(self):
+        self.file.close()
+        log.info(f'Recorded {self.records} metric snapshots')
+
+class MetricLogReader:
+    '''
+    Loads a whole recording into memory, logs are 40 bytes per sample so even a day at 10 Hz is only ~35 MB.
+    '''
+
+    def __init__(self, path):
+        with open(path, "rb") as file:
+            data = file.read()
+
+        magic, version = LOG_HEADER.unpack_from(data, 0)
+        if magic != LOG_MAGIC or version != LOG_VERSION:
+            raise ValueError(f'{path} is not a version {LOG_VERSION} metric log')
+
+        offset = LOG_HEADER.size
+        self.details = []
+        for _ in range(3):
+            (length,) = LOG_STRING_LENGTH.unpack_from(data, offset)
+            offset += LOG_STRING_LENGTH.size
+            self.details.append(data[offset:offset + length].decode('utf-8', errors='replace'))
+            offset += length
+
+        self.data = memoryview(data)
+        self.records_offset = offset
+        self.count = (len(data) - offset) // LOG_RECORD_SIZE
+
+    def __len__(self):
+        return self.count
+
+    def __iter__(self):
+        # Yields (seconds since recording started, scalar bytes, network bytes, percent bytes)
+        for i in range(self.count):
+            record = self.records_offset + i * LOG_RECORD_SIZE
+            (elapsed_ms,) = LOG_TIMESTAMP.unpack_from(self.data, record)
+            scalar = record + LOG_TIMESTAMP.size
+            network = scalar + SCALAR_SIZE
+            percent = network + NETWORK_SIZE
+            yield (elapsed_ms / 1e3, bytes(self.data[scalar:network]), bytes(self.data[network:percent]),
+                   bytes(self.data[percent:percent + PERCENT_SIZE]))
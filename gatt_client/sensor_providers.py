@@ -0,0 +1,721 @@
+'''
+Sensor Providers
+
+Each provider knows how to read the monitored metrics on one platform. gatt_client.py only ever talks to the
+SensorProvider interface, so adding a platform means adding a provider here and a line in create_provider().
+'''
+
+import os
+import glob
+import time
+import mmap
+import struct
+import platform
+import statistics
+import logging
+
+log = logging.getLogger("sensor_providers")
+
+# Define the shared memory name to obtain motherboard sensor data from HWiNFO64
+shm_name = "Global\\HWiNFO_SENS_SM2"
+shm_size = 1024*1024 # 1 MB is safely large enough to capture the header and all sensor readings.
+
+def load_nvml():
+    # pynvml is imported lazily so that machines without an NVIDIA GPU (or without pynvml installed) still work
+    try:
+        import pynvml
+        pynvml.nvmlInit()
+        return pynvml, pynvml.nvmlDeviceGetHandleByIndex(0) # Grab the handle for the primary GPU which we want to read (GPU0)
+    except Exception:
+        return None, None
+
+'''
+HWiNFO64 Shared Memory (Windows)
+'''
+
+# The header has the following format due to the C++ definition of the HWiNFO64 shared memory block as follows:
+'''
+typedef struct _HWiNFO_SENSORS_SHARED_MEM2 {
+    DWORD  dwSignature;             // Magic number to verify HWiNFO
+    DWORD  dwVersion;               // Shared memory version
+    DWORD  dwRevision;              // Shared memory revision
+    __int64 poll_time;              // Timestamp of the last sensor poll
+    DWORD  dwOffsetOfSensorSection; // Memory offset where sensor names start
+    DWORD  dwSizeOfSensorElement;   // Size in bytes of one sensor element
+    DWORD  dwNumSensorElements;     // Total number of sensors
+    DWORD  dwOffsetOfReadingSection;// Memory offset where actual sensor information starts
+    DWORD  dwSizeOfReadingElement;  // Size in bytes of one reading element struct
+    DWORD  dwNumReadingElements;    // Total number of sensors with values to read
+} HWiNFO_SENSORS_SHARED_MEM2;
+'''
+# L = 32-bit unsigned int, Q = 64-bit unsigned int
+HWINFO_HEADER = struct.Struct("<LLLQLLLLLL")
+
+# The Reading Element struct holds information pertaining to each sensor and is defined as follows in C++:
+'''
+typedef struct _HWiNFO_SENSORS_READING_ELEMENT {
+    SENSOR_READING_TYPE tReading; // Enum/DWORD: Type of sensor (Temp, Power, etc.)
+    DWORD dwSensorIndex;          // The index of the parent sensor block
+    DWORD dwReadingID;            // Unique ID for this specific reading
+    char szLabelOrig[128];        // Original label string (e.g., "CPU Package")
+    char szLabelUser[128];        // Custom label if renamed by the user
+    char szUnit[16];              // Unit string (e.g., "°C", "W", "RPM")
+    double Value;                 // Current sensor value
+    double ValueMin;              // Minimum recorded value
+    double ValueMax;              // Maximum recorded value
+    double ValueAvg;              // Average recorded value
+} HWiNFO_SENSORS_READING_ELEMENT;
+'''
+# We only ever need the reading type, the original label and the current value out of each element
+HWINFO_READING_TYPE = struct.Struct("<I")
+HWINFO_LABEL_OFFSET = 12 # After tReading, dwSensorIndex and dwReadingID
+HWINFO_LABEL_SIZE = 128
+HWINFO_VALUE_OFFSET = 12 + 128 + 128 + 16 # 284, Value directly follows szUnit (the format is packed)
+HWINFO_VALUE = struct.Struct("<d")
+
+# HWiNFO writes "DEAD" into dwSignature when it shuts down, our open mapping would otherwise keep serving stale values
+HWINFO_SIGNATURE_DEAD = 0x44414544
+
+# SENSOR_READING_TYPE values we care about
+HWINFO_READING_TEMP = 1
+HWINFO_READING_POWER = 5
+HWINFO_READING_CLOCK = 6
+
+class HwinfoReader:
+    '''
+    Keeps the HWiNFO shared memory mapped for the lifetime of the script and remembers where each reading we need lives,
+    so a sample is just a header check plus one 8 byte read per value straight out of the mapping (no copies, no label decoding).
+    The index is only rebuilt when HWiNFO's header changes (sensors added/removed, or HWiNFO restarted).
+    '''
+
+    def __init__(self):
+        self.shared_memory = None
+        self.view = None
+        self.index_key = None # (revision, reading offset, reading size, reading count) the index was built for
+
+        # Byte offsets of the Value doubles we read every cycle
+        self.cpu_temp_offset = None
+        self.cpu_power_offset = None
+        self.core_clock_offsets = []
+        self.core_clocks = [] # Individual core clocks as of the last read()
+
+    def open(self):
+        # fileno is -1 for Windows named shared memory.
+        try:
+            self.shared_memory = mmap.mmap(-1, shm_size, shm_name, mmap.ACCESS_READ)
+        except:
+            log.error("HWiNFO shared memory not found.")
+            log.error("Please ensure HWiNFO64 is running and 'Shared Memory Support' is enabled.")
+            return False
+
+        self.view = memoryview(self.shared_memory)
+        self.index_key = None
+        return True
+
+    def close(self):
+        if self.view is not None:
+            self.view.release()
+            self.view = None
+        if self.shared_memory is not None:
+            self.shared_memory.close()
+            self.shared_memory = None
+
+    def build_index(self, offset_readings, size_reading, num_readings):
+        # Walk every reading once to find the ones we want, this is the only time labels are decoded
+        self.cpu_temp_offset = None
+        self.cpu_power_offset = None
+        self.core_clock_offsets = []
+
+        for i in range(num_readings):
+            element = offset_readings + (i * size_reading)
+            (reading_type,) = HWINFO_READING_TYPE.unpack_from(self.view, element)
+            label_start = element + HWINFO_LABEL_OFFSET
+            label_orig = bytes(self.view[label_start:label_start + HWINFO_LABEL_SIZE]).split(b'\x00')[0].decode('utf-8', errors='ignore')
+            value_offset = element + HWINFO_VALUE_OFFSET
+
+            if reading_type == HWINFO_READING_TEMP: # If reading is from a temperature sensor
+                if label_orig in ["CPU Package", "CPU (Tctl/Tdie)"]: # CPU Package for Intel, CPU (Tctl/Tdie) for AMD
+                    self.cpu_temp_offset = value_offset
+            elif reading_type == HWINFO_READING_POWER: # If reading is from a power draw sensor
+                if label_orig == "CPU Package Power":
+                    self.cpu_power_offset = value_offset
+            elif reading_type == HWINFO_READING_CLOCK: # If reading is from a core clock sensor
+                # We want to display the average of the individual core clocks that we read
+                if ("P-core" in label_orig or "E-core" in label_orig) and "Clock" in label_orig and "Effective" not in label_orig:
+                    self.core_clock_offsets.append(value_offset)
+
+        log.info(f'Indexed HWiNFO readings: CPU temp {"found" if self.cpu_temp_offset is not None else "missing"}, '
+                 f'CPU power {"found" if self.cpu_power_offset is not None else "missing"}, {len(self.core_clock_offsets)} core clocks')
+
+    def read_value(self, offset):
+        if offset is None:
+            return 0
+        return HWINFO_VALUE.unpack_from(self.view, offset)[0]
+
+    def read(self):
+        if self.view is None and not self.open():
+            return None, None, None # Return three values as typically we'd return CPU clock, temperature and CPU package power
+
+        # Parse the SM2 (shared memory) header, it tells us which exact bytes in the mapping represent the sensor data we want
+        (signature, version, revision, poll_time,
+         offset_sensors, size_sensor, num_sensors,
+         offset_readings, size_reading, num_readings) = HWINFO_HEADER.unpack_from(self.view, 0)
+
+        # Validate that we're reading proper HWiNFO data
+        if signature == 0x0 or signature == HWINFO_SIGNATURE_DEAD:
+            log.warning("Cannot read HWiNFO shared memory region as it is empty.")
+            self.close() # HWiNFO may have been closed, re-open the mapping next time
+            return None, None, None
+
+        index_key = (revision, offset_readings, size_reading, num_readings)
+        if index_key != self.index_key:
+            self.build_index(offset_readings, size_reading, num_readings)
+            self.index_key = index_key
+
+        cpu_temp = self.read_value(self.cpu_temp_offset)
+        cpu_power = self.read_value(self.cpu_power_offset)
+
+        cpu_clock = 0 # Currently represents the average of all core clocks within the CPU
+        self.core_clocks = [self.read_value(offset) for offset in self.core_clock_offsets]
+        if self.core_clocks:
+            cpu_clock = sum(self.core_clocks) / len(self.core_clocks)
+
+        return cpu_clock, cpu_temp, cpu_power
+
+'''
+Provider Interface
+'''
+
+class SensorProvider:
+    '''
+    Every getter returns plain integers in the units the device expects, and 0 for anything the platform can't measure.
+    Getters are called from the sampler thread only, so providers may keep state between calls without locking.
+    '''
+    name = "none"
+
+    def scalar(self):
+        # CPU clock (MHz), CPU power (W), CPU temperature (°C), GPU temperature (°C)
+        return 0, 0, 0, 0
+
+    def network(self):
+        # Download and upload activity (Kb/s) since the previous call
+        return 0, 0
+
+    def percent(self):
+        # CPU, GPU and RAM usage (%)
+        return 0, 0, 0
+
+    def per_core(self):
+        # Load (%) and clock (MHz) of every logical CPU, as two equally long lists (empty when not available)
+        return [], []
+
+    def top_processes(self, count):
+        # (name, CPU %, memory %) of the count busiest processes, busiest first (empty when not available).
+        # CPU is a share of the whole machine, so it stays within 0-100 like the other percentages
+        return []
+
+    def details(self):
+        # System name, CPU name and GPU name
+        return platform.node(), platform.processor() or "Unknown CPU", "Unknown GPU"
+
+    def close(self):
+        pass
+
+def spread(values, count):
+    # Stretch per-physical-core readings over the logical CPUs (SMT siblings share a clock)
+    if not values:
+        return [0] * count
+    return [values[i * len(values) // count] for i in range(count)]
+
+class ProcessTable:
+    '''
+    Ranks processes by CPU usage with psutil. psutil.process_iter() keeps the Process objects between calls, which is what
+    lets cpu_percent() report usage since the previous call, so one table must be reused for the life of the provider.
+    '''
+
+    def __init__(self, psutil):
+        self.psutil = psutil
+        self.cpu_count = psutil.cpu_count() or 1
+
+    def top(self, count):
+        processes = []
+        for process in self.psutil.process_iter(['name', 'cpu_percent', 'memory_percent']):
+            info = process.info
+            if info['name'] and info['cpu_percent'] is not None: # None when access was denied
+                processes.append((info['name'], info['cpu_percent'] / self.cpu_count, info['memory_percent'] or 0))
+        processes.sort(key=lambda process: process[1], reverse=True)
+        return [(name, min(int(cpu), 100), min(int(mem), 100)) for name, cpu, mem in processes[:count]]
+
+def load_process_table():
+    # Process listing is optional on providers that otherwise don't need psutil
+    try:
+        import psutil
+    except ImportError:
+        return None
+    return ProcessTable(psutil)
+
+class RateCounter:
+    '''
+    Turns a monotonically increasing byte counter into an average rate since the previous sample.
+    '''
+
+    def __init__(self, value):
+        self.last_value = value
+        self.last_time = time.monotonic()
+
+    def update(self, value):
+        current_time = time.monotonic()
+        elapsed = current_time - self.last_time
+        delta = value - self.last_value
+
+        # The current time and value will be the last time and value in the next iteration
+        self.last_value = value
+        self.last_time = current_time
+
+        if elapsed <= 0 or delta < 0: # Counter reset (interface went down) or called twice in the same tick
+            return 0
+        return delta / elapsed
+
+'''
+Generic psutil Provider (any platform)
+'''
+
+class PsutilSensorProvider(SensorProvider):
+    '''
+    Portable fallback, psutil can report usage and network activity everywhere but has no portable clock/power/temperature API.
+    '''
+    name = "psutil"
+
+    def __init__(self):
+        import psutil
+        self.psutil = psutil
+        self.nvml, self.gpu_handle = load_nvml()
+
+        self.process_table = ProcessTable(psutil)
+
+        counters = psutil.net_io_counters()
+        self.recv_rate = RateCounter(counters.bytes_recv)
+        self.sent_rate = RateCounter(counters.bytes_sent)
+
+    def gpu_temp(self):
+        if self.nvml is None:
+            return 0
+        try:
+            return self.nvml.nvmlDeviceGetTemperature(self.gpu_handle, self.nvml.NVML_TEMPERATURE_GPU) # Retrieve instantaneous GPU temperature
+        except self.nvml.NVMLError:
+            return 0
+
+    def scalar(self):
+        return 0, 0, 0, int(self.gpu_temp())
+
+    def network(self):
+        # Only query psutil once per sample, each call walks every network interface
+        counters = self.psutil.net_io_counters()
+        down_bits = self.recv_rate.update(counters.bytes_recv) / (1e3) # Get average download network activity in Kb/s since last iteration
+        up_bits = self.sent_rate.update(counters.bytes_sent) / (1e3) # Get average upload network activity in Kb/s since last iteration
+        return int(down_bits), int(up_bits)
+
+    def percent(self):
+        cpu_percent = self.psutil.cpu_percent(interval=None) # Retrieve instantaneous CPU usage percentage
+
+        gpu_percent = 0
+        if self.nvml is not None:
+            try:
+                gpu_percent = self.nvml.nvmlDeviceGetUtilizationRates(self.gpu_handle).gpu # Retrieve instantaneous GPU usage percentage
+            except self.nvml.NVMLError:
+                pass
+
+        ram_usage_percent = self.psutil.virtual_memory().percent # Retrieve instantaneous RAM usage in percent
+        return int(cpu_percent), int(gpu_percent), int(ram_usage_percent)
+
+    def per_core_clocks(self, count):
+        # Most platforms only report a single, package-wide frequency through psutil
+        freqs = self.psutil.cpu_freq(percpu=True) or []
+        return spread([freq.current for freq in freqs], count)
+
+    def per_core(self):
+        usages = self.psutil.cpu_percent(interval=None, percpu=True) # psutil tracks this separately from the total above
+        clocks = self.per_core_clocks(len(usages))
+        return [int(usage) for usage in usages], [int(clock) for clock in clocks]
+
+    def top_processes(self, count):
+        return self.process_table.top(count)
+
+    def details(self):
+        import cpuinfo
+
+        system_details = platform.node()
+        cpu_details = cpuinfo.get_cpu_info()['brand_raw']
+        gpu_details = "Unknown GPU"
+        if self.nvml is not None:
+            gpu_details = self.nvml.nvmlDeviceGetName(self.gpu_handle)
+            if isinstance(gpu_details, bytes): # Older pynvml releases return bytes
+                gpu_details = gpu_details.decode('utf-8', errors='ignore')
+        return system_details, cpu_details, gpu_details
+
+'''
+Windows Provider (HWiNFO64 + NVML + psutil)
+'''
+
+class WindowsSensorProvider(PsutilSensorProvider):
+    name = "windows"
+
+    def __init__(self):
+        super().__init__()
+        self.hwinfo = HwinfoReader()
+
+    def scalar(self):
+        cpu_clock, cpu_temp, cpu_power = self.hwinfo.read() # Retrieve instantaneous CPU clock, temperature and package power
+
+        # If CPU clock/temp/power is None, then handle it and notify user to run HWiNFO with shared memory support
+        if (cpu_clock == None) or (cpu_temp == None) or (cpu_power == None):
+            cpu_clock = 0
+            cpu_temp = 0
+            cpu_power = 0
+            log.error("Failed to access HWiNFO shared memory.")
+
+        return int(cpu_clock), int(cpu_power), int(cpu_temp), int(self.gpu_temp())
+
+    def per_core_clocks(self, count):
+        # HWiNFO reports one clock per physical core, read during the scalar() call of the same sample
+        return spread(self.hwinfo.core_clocks, count)
+
+    def close(self):
+        self.hwinfo.close()
+
+'''
+Linux Provider (sysfs + procfs)
+'''
+
+class KernelFile:
+    '''
+    A sysfs/procfs file kept open for the lifetime of the provider. Each read is a single pread() at offset 0, which makes
+    the kernel regenerate the contents without the open()/close() and Python file object overhead of re-opening every sample.
+    '''
+    CHUNK = 4096
+
+    def __init__(self, path):
+        self.path = path
+        self.fd = os.open(path, os.O_RDONLY | getattr(os, 'O_CLOEXEC', 0))
+
+    @classmethod
+    def try_open(cls, path):
+        # Missing sensors and root-only files (RAPL energy, for example) are expected, callers treat None as "not available"
+        try:
+            return cls(path)
+        except OSError:
+            return None
+
+    def read(self):
+        data = os.pread(self.fd, self.CHUNK, 0)
+
+        # Only large procfs files (/proc/net/dev with many interfaces) ever need more than one read
+        while len(data) % self.CHUNK == 0 and data:
+            more = os.pread(self.fd, self.CHUNK, len(data))
+            if not more:
+                break
+            data += more
+        return data
+
+    def read_int(self):
+        return int(os.pread(self.fd, 64, 0))
+
+    def close(self):
+        os.close(self.fd)
+
+def read_text(path, default=""):
+    # One-off reads used while discovering sensors, not on the sampling path
+    try:
+        with open(path) as file:
+            return file.read().strip()
+    except OSError:
+        return default
+
+# hwmon driver names, in order of preference, that report the CPU package temperature as temp1
+LINUX_CPU_HWMON = ["coretemp", "k10temp", "zenpower", "cpu_thermal", "soc_thermal"]
+LINUX_GPU_HWMON = ["amdgpu", "nouveau", "radeon", "i915", "xe"]
+
+# thermal_zone types used as a fallback when no suitable hwmon driver is loaded
+LINUX_CPU_THERMAL_ZONES = ["x86_pkg_temp", "cpu-thermal", "cpu_thermal"]
+
+class LinuxSensorProvider(SensorProvider):
+    '''
+    Reads everything straight from the kernel. All files are discovered and opened once in the constructor,
+    so a sample is a handful of pread() calls and some integer parsing.
+    '''
+    name = "linux"
+
+    def __init__(self):
+        self.files = []
+
+        # CPU clock: the current frequency of every online core, in kHz
+        # (keyed by CPU number, a plain sort would put cpu10 before cpu2)
+        self.cpu_freq_files = {}
+        for path in glob.glob("/sys/devices/system/cpu/cpu[0-9]*/cpufreq/scaling_cur_freq"):
+            file = self.open_file(path)
+            if file is not None:
+                self.cpu_freq_files[int(path.split("/")[5][3:])] = file
+
+        # CPU temperature: hwmon package sensor, falling back to a thermal zone (both report millidegrees)
+        self.cpu_temp_file = self.open_hwmon_temp(LINUX_CPU_HWMON) or self.open_thermal_zone(LINUX_CPU_THERMAL_ZONES)
+
+        # CPU power: RAPL package energy counter in µJ, differentiated over time
+        self.cpu_energy_file = self.open_file("/sys/class/powercap/intel-rapl:0/energy_uj")
+        self.cpu_energy_range = int(read_text("/sys/class/powercap/intel-rapl:0/max_energy_range_uj", "0"))
+        self.last_energy = None
+        self.last_energy_time = None
+
+        # GPU: hwmon/DRM sysfs for AMD and Intel, NVML for NVIDIA since its driver exposes neither
+        self.gpu_temp_file = self.open_hwmon_temp(LINUX_GPU_HWMON)
+        gpu_busy = sorted(glob.glob("/sys/class/drm/card[0-9]*/device/gpu_busy_percent"))
+        self.gpu_busy_file = self.open_file(gpu_busy[0]) if gpu_busy else None
+        self.nvml, self.gpu_handle = (None, None)
+        if self.gpu_temp_file is None or self.gpu_busy_file is None:
+            self.nvml, self.gpu_handle = load_nvml()
+
+        # Usage and network activity from procfs
+        self.stat_file = self.open_file("/proc/stat")
+        self.meminfo_file = self.open_file("/proc/meminfo")
+        self.net_dev_file = self.open_file("/proc/net/dev")
+        self.last_cpu_times = self.read_cpu_times()
+        self.last_core_times = self.read_core_times()
+
+        down, up = self.read_net_bytes()
+        self.recv_rate = RateCounter(down)
+        self.sent_rate = RateCounter(up)
+
+        # Walking /proc/<pid> for every process is what psutil already does well, so the process list is borrowed from it
+        self.process_table = load_process_table()
+
+        missing = [name for name, file in [("CPU clock", self.cpu_freq_files), ("CPU temp", self.cpu_temp_file),
+                                           ("CPU power", self.cpu_energy_file),
+                                           ("GPU temp", self.gpu_temp_file or self.nvml),
+                                           ("GPU usage", self.gpu_busy_file or self.nvml),
+                                           ("process list (needs psutil)", self.process_table)] if not file]
+        if missing:
+            log.warning(f'Linux sensors not available (reported as 0): {", ".join(missing)}')
+
+    def open_file(self, path):
+        file = KernelFile.try_open(path)
+        if file is not None:
+            self.files.append(file)
+        return file
+
+    def open_all(self, paths):
+        return [file for file in (self.open_file(path) for path in paths) if file is not None]
+
+    def open_hwmon_temp(self, driver_names):
+        hwmons = {read_text(os.path.join(path, "name")): path for path in glob.glob("/sys/class/hwmon/hwmon*")}
+        for driver in driver_names:
+            if driver in hwmons:
+                file = self.open_file(os.path.join(hwmons[driver], "temp1_input"))
+                if file is not None:
+                    return file
+        return None
+
+    def open_thermal_zone(self, zone_types):
+        zones = {read_text(os.path.join(path, "type")): path for path in glob.glob("/sys/class/thermal/thermal_zone*")}
+        for zone_type in zone_types:
+            if zone_type in zones:
+                return self.open_file(os.path.join(zones[zone_type], "temp"))
+        return None
+
+    def read_cpu_times(self):
+        # First line of /proc/stat is "cpu  user nice system idle iowait irq softirq steal ..." in jiffies, summed over all cores
+        if self.stat_file is None:
+            return None
+        line = self.stat_file.read().split(b'\n', 1)[0]
+        times = [int(field) for field in line.split()[1:9]]
+        idle = times[3] + times[4] # idle + iowait
+        return idle, sum(times)
+
+    def read_core_times(self):
+        # The "cpuN ..." lines that follow, one per online CPU, as {N: (idle, total)}
+        if self.stat_file is None:
+            return {}
+        core_times = {}
+        for line in self.stat_file.read().split(b'\n')[1:]:
+            if not line.startswith(b'cpu'):
+                break # The per-CPU lines are contiguous, everything after them is other statistics
+            fields = line.split()
+            times = [int(field) for field in fields[1:9]]
+            core_times[int(fields[0][3:])] = (times[3] + times[4], sum(times))
+        return core_times
+
+    def read_net_bytes(self):
+        # /proc/net/dev: two header lines, then "iface: rx_bytes rx_packets ... (8 rx fields) tx_bytes ..."
+        if self.net_dev_file is None:
+            return 0, 0
+        recv = 0
+        sent = 0
+        for line in self.net_dev_file.read().split(b'\n')[2:]:
+            iface, _, fields = line.partition(b':')
+            if not fields or iface.strip() == b'lo': # Loopback traffic never leaves the machine
+                continue
+            fields = fields.split()
+            recv += int(fields[0])
+            sent += int(fields[8])
+        return recv, sent
+
+    def cpu_power(self):
+        if self.cpu_energy_file is None:
+            return 0
+        energy = self.cpu_energy_file.read_int()
+        now = time.monotonic()
+        power = 0
+        if self.last_energy is not None and now > self.last_energy_time:
+            delta = energy - self.last_energy
+            if delta < 0: # The counter wraps at max_energy_range_uj
+                delta += self.cpu_energy_range
+            power = (delta / 1e6) / (now - self.last_energy_time) # µJ/s to W
+        self.last_energy = energy
+        self.last_energy_time = now
+        return power
+
+    def scalar(self):
+        cpu_clock = 0
+        if self.cpu_freq_files:
+            # Report the average of the individual core clocks, matching what the HWiNFO provider shows
+            cpu_clock = sum(file.read_int() for file in self.cpu_freq_files.values()) / len(self.cpu_freq_files) / 1e3 # kHz to MHz
+
+        cpu_temp = self.cpu_temp_file.read_int() / 1e3 if self.cpu_temp_file else 0
+
+        if self.gpu_temp_file is not None:
+            gpu_temp = self.gpu_temp_file.read_int() / 1e3
+        elif self.nvml is not None:
+            gpu_temp = self.nvml.nvmlDeviceGetTemperature(self.gpu_handle, self.nvml.NVML_TEMPERATURE_GPU)
+        else:
+            gpu_temp = 0
+
+        return int(cpu_clock), int(self.cpu_power()), int(cpu_temp), int(gpu_temp)
+
+    def network(self):
+        down, up = self.read_net_bytes()
+        down_bits = self.recv_rate.update(down) / (1e3) # Get average download network activity in Kb/s since last iteration
+        up_bits = self.sent_rate.update(up) / (1e3) # Get average upload network activity in Kb/s since last iteration
+        return int(down_bits), int(up_bits)
+
+    def percent(self):
+        # CPU usage is the non-idle share of the jiffies that passed since the previous sample
+        cpu_percent = 0
+        cpu_times = self.read_cpu_times()
+        if cpu_times is not None and self.last_cpu_times is not None:
+            idle = cpu_times[0] - self.last_cpu_times[0]
+            total = cpu_times[1] - self.last_cpu_times[1]
+            if total > 0:
+                cpu_percent = 100 * (total - idle) / total
+        self.last_cpu_times = cpu_times
+
+        if self.gpu_busy_file is not None:
+            gpu_percent = self.gpu_busy_file.read_int()
+        elif self.nvml is not None:
+            gpu_percent = self.nvml.nvmlDeviceGetUtilizationRates(self.gpu_handle).gpu
+        else:
+            gpu_percent = 0
+
+        ram_usage_percent = 0
+        if self.meminfo_file is not None:
+            meminfo = {}
+            for line in self.meminfo_file.read().split(b'\n', 3)[:3]: # MemTotal, MemFree, MemAvailable are the first three lines
+                key, _, value = line.partition(b':')
+                meminfo[key] = int(value.split()[0])
+            if meminfo.get(b'MemTotal'):
+                ram_usage_percent = 100 * (meminfo[b'MemTotal'] - meminfo.get(b'MemAvailable', 0)) / meminfo[b'MemTotal']
+
+        return int(cpu_percent), int(gpu_percent), int(ram_usage_percent)
+
+    def per_core(self):
+        core_times = self.read_core_times()
+        usages = []
+        clocks = []
+        for cpu in sorted(core_times):
+            idle, total = core_times[cpu]
+            last_idle, last_total = self.last_core_times.get(cpu, (idle, total))
+            usages.append(int(100 * (1 - (idle - last_idle) / (total - last_total))) if total > last_total else 0)
+
+            file = self.cpu_freq_files.get(cpu)
+            clocks.append(file.read_int() // 1000 if file else 0) # kHz to MHz
+        self.last_core_times = core_times
+        return usages, clocks
+
+    def top_processes(self, count):
+        return self.process_table.top(count) if self.process_table else []
+
+    def details(self):
+        system_details = platform.node()
+
+        cpu_details = "Unknown CPU"
+        for line in read_text("/proc/cpuinfo").split('\n'):
+            if line.startswith("model name") or line.startswith("Model"): # x86 and ARM respectively
+                cpu_details = line.partition(':')[2].strip()
+                break
+
+        gpu_details = "Unknown GPU"
+        if self.nvml is not None:
+            gpu_details = self.nvml.nvmlDeviceGetName(self.gpu_handle)
+            if isinstance(gpu_details, bytes):
+                gpu_details = gpu_details.decode('utf-8', errors='ignore')
+        else:
+            # DRM drivers only expose PCI IDs, the marketing name would need a pci.ids lookup
+            for card in sorted(glob.glob("/sys/class/drm/card[0-9]*/device")):
+                vendor = read_text(os.path.join(card, "vendor"))
+                device = read_text(os.path.join(card, "device"))
+                if vendor and device:
+                    gpu_details = f'GPU {vendor}:{device}'
+                    break
+
+        return system_details, cpu_details, gpu_details
+
+    def close(self):
+        for file in self.files:
+            file.close()
+        self.files = []
+
+'''
+Provider Selection & Benchmark
+'''
+
+PROVIDERS = {
+    "windows": WindowsSensorProvider,
+    "linux": LinuxSensorProvider,
+    "psutil": PsutilSensorProvider,
+}
+
+def create_provider(name="auto"):
+    if name == "auto":
+        name = {"Windows": "windows", "Linux": "linux"}.get(platform.system(), "psutil")
+    return PROVIDERS[name]()
+
+def benchmark_provider(provider, iterations=1000):
+    '''
+    Measures the cost of one full sample (scalar + network + percent + per-core), the work the sampler thread does every period.
+    '''
+    # Warm up first, so lazy imports and first-call caches aren't counted
+    for _ in range(10):
+        provider.scalar(); provider.network(); provider.percent(); provider.per_core()
+
+    costs_us = []
+    cpu_start = time.process_time()
+    for _ in range(iterations):
+        start = time.perf_counter_ns()
+        provider.scalar()
+        provider.network()
+        provider.percent()
+        provider.per_core()
+        costs_us.append((time.perf_counter_ns() - start) / 1e3)
+    cpu_us = (time.process_time() - cpu_start) * 1e6 / iterations
+
+    costs_us.sort()
+    print(f'{provider.name:>8}: mean {statistics.fmean(costs_us):8.1f} µs, median {costs_us[len(costs_us) // 2]:8.1f} µs, '
+          f'p99 {costs_us[int(0.99 * (len(costs_us) - 1))]:8.1f} µs, CPU time {cpu_us:8.1f} µs per sample')
+
+def benchmark(iterations=1000):
+    # Compare the platform provider against the portable psutil one
+    for name in dict.fromkeys([create_provider().name, "psutil"]):
+        try:
+            provider = create_provider(name)
+        except Exception as error:
+            print(f'{name:>8}: unavailable ({error})')
+            continue
+        benchmark_provider(provider, iterations)
+        provider.close()
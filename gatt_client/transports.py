@@ -0,0 +1,662 @@
+'''
+Transports
+
+Everything that sends packed metrics goes through a Transport, so the sampling, packing and replay code can be exercised
+against a fake device on any machine. BleakTransport talks to the real nRF52840, FanOutTransport keeps one BleakTransport per
+display in range, BroadcastTransport advertises to any number of displays without connecting, and LoopbackTransport stands
+in for a device.
+'''
+
+import os
+import zlib
+import struct
+import time
+import random
+import asyncio
+import platform
+import subprocess
+import logging
+from collections import deque
+import bleak
+from bleak.exc import BleakError
+
+log = logging.getLogger("transports")
+
+'''
+Transport Interface
+'''
+
+class Transport:
+    name = "none"
+
+    def __init__(self):
+        # Set when the link drops, the supervisor waits on this alongside the transmit loop
+        self.disconnected = asyncio.Event()
+        # Bumped when a device that needs everything resent joins without the transmit loop restarting (see FanOutTransport)
+        self.session = 0
+
+    async def connect(self):
+        self.disconnected.clear()
+        return True
+
+    async def write(self, char_uuid, data):
+        raise NotImplementedError
+
+    async def read(self, char_uuid):
+        # Only transports with a link to one device can read back from it
+        raise NotImplementedError
+
+    def max_write_size(self):
+        # Largest single write, the default 23 byte ATT MTU minus the 3 byte write header
+        return 20
+
+    async def close(self):
+        pass
+
+    def report(self):
+        pass
+
+'''
+BLE Transport
+'''
+
+# Give up on a direct connection to the cached address quickly, a fresh scan is the fallback
+DIRECT_CONNECT_TIMEOUT_S = 3
+
+# The device advertises at 30-60 ms intervals, so a filtered scan finds it well within this
+SCAN_TIMEOUT_S = 5
+
+class BleakTransport(Transport):
+    '''
+    Connects straight to the last known device address when there is one, and only falls back to scanning (filtered on our
+    service UUID, so unrelated advertisers are never even reported) when that fails. Every successful connection refreshes the
+    cached address.
+    '''
+    name = "ble"
+
+    def __init__(self, device_name, service_uuid, address_cache_path, fixed_address=None):
+        super().__init__()
+        self.device_name = device_name
+        self.service_uuid = service_uuid.lower()
+        self.address_cache_path = address_cache_path # None to never cache
+        self.fixed_address = fixed_address # Only ever connect to this device, never scan for another
+        self.client = None
+        self.address = None
+
+    def load_cached_address(self):
+        if self.address_cache_path is None:
+            return None
+        try:
+            with open(self.address_cache_path) as file:
+                return file.read().strip() or None
+        except OSError:
+            return None
+
+    def save_cached_address(self, address):
+        if self.address_cache_path is None:
+            return
+        try:
+            with open(self.address_cache_path, "w") as file:
+                file.write(address)
+        except OSError as error:
+            log.warning(f'Could not cache device address: {error}')
+
+    def on_disconnect(self, client):
+        # Called by bleak from the event loop when the link drops
+        log.warning("Disconnected from device.")
+        self.disconnected.set()
+
+    async def try_connect(self, target, timeout):
+        client = bleak.BleakClient(target, disconnected_callback=self.on_disconnect, timeout=timeout)
+        try:
+            await client.connect()
+        except (BleakError, asyncio.TimeoutError, OSError) as error:
+            log.warning(f'Connection failed: {error}')
+            return None
+        return client
+
+    async def scan(self):
+        def matches(device, advertisement):
+            return (self.service_uuid in [uuid.lower() for uuid in advertisement.service_uuids]
+                    or device.name == self.device_name)
+
+        return await bleak.BleakScanner.find_device_by_filter(matches, timeout=SCAN_TIMEOUT_S, service_uuids=[self.service_uuid])
+
+    async def connect(self):
+        self.disconnected.clear()
+
+        # Step 1: Connect directly to the cached address, no scan needed
+        cached_address = self.fixed_address or self.address or self.load_cached_address()
+        if cached_address is not None:
+            self.client = await self.try_connect(cached_address, SCAN_TIMEOUT_S if self.fixed_address else DIRECT_CONNECT_TIMEOUT_S)
+            if self.client is None and self.fixed_address:
+                return False
+
+        # Step 2: Otherwise scan for the nRF52840
+        if self.client is None:
+            device = await self.scan()
+
+            if device == None:
+                log.warning("Device not found.")
+                return False
+
+            self.client = await self.try_connect(device, SCAN_TIMEOUT_S)
+            if self.client is None:
+                return False
+
+        log.info(f'Connected to {self.client.address}!')
+        if self.client.address != cached_address:
+            self.save_cached_address(self.client.address)
+        self.address = self.client.address
+        return True
+
+    async def write(self, char_uuid, data):
+        # Use Write Without Response to match Zephyr BT_GATT_CHRC_WRITE_WITHOUT_RESP
+        await self.client.write_gatt_char(char_uuid, data, response=False)
+
+    async def read(self, char_uuid):
+        return bytes(await self.client.read_gatt_char(char_uuid))
+
+    def max_write_size(self):
+        # Negotiated ATT MTU minus the 3 byte write header, the device allows up to CONFIG_BT_L2CAP_TX_MTU (67)
+        return self.client.mtu_size - 3
+
+    async def close(self):
+        if self.client is not None:
+            client = self.client
+            self.client = None
+            try:
+                await client.disconnect()
+            except (BleakError, OSError):
+                pass # Already gone
+
+'''
+Multi-Device Transport
+'''
+
+# How often to look for displays that aren't connected yet
+DISCOVERY_INTERVAL_S = 30
+
+# Writes waiting for one display, a display further behind than this has a stalled link
+DEVICE_QUEUE_SIZE = 64
+
+class DeviceLink:
+    '''
+    One display of a FanOutTransport: its own connection, reconnect loop, send queue and sender, so a display that is slow
+    (or out of range) only ever delays itself.
+    '''
+
+    def __init__(self, fan_out, address):
+        self.fan_out = fan_out
+        self.address = address
+        self.transport = BleakTransport(fan_out.device_name, fan_out.service_uuid, None, fixed_address=address)
+        self.pending = deque() # (char_uuid, data), oldest first
+        self.ready = asyncio.Event()
+        self.connected = False
+        self.task = None
+        self.reconnects = 0
+        self.reset()
+
+    def reset(self):
+        self.writes = 0
+        self.bytes_written = 0
+        self.dropped = 0
+        self.queue_peak = 0
+
+    def enqueue(self, char_uuid, data):
+        if not self.connected:
+            return
+
+        # A newer value of a metric group makes any queued older one pointless, replace it in place
+        if char_uuid in self.fan_out.coalesce_uuids:
+            for i, (queued_uuid, _) in enumerate(self.pending):
+                if queued_uuid == char_uuid:
+                    self.pending[i] = (char_uuid, data)
+                    self.dropped += 1
+                    return
+
+        self.pending.append((char_uuid, data))
+        if len(self.pending) > DEVICE_QUEUE_SIZE:
+            # Drop the oldest write that can be lost (a per-core frame is simply abandoned by the device). When everything
+            # queued must arrive in order (the process name table), the link is too far behind to recover, so restart it
+            for i, (queued_uuid, _) in enumerate(self.pending):
+                if queued_uuid not in self.fan_out.reliable_uuids:
+                    del self.pending[i]
+                    self.dropped += 1
+                    break
+            else:
+                log.warning(f'[{self.address}] send queue stalled, reconnecting')
+                self.transport.disconnected.set()
+        self.queue_peak = max(self.queue_peak, len(self.pending))
+        self.ready.set()
+
+    async def send_pending(self):
+        while True:
+            await self.ready.wait()
+            self.ready.clear()
+            while self.pending:
+                char_uuid, data = self.pending.popleft()
+                await self.transport.write(char_uuid, data)
+                self.writes += 1
+                self.bytes_written += len(data)
+
+    async def run(self):
+        backoff_s = 0
+        while True:
+            if not await self.transport.connect():
+                delay = backoff_s / 2 + random.uniform(0, backoff_s / 2)
+                backoff_s = min(max(backoff_s * 2, self.fan_out.reconnect_initial_s), self.fan_out.reconnect_max_s)
+                await asyncio.sleep(delay)
+                continue
+            backoff_s = 0
+
+            # Everything the device only gets once (detail strings) goes first, then the transmit loop resends the rest
+            self.pending.clear()
+            self.pending.extend(self.fan_out.sticky.items())
+            self.connected = True
+            self.ready.set()
+            self.fan_out.device_joined()
+
+            sender = asyncio.create_task(self.send_pending())
+            link_lost = asyncio.create_task(self.transport.disconnected.wait())
+            done, _ = await asyncio.wait({sender, link_lost}, return_when=asyncio.FIRST_COMPLETED)
+            sender.cancel()
+            link_lost.cancel()
+            await asyncio.gather(sender, link_lost, return_exceptions=True)
+            if sender in done and not sender.cancelled() and not isinstance(sender.exception(), (BleakError, OSError)):
+                raise sender.exception()
+
+            self.connected = False
+            self.reconnects += 1
+            log.warning(f'[{self.address}] link lost')
+            await self.transport.close()
+
+    def report(self, elapsed):
+        state = "connected" if self.connected else "reconnecting"
+        log.info(f'[{self.address}] {state}, {self.writes / elapsed:.0f} writes/s, {self.bytes_written / elapsed:.0f} B/s, '
+                 f'{self.dropped} dropped, queue peak {self.queue_peak}, {self.reconnects} reconnects')
+        self.reset()
+
+class FanOutTransport(Transport):
+    '''
+    Drives every display advertising the hardware monitor service at once. Each write is copied into the send queue of every
+    connected display, and each display is fed by its own task, so the transmit loop (and with it sampling) runs exactly
+    once per slot however many displays there are, and never waits on any of them.
+    '''
+    name = "multi"
+
+    def __init__(self, device_name, service_uuid, coalesce_uuids, reliable_uuids, sticky_uuids,
+                 reconnect_initial_s, reconnect_max_s):
+        super().__init__()
+        self.device_name = device_name
+        self.service_uuid = service_uuid.lower()
+        self.coalesce_uuids = set(coalesce_uuids) # Only the newest queued write matters
+        self.reliable_uuids = set(reliable_uuids) | set(sticky_uuids) # Never dropped from a queue
+        self.sticky_uuids = set(sticky_uuids) # Written once per session, replayed to every display that joins later
+        self.sticky = {}
+        self.reconnect_initial_s = reconnect_initial_s
+        self.reconnect_max_s = reconnect_max_s
+        self.links = {} # Address -> DeviceLink
+        self.discovery_task = None
+        self.start = time.perf_counter()
+
+    async def discover(self):
+        devices = await bleak.BleakScanner.discover(timeout=SCAN_TIMEOUT_S, service_uuids=[self.service_uuid])
+        for device in devices:
+            if device.address not in self.links:
+                log.info(f'Found display {device.address}')
+                link = DeviceLink(self, device.address)
+                link.task = asyncio.create_task(link.run())
+                self.links[device.address] = link
+
+    async def keep_discovering(self):
+        while True:
+            await asyncio.sleep(DISCOVERY_INTERVAL_S)
+            try:
+                await self.discover()
+            except (BleakError, OSError) as error:
+                log.warning(f'Discovery failed: {error}')
+
+    async def connect(self):
+        # Succeeds once at least one display has been found, the others are picked up as they appear
+        self.disconnected.clear()
+        if not self.links:
+            try:
+                await self.discover()
+            except (BleakError, OSError) as error:
+                log.warning(f'Discovery failed: {error}')
+        if not self.links:
+            log.warning("No displays found.")
+            return False
+        if self.discovery_task is None:
+            self.discovery_task = asyncio.create_task(self.keep_discovering())
+        return True
+
+    def device_joined(self):
+        self.session += 1
+
+    async def write(self, char_uuid, data):
+        if char_uuid in self.sticky_uuids:
+            self.sticky[char_uuid] = data
+        for link in self.links.values():
+            link.enqueue(char_uuid, data)
+
+    def max_write_size(self):
+        # Every display gets the same chunks, so they have to fit the smallest MTU
+        sizes = [link.transport.max_write_size() for link in self.links.values() if link.connected]
+        return min(sizes) if sizes else super().max_write_size()
+
+    async def close(self):
+        tasks = [link.task for link in self.links.values()] + [self.discovery_task]
+        for task in tasks:
+            if task is not None:
+                task.cancel()
+        await asyncio.gather(*(task for task in tasks if task is not None), return_exceptions=True)
+        await asyncio.gather(*(link.transport.close() for link in self.links.values()))
+        self.links = {}
+        self.discovery_task = None
+
+    def report(self):
+        elapsed = time.perf_counter() - self.start
+        connected = sum(link.connected for link in self.links.values())
+        log.info(f'[multi] {connected} of {len(self.links)} displays connected')
+        for link in self.links.values():
+            link.report(elapsed)
+        self.start = time.perf_counter()
+
+'''
+Broadcast Transport
+'''
+
+# Broadcast frame, see ble_broadcast_frame_t in ble_observer.h. The company ID is added by the advertiser, the rest is:
+# version, host id, sequence, CPU clock, CPU power, CPU temp, GPU temp, download, upload, CPU %, GPU %, RAM %
+BROADCAST_COMPANY_ID = 0xFFFF
+BROADCAST_FRAME_VERSION = 1
+BROADCAST_FRAME = struct.Struct("<BHBHHBBIIBBB")
+
+# Each frame is repeated on every advertising interval until the next one replaces it
+BROADCAST_INTERVAL_MS = 100
+
+class HciAdvertiser:
+    '''
+    Publishes legacy, non-connectable advertising data with raw HCI commands through BlueZ's hcitool. Needs root, and the
+    adapter shouldn't be advertising for anything else at the same time.
+    '''
+
+    def __init__(self, adapter="hci0"):
+        self.adapter = adapter
+
+    async def command(self, ocf, params):
+        # All commands used here are LE controller commands (OGF 0x08)
+        process = await asyncio.create_subprocess_exec(
+            "hcitool", "-i", self.adapter, "cmd", "0x08", f"0x{ocf:04x}", *(f"{byte:02x}" for byte in params),
+            stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        _, error = await process.communicate()
+        if process.returncode:
+            raise OSError(f'hcitool failed: {error.decode(errors="replace").strip()}')
+
+    async def start(self):
+        interval = int(BROADCAST_INTERVAL_MS / 0.625) # In 0.625 ms units
+        # LE Set Advertising Parameters: min and max interval, ADV_NONCONN_IND, public address, no peer, all channels, no filter
+        await self.command(0x0006, struct.pack("<HHBBB6sBB", interval, interval, 0x03, 0x00, 0x00, bytes(6), 0x07, 0x00))
+        await self.publish(BROADCAST_COMPANY_ID, bytes(BROADCAST_FRAME.size))
+        await self.command(0x000A, b"\x01") # LE Set Advertise Enable
+
+    async def publish(self, company_id, payload):
+        # Flags (LE only, not discoverable) then the manufacturer data, padded to the fixed 31 byte field
+        data = bytes([2, 0x01, 0x04, 3 + len(payload), 0xFF]) + struct.pack("<H", company_id) + payload
+        await self.command(0x0008, bytes([len(data)]) + data.ljust(31, b"\x00")) # LE Set Advertising Data
+
+    async def stop(self):
+        await self.command(0x000A, b"\x00")
+
+class WinrtAdvertiser:
+    '''
+    Publishes manufacturer data through the Windows advertisement publisher (pywinrt), no admin rights needed.
+    '''
+
+    def __init__(self):
+        from winrt.windows.devices.bluetooth.advertisement import BluetoothLEAdvertisementPublisher, BluetoothLEManufacturerData
+        from winrt.windows.storage.streams import DataWriter
+        self.publisher_type = BluetoothLEAdvertisementPublisher
+        self.manufacturer_data_type = BluetoothLEManufacturerData
+        self.writer_type = DataWriter
+        self.publisher = None
+
+    async def start(self):
+        await self.publish(BROADCAST_COMPANY_ID, bytes(BROADCAST_FRAME.size))
+
+    async def publish(self, company_id, payload):
+        manufacturer_data = self.manufacturer_data_type()
+        manufacturer_data.company_id = company_id
+        writer = self.writer_type()
+        writer.write_bytes(list(payload))
+        manufacturer_data.data = writer.detach_buffer()
+
+        # A publisher's advertisement can't change while it runs, so every frame gets a new publisher
+        publisher = self.publisher_type()
+        publisher.advertisement.manufacturer_data.append(manufacturer_data)
+        if self.publisher is not None:
+            self.publisher.stop()
+        publisher.start()
+        self.publisher = publisher
+
+    async def stop(self):
+        if self.publisher is not None:
+            self.publisher.stop()
+            self.publisher = None
+
+def create_advertiser():
+    if platform.system() == "Windows":
+        return WinrtAdvertiser()
+    return HciAdvertiser()
+
+class BroadcastTransport(Transport):
+    '''
+    Advertises the scalar, network and percentage metrics as one small frame instead of writing them over a connection, so
+    any number of displays (built with broadcast.conf) can follow one host at a constant cost to the host. The writes of one
+    transmit slot are coalesced into a single frame. Everything that needs a connection (detail strings, per-core metrics,
+    the process list) is dropped.
+    '''
+    name = "broadcast"
+
+    def __init__(self, group_formats):
+        super().__init__()
+        # group_formats maps the characteristic UUID of each metric group to its name and struct format
+        self.group_formats = {uuid: (group, struct.Struct(fmt)) for uuid, (group, fmt) in group_formats.items()}
+        self.values = {"scalar": (0, 0, 0, 0), "network": (0, 0), "percent": (0, 0, 0)}
+        self.host_id = zlib.crc32(platform.node().encode('utf-8')) & 0xFFFF # Stable per machine, so displays keep following it across restarts
+        self.sequence = 0
+        self.advertiser = None
+        self.dirty = False
+        self.flush_task = None
+        self.reset()
+
+    def reset(self):
+        self.start = time.perf_counter()
+        self.frames = 0
+        self.skipped = 0
+
+    async def connect(self):
+        self.disconnected.clear()
+        try:
+            self.advertiser = create_advertiser()
+            await self.advertiser.start()
+        except (ImportError, OSError) as error:
+            log.error(f'Broadcasting not available: {error}')
+            self.advertiser = None
+            return False
+        log.info(f'Broadcasting as host {self.host_id:04x}')
+        return True
+
+    async def write(self, char_uuid, data):
+        if char_uuid not in self.group_formats:
+            self.skipped += 1
+            return
+
+        group, layout = self.group_formats[char_uuid]
+        self.values[group] = layout.unpack(data)
+
+        # The other groups of this slot are written before the event loop runs again, they all land in the same frame
+        self.dirty = True
+        if self.flush_task is None or self.flush_task.done():
+            self.flush_task = asyncio.create_task(self.flush())
+
+    def pack_frame(self):
+        cpu_clock, cpu_power, cpu_temp, gpu_temp = self.values["scalar"]
+        down_bits, up_bits = self.values["network"]
+        cpu_percent, gpu_percent, ram_percent = self.values["percent"]
+        return BROADCAST_FRAME.pack(BROADCAST_FRAME_VERSION, self.host_id, self.sequence,
+                                    min(cpu_clock, 0xFFFF), min(cpu_power, 0xFFFF), min(cpu_temp, 0xFF), min(gpu_temp, 0xFF),
+                                    down_bits, up_bits, min(cpu_percent, 100), min(gpu_percent, 100), min(ram_percent, 100))
+
+    async def flush(self):
+        while self.dirty and self.advertiser is not None:
+            self.dirty = False
+            self.sequence = (self.sequence + 1) & 0xFF
+            try:
+                await self.advertiser.publish(BROADCAST_COMPANY_ID, self.pack_frame())
+            except OSError as error:
+                # Nothing awaits this task, so a failure is reported like a dropped link and the supervisor restarts us
+                log.warning(f'Broadcast failed: {error}')
+                self.disconnected.set()
+                return
+            self.frames += 1
+
+    async def close(self):
+        if self.flush_task is not None:
+            self.flush_task.cancel()
+            self.flush_task = None
+        if self.advertiser is not None:
+            advertiser = self.advertiser
+            self.advertiser = None
+            try:
+                await advertiser.stop()
+            except OSError:
+                pass
+
+    def report(self):
+        elapsed = time.perf_counter() - self.start
+        log.info(f'[broadcast] {self.frames} frames in {elapsed:.3f} s ({self.frames / elapsed:.1f} frames/s), '
+                 f'{self.skipped} writes skipped (connection only)')
+        self.reset()
+
+'''
+Loopback Transport
+'''
+
+# Per-core chunk layout, see per_core_chunk_header_t in ble_peripheral.h
+PER_CORE_HEADER = struct.Struct("<BBBB")
+PER_CORE_MAX_CORES = 128
+
+# Process list messages, see process_list.h
+PROCESS_NAME_SLOTS = 32
+PROCESS_NAME_MAX_LENGTH = 23
+PROCESS_LIST_TOP_N = 8
+PROCESS_MSG_DEFINE_NAME = 0x01
+PROCESS_MSG_TOP_LIST = 0x02
+
+class LoopbackTransport(Transport):
+    '''
+    Fake device that validates and decodes every write exactly like the GATT write callbacks in ble_peripheral.c do
+    (same lengths, same little-endian uint32_t layout), and keeps throughput/latency statistics instead of drawing anything.
+    '''
+    name = "loopback"
+
+    def __init__(self, char_formats, max_details_len=64, mtu=67, readers=None):
+        super().__init__()
+        # readers maps a readable characteristic UUID to a function that builds its value from this transport
+        self.readers = readers or {}
+        # char_formats maps a characteristic UUID to a struct format, None for the UTF-8 detail strings,
+        # or "per_core"/"process_list" for the variable-length messages
+        self.char_formats = {uuid: (struct.Struct(fmt) if fmt and fmt not in ("per_core", "process_list") else fmt)
+                             for uuid, fmt in char_formats.items()}
+        self.process_names = [""] * PROCESS_NAME_SLOTS
+        self.max_details_len = max_details_len
+        # ATT MTU of the simulated link, the device allows up to CONFIG_BT_L2CAP_TX_MTU (67)
+        self.mtu = mtu
+        self.last_values = {}
+        self.reset()
+
+    def reset(self):
+        self.start = time.perf_counter()
+        self.writes = 0
+        self.bytes_written = 0
+        self.rejected = 0
+        self.latencies_us = []
+
+    async def write(self, char_uuid, data):
+        start = time.perf_counter_ns()
+        layout = self.char_formats.get(char_uuid)
+
+        if char_uuid not in self.char_formats:
+            self.rejected += 1 # The device would answer BT_ATT_ERR_ATTRIBUTE_NOT_FOUND
+        elif layout == "per_core":
+            # Same checks as ble_per_core_metrics_write_cb: a 4 byte header, then 3 bytes per core, all inside the frame
+            cores, remainder = divmod(len(data) - PER_CORE_HEADER.size, 3)
+            if len(data) <= PER_CORE_HEADER.size or remainder or len(data) > self.max_write_size():
+                self.rejected += 1
+            else:
+                frame_id, core_count, first_core, _ = PER_CORE_HEADER.unpack_from(data)
+                if core_count == 0 or core_count > PER_CORE_MAX_CORES or first_core + cores > core_count:
+                    self.rejected += 1
+        elif layout == "process_list":
+            if not self.apply_process_message(char_uuid, bytes(data)):
+                self.rejected += 1
+        elif layout is None:
+            # Detail strings: the device rejects anything that doesn't fit its buffer
+            if len(data) > self.max_details_len:
+                self.rejected += 1
+            else:
+                self.last_values[char_uuid] = bytes(data).decode('utf-8', errors='replace')
+        elif len(data) != layout.size:
+            self.rejected += 1 # The device would answer BT_ATT_ERR_INVALID_ATTRIBUTE_LEN
+        else:
+            self.last_values[char_uuid] = layout.unpack(data)
+
+        self.latencies_us.append((time.perf_counter_ns() - start) / 1e3)
+        self.writes += 1
+        self.bytes_written += len(data)
+
+    async def read(self, char_uuid):
+        if char_uuid not in self.readers:
+            raise NotImplementedError
+        return self.readers[char_uuid](self)
+
+    def apply_process_message(self, char_uuid, data):
+        # Same checks as process_list_handle_message, and the list is decoded through the name table like the device does
+        if len(data) >= 3 and data[0] == PROCESS_MSG_DEFINE_NAME:
+            slot, length = data[1], data[2]
+            if slot >= PROCESS_NAME_SLOTS or length > PROCESS_NAME_MAX_LENGTH or len(data) != 3 + length:
+                return False
+            self.process_names[slot] = data[3:].decode('utf-8', errors='replace')
+            return True
+        if len(data) >= 2 and data[0] == PROCESS_MSG_TOP_LIST:
+            count = data[1]
+            if count > PROCESS_LIST_TOP_N or len(data) != 2 + 3 * count:
+                return False
+            entries = [data[2 + 3 * i:5 + 3 * i] for i in range(count)]
+            if any(entry[0] >= PROCESS_NAME_SLOTS for entry in entries):
+                return False
+            self.last_values[char_uuid] = [(self.process_names[slot], cpu, mem) for slot, cpu, mem in entries]
+            return True
+        return False
+
+    async def close(self):
+        # The device drops its name table on disconnect
+        self.process_names = [""] * PROCESS_NAME_SLOTS
+        await super().close()
+
+    def max_write_size(self):
+        # ATT MTU minus the 3 byte write header, like BleTransport
+        return self.mtu - 3
+
+    def report(self):
+        elapsed = time.perf_counter() - self.start
+        if not self.latencies_us:
+            log.info("[loopback] no writes")
+            return
+        latencies = sorted(self.latencies_us)
+        log.info(f'[loopback] {self.writes} writes ({self.rejected} rejected), {self.bytes_written} bytes in {elapsed:.3f} s, '
+                 f'{self.writes / elapsed:.0f} writes/s, {self.bytes_written / elapsed:.0f} B/s, '
+                 f'write latency median {latencies[len(latencies) // 2]:.1f} µs, p99 {latencies[int(0.99 * (len(latencies) - 1))]:.1f} µs')
@@ -0,0 +1,226 @@
+'''
+Footprint & Benchmark Regression Check
+
+Compares a twister run against the committed baseline and fails when RAM, ROM, render time or LVGL heap use grew past the
+baseline's tolerances. Typical use from the workspace root:
+
+    west twister -T embedded_in_embedded_2026/app --footprint-report all
+    python3 embedded_in_embedded_2026/scripts/regression_check.py twister-out/twister.json
+
+Benchmarks only produce results when the app.ui_benchmark.run scenario runs on a board (--device-testing), build-only
+runs are checked for footprint alone. After an intentional change, rerun with --update and commit the new baseline.
+
+A suite or benchmark missing from the baseline fails the check too, otherwise a partial baseline would hide new scenarios.
+Pass --allow-missing while adding new scenarios, then --update to record them.
+
+The committed baseline has no suites yet: it was written without access to a toolchain or a board, so no twister run
+could produce one. Until the first --update is committed the check only reports, and fails on its "limits" alone.
+
+The baseline's "limits" are absolute ceilings on benchmark results, keyed by scenario/phase patterns (fnmatch), and apply
+whether or not a suite has a baseline yet. They hold the heatmap core count sweep to a render time and LVGL heap budget.
+'''
+
+import os
+import sys
+import json
+import fnmatch
+import argparse
+
+DEFAULT_BASELINE = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "app", "regression_baseline.json")
+
+# Footprint trees are summed per node this many levels below the root, e.g. ZEPHYR_BASE/subsys/bluetooth
+DEFAULT_MODULE_DEPTH = 3
+
+# Used when the baseline file doesn't set its own
+DEFAULT_TOLERANCES = {
+    "ram_bytes": 512,
+    "rom_bytes": 2048,
+    "time_percent": 10,
+    "heap_bytes": 512,
+}
+
+'''
+Collecting Results
+'''
+
+def collect_modules(tree, depth):
+    # size_report trees nest by path, symbols are the leaves. twister stores them either bare or under "symbols"
+    root = tree.get("symbols", tree)
+    modules = {}
+
+    def walk(node, level):
+        children = node.get("children", [])
+        if level >= depth or not children:
+            if node.get("size"):
+                modules[node.get("identifier", node.get("name"))] = node["size"]
+            return
+        for child in children:
+            walk(child, level + 1)
+
+    for child in root.get("children", []):
+        walk(child, 1)
+    return modules
+
+def collect_suite(suite, depth):
+    result = {}
+
+    for area, key in (("ram", "used_ram"), ("rom", "used_rom")):
+        if suite.get(key) is not None:
+            result[area] = suite[key]
+
+    footprint = suite.get("footprint", {})
+    for area in ("ram", "rom"):
+        tree = footprint.get(area.upper())
+        if tree:
+            result[f"{area}_modules"] = collect_modules(tree, depth)
+
+    # Every UIBENCH line the console harness recorded, keyed by scenario and phase
+    benchmarks = {}
+    for record in suite.get("recording") or []:
+        line = record.get("result")
+        if isinstance(line, dict) and "scenario" in line:
+            benchmarks[f'{line["scenario"]}/{line["phase"]}'] = {
+                "time_us_avg": line["time_us_avg"],
+                "time_us_max": line["time_us_max"],
+                "heap_peak": line["heap_peak"],
+            }
+    if benchmarks:
+        result["benchmarks"] = benchmarks
+
+    return result
+
+def collect(twister_json, depth):
+    with open(twister_json) as file:
+        report = json.load(file)
+
+    results = {}
+    for suite in report.get("testsuites", []):
+        # Skipped and failed builds have no footprint worth comparing
+        if suite.get("status") not in ("passed", "built"):
+            continue
+        result = collect_suite(suite, depth)
+        if result:
+            results[f'{suite["name"]}@{suite["platform"]}'] = result
+    return results
+
+'''
+Comparing Against The Baseline
+'''
+
+def compare_bytes(name, label, current, baseline, tolerance, failures):
+    delta = current - baseline
+    marker = ""
+    if delta > tolerance:
+        marker = f"  REGRESSION (> {tolerance} B)"
+        failures.append(f"{name} {label}")
+    if delta or marker:
+        print(f"  {label}: {baseline} -> {current} ({delta:+d} B){marker}")
+
+def compare_modules(area, current, baseline):
+    # Informational only, the totals are what fail a run. This says where a total change came from
+    changes = []
+    for module in sorted(set(current) | set(baseline)):
+        delta = current.get(module, 0) - baseline.get(module, 0)
+        if delta:
+            changes.append((abs(delta), module, delta))
+
+    for _, module, delta in sorted(changes, reverse=True)[:10]:
+        print(f"      {area} {module}: {delta:+d} B")
+
+def compare_suite(name, current, baseline, tolerances, failures, allow_missing):
+    print(name)
+
+    for area in ("ram", "rom"):
+        if area in current and area in baseline:
+            compare_bytes(name, area, current[area], baseline[area], tolerances[f"{area}_bytes"], failures)
+            compare_modules(area, current.get(f"{area}_modules", {}), baseline.get(f"{area}_modules", {}))
+
+    baseline_benchmarks = baseline.get("benchmarks", {})
+    for key, result in sorted(current.get("benchmarks", {}).items()):
+        previous = baseline_benchmarks.get(key)
+        if previous is None:
+            print(f"  {key}: no baseline")
+            if not allow_missing:
+                failures.append(f"{name} {key} (no baseline)")
+            continue
+
+        for field in ("time_us_avg", "time_us_max"):
+            limit = previous[field] * (1 + tolerances["time_percent"] / 100)
+            marker = ""
+            if result[field] > limit:
+                marker = f'  REGRESSION (> {tolerances["time_percent"]}%)'
+                failures.append(f"{name} {key} {field}")
+            if result[field] != previous[field] or marker:
+                print(f"  {key} {field}: {previous[field]} -> {result[field]} us{marker}")
+
+        compare_bytes(name, f"{key} heap_peak", result["heap_peak"], previous["heap_peak"], tolerances["heap_bytes"], failures)
+
+def check_limits(name, current, limits, failures):
+    for key, result in sorted(current.get("benchmarks", {}).items()):
+        for pattern, ceilings in sorted(limits.items()):
+            if not fnmatch.fnmatchcase(key, pattern):
+                continue
+            for field, ceiling in sorted(ceilings.items()):
+                if result[field] > ceiling:
+                    print(f"{name} {key} {field}: {result[field]} over the limit of {ceiling}")
+                    failures.append(f"{name} {key} {field} (limit)")
+
+'''
+Main
+'''
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare twister footprint and benchmark results against the committed baseline")
+    parser.add_argument("twister_json", help="twister.json from a twister run with --footprint-report all")
+    parser.add_argument("--baseline", default=DEFAULT_BASELINE, help="baseline file (default: app/regression_baseline.json)")
+    parser.add_argument("--depth", type=int, default=DEFAULT_MODULE_DEPTH, help="footprint tree depth that counts as a module (default: %(default)s)")
+    parser.add_argument("--update", action="store_true", help="write the results into the baseline instead of comparing")
+    parser.add_argument("--allow-missing", action="store_true", help="don't fail on suites or benchmarks the baseline doesn't have yet")
+    args = parser.parse_args()
+
+    results = collect(args.twister_json, args.depth)
+    if not results:
+        sys.exit(f"No passed or built test suites in {args.twister_json}")
+
+    baseline = {"tolerances": dict(DEFAULT_TOLERANCES), "suites": {}}
+    if os.path.exists(args.baseline):
+        with open(args.baseline) as file:
+            baseline = json.load(file)
+    tolerances = {**DEFAULT_TOLERANCES, **baseline.get("tolerances", {})}
+
+    if args.update:
+        # Suites that weren't part of this run keep their old baseline, e.g. benchmarks after a build-only run
+        for name, result in results.items():
+            baseline["suites"].setdefault(name, {}).update(result)
+        with open(args.baseline, "w") as file:
+            json.dump(baseline, file, indent=2, sort_keys=True)
+            file.write("\n")
+        print(f"Updated {len(results)} suites in {args.baseline}")
+        return
+
+    allow_missing = args.allow_missing
+    if not baseline["suites"]:
+        print(f"{os.path.normpath(args.baseline)} has no suites yet, reporting only. Run with --update on a real twister run and commit it\n")
+        allow_missing = True
+
+    failures = []
+    for name, result in sorted(results.items()):
+        check_limits(name, result, baseline.get("limits", {}), failures)
+
+        previous = baseline["suites"].get(name)
+        if previous is None:
+            print(f"{name}: no baseline, run with --update to add it")
+            if not allow_missing:
+                failures.append(f"{name} (no baseline)")
+            continue
+        compare_suite(name, result, previous, tolerances, failures, allow_missing)
+
+    if failures:
+        print(f"\n{len(failures)} regressions past tolerance or limits, or missing from the baseline:")
+        for failure in failures:
+            print(f"  {failure}")
+        sys.exit(1)
+    print("\nNo regressions past tolerance")
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,256 @@
+'''
+Trace Analyzer
+
+Turns a CTF trace from a tracing.conf build into per-thread timelines and latency breakdowns. The trace directory holds the
+dumped stream (channel0_0) and a copy of Zephyr's CTF metadata, see app/tracing.conf for how to capture one:
+
+    python3 scripts/trace_analyze.py trace
+    python3 scripts/trace_analyze.py trace --chrome timeline.json   # open in https://ui.perfetto.dev
+
+Decoding uses the babeltrace2 Python bindings (bt2), the same ones as Zephyr's own scripts/tracing/parse_ctf.py.
+'''
+
+import sys
+import json
+import bisect
+import argparse
+from dataclasses import dataclass, field
+from collections import defaultdict
+
+# Must match drivers/TRACE/TRACE.h
+TRACE_PHASE_BEGIN = 0
+TRACE_PHASE_END = 1
+
+# The span the frame breakdown is built around, one per super loop iteration, and the spans it is broken down into
+FRAME_SPAN = "smf_run"
+FRAME_PARTS = ("smf_entry", "lv_timer", "lv_flush")
+
+ISR = "ISR"
+
+'''
+Loading
+'''
+
+@dataclass
+class Event:
+    ns: int
+    name: str
+    fields: dict
+
+def load_events(trace_dir):
+    try:
+        import bt2
+    except ImportError:
+        sys.exit("The babeltrace2 Python bindings are needed, e.g. apt install python3-bt2")
+
+    events = []
+    for msg in bt2.TraceCollectionMessageIterator(trace_dir):
+        if type(msg) is not bt2._EventMessageConst:
+            continue
+        fields = {}
+        if msg.event.payload_field is not None:
+            for key, value in msg.event.payload_field.items():
+                fields[key] = str(value) if isinstance(value, bt2._StringFieldConst) else int(value)
+        events.append(Event(msg.default_clock_snapshot.ns_from_origin, msg.event.name, fields))
+    return events
+
+'''
+Building Timelines
+'''
+
+@dataclass
+class Span:
+    name: str
+    thread: str
+    start: int
+    end: int
+    arg: int # The begin event's argument
+
+    @property
+    def duration(self):
+        return self.end - self.start
+
+@dataclass
+class Timeline:
+    start: int = 0
+    end: int = 0
+    running: list = field(default_factory=list) # (start, end, thread or ISR), back to back and sorted
+    spans: list = field(default_factory=list) # Sorted by start
+    unmatched: int = 0 # BEGINs never closed, e.g. the trace ended inside one
+
+def thread_label(fields):
+    # Threads without a name (CONFIG_THREAD_NAME off, or never named) are told apart by their address
+    return fields.get("name") or f'0x{fields.get("thread_id", 0):08x}'
+
+def build_timeline(events):
+    timeline = Timeline()
+    if not events:
+        return timeline
+    timeline.start = events[0].ns
+    timeline.end = events[-1].ns
+
+    current = "idle" # Until the first switch the running thread is unknown
+    since = timeline.start
+    isr_depth = 0
+    open_spans = {} # (thread, name) -> (start, arg)
+
+    def switch(at, to):
+        nonlocal current, since
+        if at > since:
+            timeline.running.append((since, at, current))
+        current, since = to, at
+
+    for event in events:
+        if event.name == "thread_switched_in" and isr_depth == 0:
+            switch(event.ns, thread_label(event.fields))
+        elif event.name == "thread_switched_out" and isr_depth == 0:
+            switch(event.ns, "idle")
+        elif event.name == "isr_enter":
+            if isr_depth == 0:
+                interrupted = current
+                switch(event.ns, ISR)
+            isr_depth += 1
+        elif event.name == "isr_exit" and isr_depth > 0:
+            isr_depth -= 1
+            if isr_depth == 0:
+                switch(event.ns, interrupted)
+        elif event.name == "named_event":
+            name = event.fields["name"]
+            key = (current, name)
+            if event.fields["arg0"] == TRACE_PHASE_BEGIN:
+                if key in open_spans:
+                    timeline.unmatched += 1
+                open_spans[key] = (event.ns, event.fields["arg1"])
+            elif key in open_spans:
+                start, arg = open_spans.pop(key)
+                timeline.spans.append(Span(name, current, start, event.ns, arg))
+
+    switch(timeline.end, current)
+    timeline.unmatched += len(open_spans)
+    timeline.spans.sort(key=lambda span: span.start)
+    return timeline
+
+def running_between(timeline, start, end):
+    # Time each thread (and ISRs) ran between start and end
+    starts = [interval[0] for interval in timeline.running]
+    totals = defaultdict(int)
+    for i in range(max(bisect.bisect_right(starts, start) - 1, 0), len(timeline.running)):
+        begin, finish, who = timeline.running[i]
+        if begin >= end:
+            break
+        overlap = min(finish, end) - max(begin, start)
+        if overlap > 0:
+            totals[who] += overlap
+    return totals
+
+'''
+Reports
+'''
+
+def percentile(values, fraction):
+    ordered = sorted(values)
+    return ordered[min(int(len(ordered) * fraction), len(ordered) - 1)]
+
+def us(ns):
+    return ns / 1e3
+
+def report_threads(timeline):
+    duration = timeline.end - timeline.start
+    print(f"Trace: {us(duration) / 1e3:.1f} ms, {len(timeline.spans)} spans, {timeline.unmatched} unmatched begins\n")
+
+    print("CPU time per thread")
+    totals = running_between(timeline, timeline.start, timeline.end)
+    for who, total in sorted(totals.items(), key=lambda item: -item[1]):
+        print(f"  {who:<24} {us(total):>10.0f} us  {100 * total / duration:5.1f}%")
+    print()
+
+def report_spans(timeline):
+    by_name = defaultdict(list)
+    for span in timeline.spans:
+        by_name[span.name].append(span)
+
+    print(f'{"Span":<20} {"count":>6} {"avg us":>9} {"p95 us":>9} {"max us":>9}  threads')
+    for name, spans in sorted(by_name.items()):
+        durations = [span.duration for span in spans]
+        threads = ",".join(sorted({span.thread for span in spans}))
+        print(f"{name:<20} {len(spans):>6} {us(sum(durations) / len(durations)):>9.0f} "
+              f"{us(percentile(durations, 0.95)):>9.0f} {us(max(durations)):>9.0f}  {threads}")
+    print()
+
+def frame_breakdown(timeline, frame):
+    # Own spans nested in the frame, and time other threads and ISRs took from it
+    breakdown = defaultdict(int)
+    for span in timeline.spans:
+        if span.start >= frame.end:
+            break
+        if span.thread == frame.thread and span.start >= frame.start and span.name in FRAME_PARTS:
+            breakdown[span.name] += span.duration
+    for who, total in running_between(timeline, frame.start, frame.end).items():
+        if who != frame.thread:
+            breakdown[f"preempted:{who}"] += total
+    return breakdown
+
+def report_frames(timeline, slowest):
+    frames = [span for span in timeline.spans if span.name == FRAME_SPAN]
+    if not frames:
+        print(f"No {FRAME_SPAN} spans, nothing to break down")
+        return
+
+    # lv_flush runs inside lv_timer, so the parts overlap: preemption is the only part that adds to the others
+    average = defaultdict(int)
+    for frame in frames:
+        for part, total in frame_breakdown(timeline, frame).items():
+            average[part] += total
+
+    print(f"Average frame: {us(sum(frame.duration for frame in frames) / len(frames)):.0f} us over {len(frames)} frames")
+    for part, total in sorted(average.items(), key=lambda item: -item[1]):
+        print(f"  {part:<32} {us(total / len(frames)):>9.0f} us")
+    print()
+
+    print(f"Slowest {slowest} frames")
+    for frame in sorted(frames, key=lambda frame: -frame.duration)[:slowest]:
+        at_ms = us(frame.start - timeline.start) / 1e3
+        parts = frame_breakdown(timeline, frame)
+        detail = ", ".join(f"{part} {us(total):.0f}" for part, total in sorted(parts.items(), key=lambda item: -item[1]))
+        print(f"  at {at_ms:9.1f} ms: {us(frame.duration):7.0f} us  ({detail})")
+    print()
+
+def write_chrome_trace(timeline, path):
+    # Chrome trace event format: one row per thread for when it ran, and one per thread for its spans
+    events = []
+    for start, end, who in timeline.running:
+        if who != "idle":
+            events.append({"name": who, "ph": "X", "pid": 1, "tid": who, "ts": us(start - timeline.start), "dur": us(end - start)})
+    for span in timeline.spans:
+        events.append({"name": span.name, "ph": "X", "pid": 2, "tid": span.thread, "ts": us(span.start - timeline.start),
+                       "dur": us(span.duration), "args": {"arg": span.arg}})
+    events.append({"name": "process_name", "ph": "M", "pid": 1, "args": {"name": "Scheduling"}})
+    events.append({"name": "process_name", "ph": "M", "pid": 2, "args": {"name": "Trace points"}})
+
+    with open(path, "w") as file:
+        json.dump({"traceEvents": events}, file)
+    print(f"Wrote {len(events)} timeline events to {path}")
+
+'''
+Main
+'''
+
+def main():
+    parser = argparse.ArgumentParser(description="Per-thread timelines and latency breakdowns from a CTF trace")
+    parser.add_argument("trace_dir", help="directory holding channel0_0 and Zephyr's CTF metadata")
+    parser.add_argument("--slowest", type=int, default=10, help="how many of the slowest frames to break down (default: %(default)s)")
+    parser.add_argument("--chrome", metavar="PATH", help="also write the timeline as a Chrome/Perfetto trace")
+    args = parser.parse_args()
+
+    timeline = build_timeline(load_events(args.trace_dir))
+    if not timeline.running:
+        sys.exit(f"No events in {args.trace_dir}")
+
+    report_threads(timeline)
+    report_spans(timeline)
+    report_frames(timeline, args.slowest)
+    if args.chrome:
+        write_chrome_trace(timeline, args.chrome)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,517 @@
+/**
+ * @file main.c
+ *
+ * GATT write path tests: length and offset checks, per-core reassembly, a recorded session replayed end to end, concurrent
+ * readers and the cost of a write. The service's own write callbacks are called directly with no connection, the host
+ * stack is never enabled
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/ztest.h>
+
+#include "ble_peripheral.h"
+#include "metric_bus.h"
+#include "pipeline_status.h"
+#include "test_timing.h"
+
+/**
+ * Defines
+ */
+
+// Generations written by the stress writer, it sleeps a millisecond between them like a client at a 1 ms interval would
+#define BLE_TEST_STRESS_WRITES 1000
+#define BLE_TEST_STRESS_STACK_SIZE 2048
+// Same priority as the BT RX thread the write callbacks run on
+#define BLE_TEST_WRITER_PRIORITY K_PRIO_COOP(8)
+#define BLE_TEST_READER_PRIORITY K_PRIO_PREEMPT(5)
+// Lets simulated time move between reads on native_sim, so the writer gets to run
+#define BLE_TEST_READER_PAUSE_US 50
+
+#define BLE_TEST_COST_WRITES 256
+
+// Recording layout, see gatt_client/metric_log.py: magic, version and three length-prefixed detail strings, then records of
+// a millisecond timestamp followed by the scalar, network and percent payloads
+#define BLE_TEST_LOG_MAGIC "EIEM"
+#define BLE_TEST_LOG_VERSION 1
+#define BLE_TEST_LOG_RECORD_SIZE                                                                                      \
+    (sizeof(uint32_t) + sizeof(cpu_gpu_scalar_metrics_t) + sizeof(network_scalar_metrics_t) +                         \
+     sizeof(cpu_gpu_ram_percentage_metrics_t))
+
+// A metric write is a zbus publish to four listeners, a details write is a 64 byte copy under the sequence lock
+#if defined(CONFIG_ARCH_POSIX)
+#define BLE_TEST_METRIC_WRITE_BUDGET_CYCLES 50000 // Host cycles, a few microseconds on any recent host
+#define BLE_TEST_DETAILS_WRITE_BUDGET_CYCLES 10000
+#else
+#define BLE_TEST_METRIC_WRITE_BUDGET_CYCLES 6400 // 100 us at 64 MHz
+#define BLE_TEST_DETAILS_WRITE_BUDGET_CYCLES 1000
+#endif
+
+/**
+ * Metric bus observers
+ *
+ * Stand-ins for the app's observers, see metric_bus.h. They count like the real pipeline status and UI listeners do,
+ * the alerts subscriber is a listener here so that nothing has to drain its queue
+ */
+
+pipeline_counters_t pipeline_counters;
+
+static void ble_test_pipeline_listener_cb(const struct zbus_channel* chan) {
+    pipeline_status_count_rx();
+    pipeline_status_metric_received(metric_bus_group(chan));
+}
+
+static void ble_test_ui_listener_cb(const struct zbus_channel* chan) {
+    ble_metrics_signal_new_data();
+}
+
+static void ble_test_noop_listener_cb(const struct zbus_channel* chan) {
+}
+
+ZBUS_LISTENER_DEFINE(pipeline_status_metric_listener, ble_test_pipeline_listener_cb);
+ZBUS_LISTENER_DEFINE(state_machine_metric_listener, ble_test_ui_listener_cb);
+ZBUS_LISTENER_DEFINE(metric_history_listener, ble_test_noop_listener_cb);
+ZBUS_LISTENER_DEFINE(metric_alerts_subscriber, ble_test_noop_listener_cb);
+
+/**
+ * Local variables
+ */
+
+extern const struct bt_gatt_service_static ble_hardware_monitor_service;
+
+static const struct bt_uuid_128 ble_test_scalar_uuid = BT_UUID_INIT_128(BLE_CPU_GPU_SCALAR_METRICS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_network_uuid = BT_UUID_INIT_128(BLE_NETWORK_SCALAR_METRICS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_percent_uuid = BT_UUID_INIT_128(BLE_CPU_GPU_RAM_PERCENTAGE_METRICS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_system_details_uuid = BT_UUID_INIT_128(BLE_SYSTEM_DETAILS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_cpu_details_uuid = BT_UUID_INIT_128(BLE_CPU_DETAILS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_gpu_details_uuid = BT_UUID_INIT_128(BLE_GPU_DETAILS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_per_core_uuid = BT_UUID_INIT_128(BLE_PER_CORE_METRICS_CHARACTERISTIC);
+static const struct bt_uuid_128 ble_test_process_list_uuid = BT_UUID_INIT_128(BLE_PROCESS_LIST_CHARACTERISTIC);
+
+static K_THREAD_STACK_DEFINE(ble_test_writer_stack, BLE_TEST_STRESS_STACK_SIZE);
+static K_THREAD_STACK_DEFINE(ble_test_reader_stack, BLE_TEST_STRESS_STACK_SIZE);
+static struct k_thread ble_test_writer_thread;
+static struct k_thread ble_test_reader_thread;
+
+static atomic_t ble_test_writer_done;
+static uint32_t ble_test_reads;
+static uint32_t ble_test_torn_details;
+static uint32_t ble_test_torn_metrics;
+
+// Twelve snapshots 100 ms apart written with metric_log.MetricLogWriter, the format gatt_client.py --record produces.
+// data/session.eiem is embedded at build time, see CMakeLists.txt
+static const uint8_t ble_test_session[] = {
+#include "session.eiem.inc"
+};
+
+/**
+ * Helpers
+ */
+
+// The characteristic value attribute with the given UUID, straight from the service table
+static const struct bt_gatt_attr* ble_test_attr(const struct bt_uuid_128* uuid) {
+    for (size_t i = 0; i < ble_hardware_monitor_service.attr_count; i++) {
+        const struct bt_gatt_attr* attr = &ble_hardware_monitor_service.attrs[i];
+        if (attr->write != NULL && bt_uuid_cmp(attr->uuid, &uuid->uuid) == 0) {
+            return attr;
+        }
+    }
+    zassert_unreachable("No writable characteristic with the expected UUID");
+    return NULL;
+}
+
+static ssize_t ble_test_write(const struct bt_gatt_attr* attr, const void* buf, uint16_t len, uint16_t offset) {
+    return attr->write(NULL, attr, buf, len, offset, BT_GATT_WRITE_FLAG_CMD);
+}
+
+// One chunk carrying cores [first_core, first_core + cores). Core n has a load of 10 + n and a clock of 1000 + n MHz
+static ssize_t ble_test_per_core_chunk(uint8_t frame_id, uint8_t core_count, uint8_t first_core, uint8_t cores) {
+    uint8_t chunk[sizeof(per_core_chunk_header_t) + 8 * BLE_PER_CORE_BYTES_PER_CORE];
+    per_core_chunk_header_t* header = (per_core_chunk_header_t*) chunk;
+    uint8_t* payload = chunk + sizeof(per_core_chunk_header_t);
+
+    zassert_true(cores <= 8);
+    header->frame_id = frame_id;
+    header->core_count = core_count;
+    header->first_core = first_core;
+    header->reserved = 0;
+    for (uint8_t i = 0; i < cores; i++) {
+        payload[i] = 10 + first_core + i;
+        sys_put_le16(1000 + first_core + i, &payload[cores + i * sizeof(uint16_t)]);
+    }
+
+    return ble_test_write(ble_test_attr(&ble_test_per_core_uuid), chunk,
+                          sizeof(per_core_chunk_header_t) + cores * BLE_PER_CORE_BYTES_PER_CORE, 0);
+}
+
+// Generation n of the stress writer's strings: the length follows n, and the character follows the length, so a copy
+// that mixes two generations has the wrong character somewhere or the wrong length for its character
+static uint16_t ble_test_details_generation(uint32_t n, char* out) {
+    uint16_t len = 1 + n % BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH;
+
+    memset(out, 'a' + len % 26, len);
+    return len;
+}
+
+static bool ble_test_details_whole(const char* details) {
+    size_t len = strlen(details);
+
+    for (size_t i = 0; i < len; i++) {
+        if (details[i] != 'a' + len % 26) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Stress threads
+ */
+
+static void ble_test_writer(void* p1, void* p2, void* p3) {
+    const struct bt_gatt_attr* percent_attr = ble_test_attr(&ble_test_percent_uuid);
+    const struct bt_gatt_attr* details_attrs[] = {
+        ble_test_attr(&ble_test_system_details_uuid),
+        ble_test_attr(&ble_test_cpu_details_uuid),
+        ble_test_attr(&ble_test_gpu_details_uuid),
+    };
+    char details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH];
+
+    for (uint32_t n = 1; n <= BLE_TEST_STRESS_WRITES; n++) {
+        cpu_gpu_ram_percentage_metrics_t percent = {n, n, n};
+        uint16_t len = ble_test_details_generation(n, details);
+
+        for (int i = 0; i < ARRAY_SIZE(details_attrs); i++) {
+            ble_test_write(details_attrs[i], details, len, 0);
+        }
+        ble_test_write(percent_attr, &percent, sizeof(percent), 0);
+        k_msleep(1);
+    }
+    atomic_set(&ble_test_writer_done, 1);
+}
+
+static void ble_test_reader(void* p1, void* p2, void* p3) {
+    ble_details_snapshot_t details;
+    ble_metrics_snapshot_t metrics;
+
+    while (!atomic_get(&ble_test_writer_done)) {
+        ble_details_get(&details);
+        if (!ble_test_details_whole(details.system) || !ble_test_details_whole(details.cpu) ||
+            !ble_test_details_whole(details.gpu)) {
+            ble_test_torn_details++;
+        }
+
+        metric_bus_get(&metrics);
+        if (metrics.percent.cpu_usage_percent != metrics.percent.gpu_usage_percent ||
+            metrics.percent.cpu_usage_percent != metrics.percent.ram_usage_percent) {
+            ble_test_torn_metrics++;
+        }
+
+        ble_test_reads++;
+        k_busy_wait(BLE_TEST_READER_PAUSE_US);
+    }
+}
+
+/**
+ * Fixtures
+ */
+
+static void ble_test_before(void* fixture) {
+    memset(&pipeline_counters, 0, sizeof(pipeline_counters));
+    atomic_clear(&new_data);
+}
+
+ZTEST_SUITE(ble_write, NULL, NULL, ble_test_before, NULL, NULL);
+
+/**
+ * Tests
+ */
+
+ZTEST(ble_write, test_metric_writes_wrong_size_rejected) {
+    static const struct {
+        const struct bt_uuid_128* uuid;
+        uint16_t size;
+    } groups[] = {
+        {&ble_test_scalar_uuid, sizeof(cpu_gpu_scalar_metrics_t)},
+        {&ble_test_network_uuid, sizeof(network_scalar_metrics_t)},
+        {&ble_test_percent_uuid, sizeof(cpu_gpu_ram_percentage_metrics_t)},
+    };
+    uint8_t buf[sizeof(cpu_gpu_scalar_metrics_t) + 1];
+    ble_metrics_snapshot_t before;
+    ble_metrics_snapshot_t after;
+    int writes = 0;
+
+    memset(buf, 0x5a, sizeof(buf));
+    metric_bus_get(&before);
+
+    for (int g = 0; g < ARRAY_SIZE(groups); g++) {
+        const struct bt_gatt_attr* attr = ble_test_attr(groups[g].uuid);
+        struct {
+            uint16_t len;
+            uint16_t offset;
+        } writes_to_reject[] = {
+            {0, 0},
+            {groups[g].size - 1, 0},
+            {groups[g].size + 1, 0},
+            {groups[g].size, 1},
+        };
+
+        for (int w = 0; w < ARRAY_SIZE(writes_to_reject); w++) {
+            zassert_equal(ble_test_write(attr, buf, writes_to_reject[w].len, writes_to_reject[w].offset),
+                          BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE), "Group %d: %u bytes at offset %u accepted", g,
+                          writes_to_reject[w].len, writes_to_reject[w].offset);
+            writes++;
+        }
+    }
+
+    metric_bus_get(&after);
+    zassert_mem_equal(&before, &after, sizeof(before), "A rejected write reached the metric bus");
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), writes);
+    zassert_equal(atomic_get(&pipeline_counters.rx_updates), 0);
+    zassert_equal(atomic_get(&new_data), 0, "A rejected write flagged the UI");
+}
+
+ZTEST(ble_write, test_metric_write_published) {
+    cpu_gpu_ram_percentage_metrics_t percent = {12, 34, 56};
+    const struct bt_gatt_attr* attr = ble_test_attr(&ble_test_percent_uuid);
+    ble_metrics_snapshot_t metrics;
+
+    zassert_equal(ble_test_write(attr, &percent, sizeof(percent), 0), sizeof(percent));
+
+    metric_bus_get(&metrics);
+    zassert_mem_equal(&metrics.percent, &percent, sizeof(percent));
+    zassert_equal(atomic_get(&pipeline_counters.rx_updates), 1);
+    zassert_equal(atomic_get(&new_data), 1);
+
+    // The UI hasn't taken the first write yet, so the second one is coalesced into the same redraw
+    zassert_equal(ble_test_write(attr, &percent, sizeof(percent), 0), sizeof(percent));
+    zassert_equal(atomic_get(&pipeline_counters.rx_coalesced), 1);
+}
+
+ZTEST(ble_write, test_details_too_long_rejected) {
+    const struct bt_gatt_attr* attr = ble_test_attr(&ble_test_system_details_uuid);
+    char buf[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
+    ble_details_snapshot_t details;
+
+    memset(buf, 'x', sizeof(buf));
+    zassert_equal(ble_test_write(attr, "Linux", 5, 0), 5);
+
+    zassert_equal(ble_test_write(attr, buf, sizeof(buf), 0), BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE));
+    zassert_equal(ble_test_write(attr, buf, 4, 1), BT_GATT_ERR(BT_ATT_ERR_OUT_OF_RANGE));
+    ble_details_get(&details);
+    zassert_str_equal(details.system, "Linux", "A rejected write changed the string");
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), 2);
+
+    zassert_equal(ble_test_write(attr, buf, BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH, 0),
+                  BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH);
+    ble_details_get(&details);
+    zassert_equal(strlen(details.system), BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH, "Longest string not terminated");
+}
+
+ZTEST(ble_write, test_details_written_to_attr_user_data) {
+    char storage[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1];
+    struct bt_gatt_attr attr = *ble_test_attr(&ble_test_cpu_details_uuid);
+
+    // A copy of the attribute pointing at storage of its own, the callback must write where the attribute says
+    memset(storage, 0xff, sizeof(storage));
+    attr.user_data = storage;
+
+    zassert_equal(ble_test_write(&attr, "Ryzen 7", 7, 0), 7);
+    zassert_str_equal(storage, "Ryzen 7");
+    zassert_equal(atomic_get(&pipeline_counters.rx_updates), 1);
+    zassert_equal(atomic_get(&new_data), 1);
+}
+
+ZTEST(ble_write, test_per_core_malformed_rejected) {
+    const struct bt_gatt_attr* attr = ble_test_attr(&ble_test_per_core_uuid);
+    atomic_val_t frames = atomic_get(&ble_per_core_frames);
+    uint8_t chunk[sizeof(per_core_chunk_header_t) + 2 * BLE_PER_CORE_BYTES_PER_CORE] = {0};
+    per_core_chunk_header_t* header = (per_core_chunk_header_t*) chunk;
+    struct {
+        uint8_t core_count;
+        uint8_t first_core;
+        uint16_t len;
+    } chunks_to_reject[] = {
+        {4, 0, sizeof(per_core_chunk_header_t)}, // No cores
+        {4, 0, sizeof(per_core_chunk_header_t) + BLE_PER_CORE_BYTES_PER_CORE + 1}, // Part of a core
+        {0, 0, sizeof(chunk)}, // Empty frame
+        {BLE_PER_CORE_MAX_CORES + 1, 0, sizeof(chunk)}, // Too many cores
+        {4, 3, sizeof(chunk)}, // Runs past the end of the frame
+    };
+
+    for (int c = 0; c < ARRAY_SIZE(chunks_to_reject); c++) {
+        header->frame_id = 0x20;
+        header->core_count = chunks_to_reject[c].core_count;
+        header->first_core = chunks_to_reject[c].first_core;
+        zassert_equal(ble_test_write(attr, chunk, chunks_to_reject[c].len, 0), BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN),
+                      "Chunk %d accepted", c);
+    }
+    header->core_count = 2;
+    zassert_equal(ble_test_write(attr, chunk, sizeof(chunk), 1), BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN),
+                  "Chunk at an offset accepted");
+
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), ARRAY_SIZE(chunks_to_reject) + 1);
+    zassert_equal(atomic_get(&ble_per_core_frames), frames, "A malformed chunk completed a frame");
+}
+
+ZTEST(ble_write, test_per_core_duplicate_chunk_counted_once) {
+    atomic_val_t frames = atomic_get(&ble_per_core_frames);
+    per_core_metrics_t published;
+
+    // Three copies of the first half hold as many cores as the whole frame, but only the first half of it
+    for (int i = 0; i < 3; i++) {
+        zassert_true(ble_test_per_core_chunk(0x30, 4, 0, 2) > 0);
+    }
+    zassert_equal(atomic_get(&ble_per_core_frames), frames, "A duplicated chunk completed the frame");
+
+    zassert_true(ble_test_per_core_chunk(0x30, 4, 2, 2) > 0);
+    zassert_equal(atomic_get(&ble_per_core_frames), frames + 1, "The frame didn't complete with its last chunk");
+
+    ble_per_core_metrics_get(&published);
+    zassert_equal(published.core_count, 4);
+    for (int core = 0; core < 4; core++) {
+        zassert_equal(published.usage_percent[core], 10 + core, "Core %d load", core);
+        zassert_equal(published.clock_mhz[core], 1000 + core, "Core %d clock", core);
+    }
+
+    // A retry of the last chunk after the frame completed mustn't publish it again
+    zassert_true(ble_test_per_core_chunk(0x30, 4, 2, 2) > 0);
+    zassert_equal(atomic_get(&ble_per_core_frames), frames + 1, "A retried chunk published the frame twice");
+}
+
+ZTEST(ble_write, test_per_core_new_frame_abandons_incomplete_one) {
+    atomic_val_t frames = atomic_get(&ble_per_core_frames);
+
+    zassert_true(ble_test_per_core_chunk(0x40, 4, 0, 2) > 0);
+    // The first chunk of the next frame arrives, the old frame's second half must not complete it
+    zassert_true(ble_test_per_core_chunk(0x41, 4, 0, 2) > 0);
+    zassert_true(ble_test_per_core_chunk(0x40, 4, 2, 2) > 0);
+    zassert_equal(atomic_get(&ble_per_core_frames), frames, "Halves of two frames were published as one");
+}
+
+ZTEST(ble_write, test_process_list_offset_rejected) {
+    const struct bt_gatt_attr* attr = ble_test_attr(&ble_test_process_list_uuid);
+    uint8_t msg[4] = {0};
+
+    zassert_equal(ble_test_write(attr, msg, sizeof(msg), 1), BT_GATT_ERR(BT_ATT_ERR_INVALID_ATTRIBUTE_LEN));
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), 1);
+}
+
+ZTEST(ble_write, test_metric_log_replay) {
+    const struct bt_gatt_attr* details_attrs[] = {
+        ble_test_attr(&ble_test_system_details_uuid),
+        ble_test_attr(&ble_test_cpu_details_uuid),
+        ble_test_attr(&ble_test_gpu_details_uuid),
+    };
+    const struct bt_gatt_attr* scalar_attr = ble_test_attr(&ble_test_scalar_uuid);
+    const struct bt_gatt_attr* network_attr = ble_test_attr(&ble_test_network_uuid);
+    const struct bt_gatt_attr* percent_attr = ble_test_attr(&ble_test_percent_uuid);
+    char expected_details[ARRAY_SIZE(details_attrs)][BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH + 1] = {0};
+    size_t offset = sizeof(BLE_TEST_LOG_MAGIC) - 1;
+    const uint8_t* last_record = NULL;
+    uint32_t records = 0;
+    int64_t start_ms = k_uptime_get();
+    ble_details_snapshot_t details;
+    ble_metrics_snapshot_t metrics;
+
+    zassert_mem_equal(ble_test_session, BLE_TEST_LOG_MAGIC, offset, "Not a metric log");
+    zassert_equal(ble_test_session[offset++], BLE_TEST_LOG_VERSION);
+
+    // Sent the way gatt_client.py --replay does: the detail strings once, then every record at its recorded time, in the
+    // order send_snapshot writes the groups
+    for (int i = 0; i < ARRAY_SIZE(details_attrs); i++) {
+        uint8_t len = ble_test_session[offset++];
+
+        zassert_true(len <= BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH, "Detail string %d too long for the device", i);
+        memcpy(expected_details[i], &ble_test_session[offset], len);
+        zassert_equal(ble_test_write(details_attrs[i], &ble_test_session[offset], len, 0), len);
+        offset += len;
+    }
+
+    zassert_equal((sizeof(ble_test_session) - offset) % BLE_TEST_LOG_RECORD_SIZE, 0, "Recording ends mid-record");
+    for (; offset < sizeof(ble_test_session); offset += BLE_TEST_LOG_RECORD_SIZE) {
+        const uint8_t* scalar = &ble_test_session[offset + sizeof(uint32_t)];
+        const uint8_t* network = scalar + sizeof(cpu_gpu_scalar_metrics_t);
+        const uint8_t* percent = network + sizeof(network_scalar_metrics_t);
+
+        k_sleep(K_TIMEOUT_ABS_MS(start_ms + sys_get_le32(&ble_test_session[offset])));
+        zassert_equal(ble_test_write(scalar_attr, scalar, sizeof(cpu_gpu_scalar_metrics_t), 0),
+                      sizeof(cpu_gpu_scalar_metrics_t), "Record %u: scalar write refused", records);
+        zassert_equal(ble_test_write(percent_attr, percent, sizeof(cpu_gpu_ram_percentage_metrics_t), 0),
+                      sizeof(cpu_gpu_ram_percentage_metrics_t), "Record %u: percent write refused", records);
+        zassert_equal(ble_test_write(network_attr, network, sizeof(network_scalar_metrics_t), 0),
+                      sizeof(network_scalar_metrics_t), "Record %u: network write refused", records);
+        last_record = scalar;
+        records++;
+    }
+
+    zassert_true(records > 0, "Empty recording");
+    zassert_equal(atomic_get(&pipeline_counters.rx_updates), ARRAY_SIZE(details_attrs) + 3 * records);
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), 0);
+
+    // The bus holds the last record, group by group
+    metric_bus_get(&metrics);
+    zassert_mem_equal(&metrics.scalar, last_record, sizeof(metrics.scalar));
+    zassert_mem_equal(&metrics.network, last_record + sizeof(metrics.scalar), sizeof(metrics.network));
+    zassert_mem_equal(&metrics.percent, last_record + sizeof(metrics.scalar) + sizeof(metrics.network),
+                      sizeof(metrics.percent));
+
+    ble_details_get(&details);
+    zassert_str_equal(details.system, expected_details[0]);
+    zassert_str_equal(details.cpu, expected_details[1]);
+    zassert_str_equal(details.gpu, expected_details[2]);
+}
+
+ZTEST(ble_write, test_concurrent_reads_never_torn) {
+    atomic_clear(&ble_test_writer_done);
+    ble_test_reads = 0;
+    ble_test_torn_details = 0;
+    ble_test_torn_metrics = 0;
+
+    k_thread_create(&ble_test_reader_thread, ble_test_reader_stack, K_THREAD_STACK_SIZEOF(ble_test_reader_stack),
+                    ble_test_reader, NULL, NULL, NULL, BLE_TEST_READER_PRIORITY, 0, K_NO_WAIT);
+    k_thread_create(&ble_test_writer_thread, ble_test_writer_stack, K_THREAD_STACK_SIZEOF(ble_test_writer_stack),
+                    ble_test_writer, NULL, NULL, NULL, BLE_TEST_WRITER_PRIORITY, 0, K_NO_WAIT);
+
+    zassert_ok(k_thread_join(&ble_test_writer_thread, K_FOREVER));
+    zassert_ok(k_thread_join(&ble_test_reader_thread, K_FOREVER));
+
+    TC_PRINT("%u reads against %d writes\n", ble_test_reads, BLE_TEST_STRESS_WRITES);
+    zassert_true(ble_test_reads > BLE_TEST_STRESS_WRITES, "The reader barely ran");
+    zassert_equal(ble_test_torn_details, 0, "%u torn detail string reads", ble_test_torn_details);
+    zassert_equal(ble_test_torn_metrics, 0, "%u torn metric reads", ble_test_torn_metrics);
+}
+
+ZTEST(ble_write, test_write_callback_cost) {
+    const struct bt_gatt_attr* percent_attr = ble_test_attr(&ble_test_percent_uuid);
+    const struct bt_gatt_attr* details_attr = ble_test_attr(&ble_test_gpu_details_uuid);
+    char details[BLE_CUSTOM_CHARACTERISTIC_MAX_DATA_LENGTH];
+    uint64_t metric_cycles = 0;
+    uint64_t details_cycles = 0;
+
+    TEST_TIMING_REQUIRE();
+    memset(details, 'g', sizeof(details));
+
+    for (uint32_t n = 0; n < BLE_TEST_COST_WRITES; n++) {
+        cpu_gpu_ram_percentage_metrics_t percent = {n % 100, n % 100, n % 100};
+        uint64_t start = test_timing_cycles();
+        ble_test_write(percent_attr, &percent, sizeof(percent), 0);
+        metric_cycles += test_timing_cycles() - start;
+
+        start = test_timing_cycles();
+        ble_test_write(details_attr, details, sizeof(details), 0);
+        details_cycles += test_timing_cycles() - start;
+    }
+
+    unsigned long long metric_per_write = metric_cycles / BLE_TEST_COST_WRITES;
+    unsigned long long details_per_write = details_cycles / BLE_TEST_COST_WRITES;
+
+    TC_PRINT("Metric write: %llu cycles (budget %d), details write: %llu cycles (budget %d)\n", metric_per_write,
+             BLE_TEST_METRIC_WRITE_BUDGET_CYCLES, details_per_write, BLE_TEST_DETAILS_WRITE_BUDGET_CYCLES);
+    zassert_equal(atomic_get(&pipeline_counters.rx_rejected), 0);
+    zassert_true(metric_per_write <= BLE_TEST_METRIC_WRITE_BUDGET_CYCLES, "Metric write took %llu cycles",
+                 metric_per_write);
+    zassert_true(details_per_write <= BLE_TEST_DETAILS_WRITE_BUDGET_CYCLES, "Details write took %llu cycles",
+                 details_per_write);
+}
@@ -0,0 +1,137 @@
+/**
+ * @file central.c
+ *
+ * Device 1: connects to the peripheral at the shortest interval a client may ask for and writes the percent group with
+ * Write Without Response at each rate of the sweep, the way gatt_client.py --sweep does against real hardware
+ */
+
+#include <zephyr/bluetooth/bluetooth.h>
+#include <zephyr/bluetooth/conn.h>
+#include <zephyr/bluetooth/gatt.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "babblekit/sync.h"
+#include "babblekit/testcase.h"
+#include "ble_peripheral.h"
+#include "ingest.h"
+
+/**
+ * Local variables
+ */
+
+static const struct bt_uuid_128 ingest_percent_uuid = BT_UUID_INIT_128(BLE_CPU_GPU_RAM_PERCENTAGE_METRICS_CHARACTERISTIC);
+
+static struct bt_conn* ingest_conn;
+static struct bt_gatt_discover_params ingest_discover_params;
+static uint16_t ingest_percent_handle;
+
+static K_SEM_DEFINE(ingest_connected_sem, 0, 1);
+static K_SEM_DEFINE(ingest_discovered_sem, 0, 1);
+
+/**
+ * Connection
+ */
+
+static void ingest_device_found(const bt_addr_le_t* addr, int8_t rssi, uint8_t type, struct net_buf_simple* ad) {
+    // The peripheral is the only device advertising in the simulation
+    if (ingest_conn != NULL || type != BT_GAP_ADV_TYPE_ADV_IND || bt_le_scan_stop() != 0) {
+        return;
+    }
+
+    int err = bt_conn_le_create(addr, BT_CONN_LE_CREATE_CONN,
+        BT_LE_CONN_PARAM(INGEST_CONN_INTERVAL, INGEST_CONN_INTERVAL, 0, INGEST_CONN_TIMEOUT), &ingest_conn);
+
+    TEST_ASSERT(err == 0, "Connecting failed (err %d)", err);
+}
+
+// Both roles share this image, the peripheral sees its own connection here too and ignores it
+static void ingest_connected_cb(struct bt_conn* conn, uint8_t err) {
+    if (conn != ingest_conn) {
+        return;
+    }
+    TEST_ASSERT(err == 0, "Connection failed (err 0x%02x)", err);
+    k_sem_give(&ingest_connected_sem);
+}
+
+BT_CONN_CB_DEFINE(ingest_central_conn_callbacks) = {
+    .connected = ingest_connected_cb,
+};
+
+static uint8_t ingest_discover_cb(struct bt_conn* conn, const struct bt_gatt_attr* attr,
+                                  struct bt_gatt_discover_params* params) {
+    if (attr != NULL) {
+        const struct bt_gatt_chrc* chrc = attr->user_data;
+        ingest_percent_handle = chrc->value_handle;
+    }
+    k_sem_give(&ingest_discovered_sem);
+    return BT_GATT_ITER_STOP;
+}
+
+/**
+ * Steps
+ */
+
+// Writes the percent group every 1 / rate_hz, tagged with the step and a sequence number that only counts writes the
+// stack took. A slot that couldn't start within its own period is skipped rather than sent in a burst
+static void ingest_central_step(uint32_t step, uint32_t rate_hz) {
+    uint32_t period_us = USEC_PER_SEC / rate_hz;
+    uint32_t slots = rate_hz * INGEST_STEP_MS / 1000;
+    uint32_t sent = 0;
+    uint32_t late = 0;
+    uint32_t failed = 0;
+    int64_t start_us = k_ticks_to_us_floor64(k_uptime_ticks());
+
+    for (uint32_t slot = 0; slot < slots; slot++) {
+        int64_t due_us = start_us + (int64_t) slot * period_us;
+
+        k_sleep(K_TIMEOUT_ABS_US(due_us));
+        if (k_ticks_to_us_floor64(k_uptime_ticks()) >= due_us + period_us) {
+            late++;
+            continue;
+        }
+
+        cpu_gpu_ram_percentage_metrics_t percent = {.cpu_usage_percent = sent, .gpu_usage_percent = step};
+        if (bt_gatt_write_without_response(ingest_conn, ingest_percent_handle, &percent, sizeof(percent), false)) {
+            failed++;
+        } else {
+            sent++;
+        }
+    }
+
+    printk("INGEST central {\"rate_hz\":%u,\"slots\":%u,\"sent\":%u,\"late\":%u,\"failed\":%u}\n", rate_hz, slots, sent,
+           late, failed);
+    TEST_ASSERT(sent * 100 >= slots * INGEST_MIN_SENT_PERCENT, "%u Hz: only %u of %u slots sent (%u late, %u failed)",
+                rate_hz, sent, slots, late, failed);
+}
+
+/**
+ * Entry point
+ */
+
+void ingest_central_main() {
+    static const uint32_t rates_hz[] = INGEST_RATES_HZ;
+
+    TEST_ASSERT(bk_sync_init() == 0, "Backchannel to the peripheral failed");
+    TEST_ASSERT(bt_enable(NULL) == 0, "Bluetooth failed to start");
+    TEST_ASSERT(bt_le_scan_start(BT_LE_SCAN_PASSIVE, ingest_device_found) == 0, "Scanning failed to start");
+    k_sem_take(&ingest_connected_sem, K_FOREVER);
+
+    ingest_discover_params.uuid = &ingest_percent_uuid.uuid;
+    ingest_discover_params.func = ingest_discover_cb;
+    ingest_discover_params.start_handle = BT_ATT_FIRST_ATTRIBUTE_HANDLE;
+    ingest_discover_params.end_handle = BT_ATT_LAST_ATTRIBUTE_HANDLE;
+    ingest_discover_params.type = BT_GATT_DISCOVER_CHARACTERISTIC;
+    TEST_ASSERT(bt_gatt_discover(ingest_conn, &ingest_discover_params) == 0, "Discovery failed to start");
+    k_sem_take(&ingest_discovered_sem, K_FOREVER);
+    TEST_ASSERT(ingest_percent_handle != 0, "No percent metrics characteristic on the peripheral");
+
+    for (uint32_t step = 0; step < ARRAY_SIZE(rates_hz); step++) {
+        bk_sync_wait(); // The peripheral has reset its tallies
+        ingest_central_step(step, rates_hz[step]);
+        k_msleep(INGEST_DRAIN_MS);
+        bk_sync_send(); // Everything sent has had time to land
+    }
+
+    TEST_PASS("Sent every step of the sweep");
+}
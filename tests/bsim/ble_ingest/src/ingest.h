@@ -0,0 +1,55 @@
+/**
+ * @file ingest.h
+ */
+
+#ifndef INGEST_H
+#define INGEST_H
+
+/**
+ * Includes
+ */
+
+#include <stdint.h>
+
+#include "pipeline_status.h"
+
+/**
+ * Defines
+ */
+
+// The central writes the percent group at each rate in turn for INGEST_STEP_MS, then waits INGEST_DRAIN_MS for the last
+// writes to land before both sides compare notes. The peripheral's client heartbeats at well under 1 Hz, the sweep goes
+// far past that to find where ingest falls behind
+#define INGEST_RATES_HZ {50, 100, 200}
+#define INGEST_STEP_MS 2000
+#define INGEST_DRAIN_MS 200
+
+// 7.5 ms, the shortest interval a client may ask for, in 1.25 ms units
+#define INGEST_CONN_INTERVAL 6
+#define INGEST_CONN_TIMEOUT 400
+
+/**
+ * Pass/fail thresholds, checked at every rate
+ *
+ * Not tuned yet: these are first guesses until the sweep has been run, in particular 95% at 200 writes/s
+ *
+ * - The central must get at least INGEST_MIN_SENT_PERCENT of its slots out on time (a slot a period late is skipped)
+ * - The peripheral must accept at least INGEST_MIN_ACCEPTED_PERCENT of the nominal rate, with no write dropped or refused
+ * - No accepted write may wait longer than one render budget for the (stand-in) UI to take it
+ */
+#define INGEST_MIN_SENT_PERCENT 95
+#define INGEST_MIN_ACCEPTED_PERCENT 95
+#define INGEST_MAX_LATENCY_MS PIPELINE_RENDER_BUDGET_MS
+
+// The stand-in UI takes new_data as often as the app's super loop runs, see SLEEP_MS
+#define INGEST_UI_PERIOD_MS 5
+
+/**
+ * Function prototypes
+ */
+
+// Test entry points, one per device, see main.c
+void ingest_peripheral_main();
+void ingest_central_main();
+
+#endif
@@ -0,0 +1,38 @@
+/**
+ * @file main.c
+ *
+ * GATT ingest sweep between two simulated nRF52s: device 0 runs the app's hardware monitor service, device 1 is a
+ * central writing the percent group at increasing rates. See tests_scripts/ingest_sweep.sh
+ */
+
+#include "bstests.h"
+#include "ingest.h"
+
+/**
+ * Test registration
+ */
+
+static const struct bst_test_instance ingest_tests[] = {
+    {
+        .test_id = "peripheral",
+        .test_descr = "Runs the hardware monitor service and checks every write is accepted and shown in time",
+        .test_main_f = ingest_peripheral_main,
+    },
+    {
+        .test_id = "central",
+        .test_descr = "Writes the percent group at each rate of the sweep",
+        .test_main_f = ingest_central_main,
+    },
+    BSTEST_END_MARKER,
+};
+
+static struct bst_test_list* ingest_install(struct bst_test_list* tests) {
+    return bst_add_tests(tests, ingest_tests);
+}
+
+bst_test_install_t test_installers[] = {ingest_install, NULL};
+
+int main(void) {
+    bst_main();
+    return 0;
+}
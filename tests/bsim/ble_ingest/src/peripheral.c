@@ -0,0 +1,164 @@
+/**
+ * @file peripheral.c
+ *
+ * Device 0: advertises the app's hardware monitor service and, after each step of the central's sweep, checks how many
+ * writes were accepted, whether any were dropped or refused, and how long they waited for the UI
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/printk.h>
+
+#include "babblekit/sync.h"
+#include "babblekit/testcase.h"
+#include "ble_peripheral.h"
+#include "ingest.h"
+#include "metric_bus.h"
+#include "pipeline_status.h"
+
+/**
+ * Local variables
+ */
+
+extern struct bt_data ble_advertising_data[];
+extern struct bt_data ble_scan_response_data[];
+extern size_t advertising_data_array_size;
+extern size_t scan_response_data_array_size;
+
+pipeline_counters_t pipeline_counters;
+
+// What arrived during the current step, only touched by the BT RX thread until the step is over
+static struct {
+    uint32_t accepted;
+    uint32_t next_sequence; // One past the highest sequence number seen, the number of writes the central got out
+    uint32_t stray; // Writes tagged with another step
+} ingest_step;
+static uint32_t ingest_step_index;
+
+// Write to UI latency, sampled once per UI pass that had something new
+static struct {
+    uint32_t samples;
+    uint64_t total_us;
+    uint32_t max_us;
+} ingest_latency;
+
+static K_THREAD_STACK_DEFINE(ingest_ui_stack, 1024);
+static struct k_thread ingest_ui_thread;
+
+/**
+ * Metric bus observers
+ *
+ * Stand-ins for the app's observers, see metric_bus.h. Like the real ones, the pipeline status listener counts the write
+ * and starts the ingest latency clock, and the UI listener flags new data. The pipeline status listener also tallies
+ * what arrived in each step
+ */
+
+static void ingest_pipeline_listener_cb(const struct zbus_channel* chan) {
+    pipeline_status_count_rx();
+    pipeline_status_metric_received(metric_bus_group(chan));
+
+    if (chan == &metric_percent_chan) {
+        const cpu_gpu_ram_percentage_metrics_t* percent = zbus_chan_const_msg(chan);
+
+        if (percent->gpu_usage_percent != ingest_step_index) {
+            ingest_step.stray++;
+            return;
+        }
+        ingest_step.accepted++;
+        ingest_step.next_sequence = MAX(ingest_step.next_sequence, percent->cpu_usage_percent + 1);
+    }
+}
+
+static void ingest_ui_listener_cb(const struct zbus_channel* chan) {
+    ble_metrics_signal_new_data();
+}
+
+static void ingest_noop_listener_cb(const struct zbus_channel* chan) {
+}
+
+ZBUS_LISTENER_DEFINE(pipeline_status_metric_listener, ingest_pipeline_listener_cb);
+ZBUS_LISTENER_DEFINE(state_machine_metric_listener, ingest_ui_listener_cb);
+ZBUS_LISTENER_DEFINE(metric_history_listener, ingest_noop_listener_cb);
+ZBUS_LISTENER_DEFINE(metric_alerts_subscriber, ingest_noop_listener_cb);
+
+/**
+ * Stand-in UI
+ */
+
+// Takes new_data every super loop pass like the UI does, and times how long the oldest write behind it waited
+static void ingest_ui(void* p1, void* p2, void* p3) {
+    while (1) {
+        k_msleep(INGEST_UI_PERIOD_MS);
+
+        if (!atomic_get(&new_data)) {
+            continue;
+        }
+        // Clearing the clock before the flag errs long: a write landing in between keeps its start time for the next pass
+        uint32_t first = atomic_clear(&pipeline_counters.ingest_start_cycles);
+        atomic_clear(&new_data);
+        if (first) {
+            uint32_t latency_us = k_cyc_to_us_floor32(k_cycle_get_32() - first);
+            ingest_latency.samples++;
+            ingest_latency.total_us += latency_us;
+            ingest_latency.max_us = MAX(ingest_latency.max_us, latency_us);
+        }
+    }
+}
+
+/**
+ * Steps
+ */
+
+static void ingest_step_reset(uint32_t step) {
+    memset(&ingest_step, 0, sizeof(ingest_step));
+    memset(&ingest_latency, 0, sizeof(ingest_latency));
+    atomic_clear(&pipeline_counters.rx_rejected);
+    ingest_step_index = step;
+}
+
+// Prints the step as an INGEST JSON line and checks it against the thresholds in ingest.h
+static void ingest_step_check(uint32_t rate_hz) {
+    uint32_t nominal = rate_hz * INGEST_STEP_MS / 1000;
+    uint32_t dropped = ingest_step.next_sequence - ingest_step.accepted;
+    uint32_t rejected = atomic_get(&pipeline_counters.rx_rejected);
+    uint32_t average_us = ingest_latency.samples ? ingest_latency.total_us / ingest_latency.samples : 0;
+
+    printk("INGEST {\"rate_hz\":%u,\"accepted\":%u,\"accepted_per_s\":%u,\"dropped\":%u,\"stray\":%u,\"rejected\":%u,"
+           "\"latency_avg_us\":%u,\"latency_max_us\":%u}\n",
+           rate_hz, ingest_step.accepted, ingest_step.accepted * 1000 / INGEST_STEP_MS, dropped, ingest_step.stray,
+           rejected, average_us, ingest_latency.max_us);
+
+    TEST_ASSERT(ingest_step.accepted * 100 >= nominal * INGEST_MIN_ACCEPTED_PERCENT,
+                "%u Hz: accepted %u of %u writes", rate_hz, ingest_step.accepted, nominal);
+    TEST_ASSERT(dropped == 0, "%u Hz: %u writes dropped", rate_hz, dropped);
+    TEST_ASSERT(ingest_step.stray == 0 && rejected == 0, "%u Hz: %u stray and %u rejected writes", rate_hz,
+                ingest_step.stray, rejected);
+    TEST_ASSERT(ingest_latency.max_us <= INGEST_MAX_LATENCY_MS * USEC_PER_MSEC,
+                "%u Hz: a write waited %u us for the UI", rate_hz, ingest_latency.max_us);
+}
+
+/**
+ * Entry point
+ */
+
+void ingest_peripheral_main() {
+    static const uint32_t rates_hz[] = INGEST_RATES_HZ;
+
+    TEST_ASSERT(bk_sync_init() == 0, "Backchannel to the central failed");
+    TEST_ASSERT(bt_enable(NULL) == 0, "Bluetooth failed to start");
+    TEST_ASSERT(bt_le_adv_start(BT_LE_ADV_CONN_FAST_1, ble_advertising_data, advertising_data_array_size,
+                                ble_scan_response_data, scan_response_data_array_size) == 0,
+                "Advertising failed to start");
+
+    k_thread_create(&ingest_ui_thread, ingest_ui_stack, K_THREAD_STACK_SIZEOF(ingest_ui_stack), ingest_ui, NULL, NULL,
+                    NULL, K_PRIO_PREEMPT(5), 0, K_NO_WAIT);
+
+    for (uint32_t step = 0; step < ARRAY_SIZE(rates_hz); step++) {
+        ingest_step_reset(step);
+        bk_sync_send(); // Ready for the step
+        bk_sync_wait(); // The central has sent it and let it drain
+        ingest_step_check(rates_hz[step]);
+    }
+
+    TEST_PASS("Ingest kept up at every rate");
+}
@@ -0,0 +1,24 @@
+#!/usr/bin/env bash
+# SPDX-License-Identifier: Apache-2.0
+#
+# GATT ingest sweep between two simulated nRF52s, see src/ingest.h for the rates and thresholds. tests/bsim/run.sh builds
+# the image with twister and then runs this script.
+# Both devices print INGEST JSON lines per rate, the script fails if either device fails a threshold
+
+source ${ZEPHYR_BASE}/tests/bsim/sh_common.source
+
+simulation_id="ble_ingest"
+verbosity_level=2
+EXECUTE_TIMEOUT=120
+
+cd ${BSIM_OUT_PATH}/bin
+
+Execute ./bs_${BOARD_TS}_app_ble_ingest \
+  -v=${verbosity_level} -s=${simulation_id} -d=0 -RealEncryption=0 -testid=peripheral
+
+Execute ./bs_${BOARD_TS}_app_ble_ingest \
+  -v=${verbosity_level} -s=${simulation_id} -d=1 -RealEncryption=0 -testid=central
+
+Execute ./bs_2G4_phy_v1 -v=${verbosity_level} -s=${simulation_id} -D=2 -sim_length=20e6 $@
+
+wait_for_background_jobs
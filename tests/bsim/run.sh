@@ -0,0 +1,35 @@
+#!/usr/bin/env bash
+# SPDX-License-Identifier: Apache-2.0
+#
+# Builds every BabbleSim test under tests/bsim with twister, then runs each test's tests_scripts against the images it
+# built. Twister alone only builds them (build_only), so this is the one command that actually checks the thresholds:
+#   tests/bsim/run.sh
+# Needs ZEPHYR_BASE, BSIM_OUT_PATH and BSIM_COMPONENTS_PATH, see the README. Extra arguments are passed on to twister
+
+set -u
+
+tests_dir=$(cd "$(dirname "${BASH_SOURCE[0]}")" && pwd)
+
+: "${ZEPHYR_BASE:?Set ZEPHYR_BASE to the zephyr checkout of the west workspace}"
+: "${BSIM_OUT_PATH:?Set BSIM_OUT_PATH to the BabbleSim build, see the README}"
+: "${BSIM_COMPONENTS_PATH:?Set BSIM_COMPONENTS_PATH to \$BSIM_OUT_PATH/components}"
+
+# The images are named after the platform, with its '/' replaced, and the scripts look them up through BOARD_TS
+export BOARD_TS=${BOARD_TS:-nrf52_bsim_native}
+
+west twister -T "${tests_dir}" -p nrf52_bsim/native "$@" || exit 1
+
+failed=0
+for script in "${tests_dir}"/*/tests_scripts/*.sh; do
+  echo "Running ${script#${tests_dir}/}"
+  if ! "${script}"; then
+    echo "FAILED ${script#${tests_dir}/}"
+    failed=$((failed + 1))
+  fi
+done
+
+if [ ${failed} -ne 0 ]; then
+  echo "${failed} BabbleSim test scripts failed"
+  exit 1
+fi
+echo "All BabbleSim test scripts passed"
@@ -0,0 +1,72 @@
+/**
+ * @file test_timing.h
+ */
+
+#ifndef TEST_TIMING_H
+#define TEST_TIMING_H
+
+/**
+ * Includes
+ */
+
+#include <stdint.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+/**
+ * Cycle counter for cost assertions
+ *
+ * native_sim doesn't advance simulated time while code runs, so k_cycle_get_32 reads the same value before and after a call.
+ * There the host's time stamp counter is read instead, and budgets are in host cycles. On hardware the timing API reads the
+ * CPU's own cycle counter (DWT on Cortex-M), k_cycle_get_32 is the 32 kHz RTC on nRF and far too coarse for a single call
+ */
+
+#if defined(CONFIG_ARCH_POSIX) && (defined(__x86_64__) || defined(__i386__))
+
+#define TEST_TIMING_SUPPORTED 1
+
+static inline void test_timing_init() {
+}
+
+static inline uint64_t test_timing_cycles() {
+    return __builtin_ia32_rdtsc();
+}
+
+#elif defined(CONFIG_TIMING_FUNCTIONS)
+
+#include <zephyr/timing/timing.h>
+
+#define TEST_TIMING_SUPPORTED 1
+
+static inline void test_timing_init() {
+    timing_init();
+    timing_start();
+}
+
+static inline uint64_t test_timing_cycles() {
+    return timing_counter_get();
+}
+
+#else
+
+#define TEST_TIMING_SUPPORTED 0
+
+static inline void test_timing_init() {
+}
+
+static inline uint64_t test_timing_cycles() {
+    return 0;
+}
+
+#endif
+
+// Skips the calling test where there is no cycle counter to measure with
+#define TEST_TIMING_REQUIRE()                                               \
+    do {                                                                    \
+        if (!TEST_TIMING_SUPPORTED) {                                       \
+            ztest_test_skip();                                              \
+        }                                                                   \
+        test_timing_init();                                                 \
+    } while (0)
+
+#endif
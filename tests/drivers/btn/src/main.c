@@ -0,0 +1,155 @@
+/**
+ * @file main.c
+ *
+ * Button driver tests: debounce timing, polarity and id checks, with the buttons driven through the GPIO emulator
+ */
+
+#include <zephyr/drivers/gpio.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "BTN.h"
+
+/**
+ * Defines
+ */
+
+// Margin either side of a debounce deadline, covers the tick a delayed work item is rounded up by
+#define BTN_TEST_MARGIN_MS 2
+
+// Long enough for any pending debounce to have run
+#define BTN_TEST_SETTLE_MS (2 * BTN_DEBOUNCE_MS)
+
+BUILD_ASSERT(NUM_BTNS == 2, "The test overlay defines two buttons");
+
+/**
+ * Local variables
+ */
+
+static const struct gpio_dt_spec btn_test_specs[NUM_BTNS] = {
+    GPIO_DT_SPEC_GET(DT_NODELABEL(button0), gpios),
+    GPIO_DT_SPEC_GET(DT_NODELABEL(button1), gpios),
+};
+
+/**
+ * Helpers
+ */
+
+// Drives the pin to the level a pressed or released button would, honouring the button's polarity
+static void btn_test_set(btn_id btn, bool pressed) {
+    const struct gpio_dt_spec* spec = &btn_test_specs[btn];
+    bool active_low = spec->dt_flags & GPIO_ACTIVE_LOW;
+
+    zassert_ok(gpio_emul_input_set(spec->port, spec->pin, pressed != active_low));
+}
+
+static void btn_test_release_all() {
+    for (int i = 0; i < NUM_BTNS; i++) {
+        btn_test_set(i, false);
+    }
+}
+
+/**
+ * Fixtures
+ */
+
+static void* btn_test_setup(void) {
+    zassert_ok(BTN_init());
+    return NULL;
+}
+
+static void btn_test_before(void* fixture) {
+    btn_test_release_all();
+    k_msleep(BTN_TEST_SETTLE_MS);
+    for (int i = 0; i < NUM_BTNS; i++) {
+        BTN_clear_pressed(i);
+    }
+}
+
+ZTEST_SUITE(btn, NULL, btn_test_setup, btn_test_before, NULL, NULL);
+
+/**
+ * Tests
+ */
+
+ZTEST(btn, test_press_counts_after_debounce) {
+    btn_test_set(BTN0, true);
+
+    k_msleep(BTN_DEBOUNCE_MS - BTN_TEST_MARGIN_MS);
+    zassert_false(BTN_check_pressed(BTN0), "Press counted before the debounce window closed");
+
+    k_msleep(2 * BTN_TEST_MARGIN_MS);
+    zassert_true(BTN_check_pressed(BTN0), "Press not counted %d ms after the edge", BTN_DEBOUNCE_MS + BTN_TEST_MARGIN_MS);
+    zassert_false(BTN_check_pressed(BTN1), "Press counted on the wrong button");
+}
+
+ZTEST(btn, test_bounce_restarts_debounce) {
+    // Three edges 5 ms apart, the window only starts at the last one
+    for (int i = 0; i < 3; i++) {
+        btn_test_set(BTN0, true);
+        k_msleep(3);
+        if (i < 2) {
+            btn_test_set(BTN0, false);
+            k_msleep(2);
+        }
+    }
+
+    k_msleep(BTN_DEBOUNCE_MS - 3 - BTN_TEST_MARGIN_MS);
+    zassert_false(BTN_check_pressed(BTN0), "Press counted before the window after the last bounce closed");
+
+    k_msleep(2 * BTN_TEST_MARGIN_MS);
+    zassert_true(BTN_check_pressed(BTN0));
+}
+
+ZTEST(btn, test_glitch_ignored) {
+    btn_test_set(BTN0, true);
+    k_msleep(BTN_DEBOUNCE_MS / 2);
+    btn_test_set(BTN0, false);
+
+    k_msleep(BTN_TEST_SETTLE_MS);
+    zassert_false(BTN_check_pressed(BTN0), "A glitch shorter than the debounce window counted as a press");
+}
+
+ZTEST(btn, test_release_doesnt_press) {
+    btn_test_set(BTN0, true);
+    k_msleep(BTN_TEST_SETTLE_MS);
+    BTN_clear_pressed(BTN0);
+
+    btn_test_set(BTN0, false);
+    k_msleep(BTN_TEST_SETTLE_MS);
+    zassert_false(BTN_check_pressed(BTN0), "Releasing the button counted as a press");
+}
+
+ZTEST(btn, test_active_low_button) {
+    zassert_false(BTN_is_pressed(BTN1));
+
+    btn_test_set(BTN1, true);
+    zassert_true(BTN_is_pressed(BTN1), "Active low button not pressed with its pin low");
+
+    k_msleep(BTN_DEBOUNCE_MS + BTN_TEST_MARGIN_MS);
+    zassert_true(BTN_check_pressed(BTN1));
+}
+
+ZTEST(btn, test_pressed_flag_latches_until_cleared) {
+    btn_test_set(BTN0, true);
+    k_msleep(BTN_DEBOUNCE_MS + BTN_TEST_MARGIN_MS);
+    btn_test_set(BTN0, false);
+
+    zassert_false(BTN_is_pressed(BTN0));
+    zassert_true(BTN_check_pressed(BTN0), "Pressed flag lost on release");
+    zassert_true(BTN_check_pressed(BTN0), "BTN_check_pressed cleared the flag");
+    zassert_true(BTN_check_clear_pressed(BTN0));
+    zassert_false(BTN_check_clear_pressed(BTN0), "BTN_check_clear_pressed didn't clear the flag");
+}
+
+ZTEST(btn, test_invalid_ids) {
+    btn_id invalid[] = {NUM_BTNS, NUM_BTNS + 1, (btn_id) -1};
+
+    for (int i = 0; i < ARRAY_SIZE(invalid); i++) {
+        zassert_false(BTN_is_pressed(invalid[i]));
+        zassert_false(BTN_check_pressed(invalid[i]));
+        zassert_false(BTN_check_clear_pressed(invalid[i]));
+        BTN_clear_pressed(invalid[i]);
+    }
+}
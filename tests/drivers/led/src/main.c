@@ -0,0 +1,287 @@
+/**
+ * @file main.c
+ *
+ * LED driver tests: duty cycle mapping, blink periods, id checks and the command ring, against a fake PWM controller.
+ * The brightness mapping shared with the nRF waveform path is checked on its own, since that path needs real hardware
+ */
+
+#include <zephyr/drivers/pwm.h>
+#include <zephyr/drivers/pwm/pwm_fake.h>
+#include <zephyr/fff.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+
+#include "LED.h"
+#include "test_timing.h"
+
+DEFINE_FFF_GLOBALS;
+
+/**
+ * Defines
+ */
+
+// The overlay's period, in cycles of the fake controller's 1 MHz clock
+#define LED_TEST_PERIOD_CYCLES 20000
+// LEDs are active low, so the pulse is the off time
+#define LED_TEST_PULSE(duty) ((LED_TEST_PERIOD_CYCLES / 100) * (100 - (duty)))
+
+// Periods the brightness mapping is used with: the test overlay's, the largest nRF PWM COUNTERTOP (waveform steps) and a
+// 20 ms period in ns (the Zephyr PWM API on hardware)
+#define LED_TEST_MAPPING_PERIODS {LED_TEST_PERIOD_CYCLES, 32767, 20000000}
+
+// Long enough for the engine to apply everything posted before it
+#define LED_TEST_SETTLE_MS 10
+
+// Blink edges recorded per run, and how far a half period may stray from 500 ms / frequency. The engine ticks every
+// 31 ms, so half periods land on whole ticks: within 1% of nominal at every supported frequency
+#define LED_TEST_MAX_EDGES 16
+#define LED_TEST_BLINK_EDGES 6
+#define LED_TEST_BLINK_TOLERANCE_PERCENT 5
+
+// More than the command ring holds, so a burst posted with the engine held off overflows it
+#define LED_TEST_BURST 64
+
+// Calls timed in each batch, the engine drains the ring between batches so no call is timed against a full ring
+#define LED_TEST_COST_BATCH 8
+#define LED_TEST_COST_BATCHES 16
+
+// Posting a command is a few atomics and a semaphore give, and never waits for the engine or the PWM driver
+#if defined(CONFIG_ARCH_POSIX)
+#define LED_TEST_PWM_BUDGET_CYCLES 20000 // Host cycles, a few microseconds on any recent host
+#else
+#define LED_TEST_PWM_BUDGET_CYCLES 2000
+#endif
+
+BUILD_ASSERT(NUM_LEDS == 4, "The test overlay defines four LEDs");
+
+/**
+ * Local variables
+ */
+
+// Every PWM update of the LED under test, as recorded by the fake
+static struct {
+    uint32_t channel;
+    uint32_t pulse[LED_TEST_MAX_EDGES];
+    int64_t uptime_ms[LED_TEST_MAX_EDGES];
+    int count;
+} led_test_edges;
+
+/**
+ * Helpers
+ */
+
+static int led_test_record_edge(const struct device* dev, uint32_t channel, uint32_t period, uint32_t pulse,
+                                pwm_flags_t flags) {
+    if (channel == led_test_edges.channel && led_test_edges.count < LED_TEST_MAX_EDGES) {
+        led_test_edges.pulse[led_test_edges.count] = pulse;
+        led_test_edges.uptime_ms[led_test_edges.count] = k_uptime_get();
+        led_test_edges.count++;
+    }
+    return 0;
+}
+
+static void led_test_record(led_id led) {
+    led_test_edges.channel = led;
+    led_test_edges.count = 0;
+}
+
+/**
+ * Fixtures
+ */
+
+static void* led_test_setup(void) {
+    // Nothing may be posted before the ring and the engine exist
+    zassert_equal(LED_pwm(LED0, 50), -ENODEV);
+    zassert_equal(LED_toggle(LED0), -ENODEV);
+
+    zassert_ok(LED_init());
+    return NULL;
+}
+
+static void led_test_before(void* fixture) {
+    // Stops any blinking left over from the previous test
+    for (int i = 0; i < NUM_LEDS; i++) {
+        zassert_ok(LED_pwm(i, 0));
+    }
+    k_msleep(LED_TEST_SETTLE_MS);
+
+    RESET_FAKE(fake_pwm_set_cycles);
+    fake_pwm_set_cycles_fake.custom_fake = led_test_record_edge;
+    led_test_record(LED0);
+}
+
+ZTEST_SUITE(led, NULL, led_test_setup, led_test_before, NULL, NULL);
+
+/**
+ * Tests
+ */
+
+ZTEST(led, test_pwm_duty_maps_to_pulse) {
+    zassert_ok(LED_pwm(LED1, 25));
+    k_msleep(LED_TEST_SETTLE_MS);
+
+    zassert_equal(fake_pwm_set_cycles_fake.call_count, 1);
+    zassert_equal(fake_pwm_set_cycles_fake.arg1_val, 1, "Wrong channel");
+    zassert_equal(fake_pwm_set_cycles_fake.arg2_val, LED_TEST_PERIOD_CYCLES, "Wrong period");
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE(25), "Wrong pulse");
+    zassert_equal(fake_pwm_set_cycles_fake.arg4_val, PWM_POLARITY_NORMAL, "Wrong flags");
+}
+
+ZTEST(led, test_brightness_mapping) {
+    static const uint32_t periods[] = LED_TEST_MAPPING_PERIODS;
+
+    // The static path through the fake must match the test's own formula at every duty cycle
+    for (uint8_t duty = 0; duty <= 100; duty++) {
+        zassert_equal(LED_PERMILLE_TO_PULSE(LED_TEST_PERIOD_CYCLES, LED_DUTY_TO_PERMILLE(duty)), LED_TEST_PULSE(duty),
+                      "Duty %u", duty);
+    }
+
+    // Waveform steps use the same mapping with other periods: off and fully on at the ends, never brighter for a lower
+    // duty, and on-time within one period unit of linear
+    for (int p = 0; p < ARRAY_SIZE(periods); p++) {
+        uint32_t previous = periods[p];
+
+        zassert_equal(LED_PERMILLE_TO_PULSE(periods[p], 0), periods[p], "Period %u: not off at 0", periods[p]);
+        zassert_equal(LED_PERMILLE_TO_PULSE(periods[p], 1000), 0, "Period %u: not fully on at 1000", periods[p]);
+
+        for (uint16_t permille = 0; permille <= 1000; permille++) {
+            uint32_t pulse = LED_PERMILLE_TO_PULSE(periods[p], permille);
+            int64_t on_time = periods[p] - pulse;
+
+            zassert_true(pulse <= previous, "Period %u: %u permille dimmer than %u", periods[p], permille, permille - 1);
+            zassert_within(on_time * 1000, (int64_t) periods[p] * permille, 1000, "Period %u: %u permille not linear",
+                           periods[p], permille);
+            previous = pulse;
+        }
+    }
+}
+
+ZTEST(led, test_duty_clamped) {
+    zassert_ok(LED_pwm(LED1, 250));
+    k_msleep(LED_TEST_SETTLE_MS);
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE(100), "Duty cycle above 100 not clamped");
+
+    zassert_ok(LED_set(LED1, LED_OFF));
+    k_msleep(LED_TEST_SETTLE_MS);
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE(0));
+}
+
+ZTEST(led, test_toggle) {
+    zassert_ok(LED_toggle(LED2));
+    k_msleep(LED_TEST_SETTLE_MS);
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE(100));
+
+    zassert_ok(LED_toggle(LED2));
+    k_msleep(LED_TEST_SETTLE_MS);
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE(0));
+}
+
+ZTEST(led, test_invalid_ids) {
+    zassert_equal(LED_pwm(NUM_LEDS, 50), -EINVAL);
+    zassert_equal(LED_pwm((led_id) -1, 50), -EINVAL);
+    zassert_equal(LED_toggle(NUM_LEDS), -EINVAL);
+    zassert_equal(LED_set(NUM_LEDS, LED_ON), -EINVAL);
+    LED_blink(NUM_LEDS, LED_1HZ);
+    LED_blink(LED0, 0);
+    LED_blink(LED0, 2 * LED_16HZ);
+
+    k_msleep(LED_TEST_SETTLE_MS);
+    zassert_equal(fake_pwm_set_cycles_fake.call_count, 0, "A rejected call reached the PWM");
+}
+
+ZTEST(led, test_effects_need_nrf_pwm) {
+    static const uint8_t pattern[] = {0, 100};
+
+    Z_TEST_SKIP_IFDEF(CONFIG_PWM_NRFX);
+
+    zassert_equal(LED_fade(LED0, 100, 500), -ENOTSUP);
+    zassert_equal(LED_breathe(LED0, 1000), -ENOTSUP);
+    zassert_equal(LED_pattern(LED0, pattern, ARRAY_SIZE(pattern), 100, false), -ENOTSUP);
+}
+
+ZTEST(led, test_blink_period) {
+    static const led_frequency frequencies[] = {LED_1HZ, LED_2HZ, LED_4HZ, LED_8HZ, LED_16HZ};
+
+    for (int f = 0; f < ARRAY_SIZE(frequencies); f++) {
+        int32_t half_period_ms = 500 / frequencies[f];
+        int32_t tolerance_ms = half_period_ms * LED_TEST_BLINK_TOLERANCE_PERCENT / 100;
+
+        led_test_record(LED3);
+        LED_blink(LED3, frequencies[f]);
+        k_msleep((LED_TEST_BLINK_EDGES + 1) * half_period_ms);
+        zassert_ok(LED_pwm(LED3, 0));
+        k_msleep(LED_TEST_SETTLE_MS);
+
+        zassert_true(led_test_edges.count >= LED_TEST_BLINK_EDGES, "%d Hz: only %d edges", frequencies[f],
+                     led_test_edges.count);
+
+        // When the first edge lands depends on when the blink was posted, so only the gaps between edges are checked.
+        // The last record is the LED_pwm that stopped the blink
+        for (int i = 1; i < led_test_edges.count - 1; i++) {
+            int64_t elapsed_ms = led_test_edges.uptime_ms[i] - led_test_edges.uptime_ms[i - 1];
+
+            zassert_within(elapsed_ms, half_period_ms, tolerance_ms, "%d Hz: edge %d came after %lld ms, expected %d ms",
+                           frequencies[f], i, (long long) elapsed_ms, half_period_ms);
+            zassert_not_equal(led_test_edges.pulse[i], led_test_edges.pulse[i - 1], "%d Hz: edge %d didn't toggle",
+                              frequencies[f], i);
+        }
+    }
+}
+
+ZTEST(led, test_full_ring_drops_without_losing_accepted) {
+    uint32_t dropped_before = LED_dropped_commands();
+    int accepted = 0;
+    int rejected = 0;
+    int failed = 0;
+
+    // With the scheduler locked the engine can't drain the ring, so the burst must overflow it
+    k_sched_lock();
+    for (int i = 0; i < LED_TEST_BURST; i++) {
+        int err = LED_pwm(LED0, i % 100);
+        if (err == 0) {
+            accepted++;
+        } else if (err == -EAGAIN) {
+            rejected++;
+        } else {
+            failed++;
+        }
+    }
+    k_sched_unlock();
+    k_msleep(LED_TEST_SETTLE_MS);
+
+    zassert_equal(failed, 0, "A full ring must only ever return -EAGAIN");
+    zassert_true(rejected > 0, "A burst of %d commands didn't fill the ring", LED_TEST_BURST);
+    zassert_equal(LED_dropped_commands() - dropped_before, rejected, "Dropped counter disagrees with -EAGAIN returns");
+    zassert_equal(fake_pwm_set_cycles_fake.call_count, accepted, "Accepted commands lost");
+    zassert_equal(fake_pwm_set_cycles_fake.arg3_val, LED_TEST_PULSE((accepted - 1) % 100), "Commands applied out of order");
+
+    // And the ring is usable again once drained
+    zassert_ok(LED_pwm(LED0, 0));
+}
+
+ZTEST(led, test_pwm_call_cost) {
+    uint64_t total_cycles = 0;
+    int failed = 0;
+
+    TEST_TIMING_REQUIRE();
+
+    for (int batch = 0; batch < LED_TEST_COST_BATCHES; batch++) {
+        k_sched_lock();
+        for (int i = 0; i < LED_TEST_COST_BATCH; i++) {
+            uint64_t start = test_timing_cycles();
+            int err = LED_pwm(LED0, i);
+            total_cycles += test_timing_cycles() - start;
+            failed += (err != 0);
+        }
+        k_sched_unlock();
+        k_msleep(LED_TEST_SETTLE_MS);
+    }
+
+    zassert_equal(failed, 0, "%d calls failed", failed);
+
+    unsigned long long per_call = total_cycles / (LED_TEST_COST_BATCHES * LED_TEST_COST_BATCH);
+
+    TC_PRINT("LED_pwm: %llu cycles per call (budget %d)\n", per_call, LED_TEST_PWM_BUDGET_CYCLES);
+    zassert_true(per_call <= LED_TEST_PWM_BUDGET_CYCLES, "LED_pwm took %llu cycles per call, budget %d", per_call,
+                 LED_TEST_PWM_BUDGET_CYCLES);
+}